@@ -0,0 +1,276 @@
+#include "CorpusGenerator.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <string_view>
+
+// Operands of binary operators recurse with less depth, so items stay a few
+// hundred bytes long on average
+static constexpr int DEFINITION_DEPTH = 4;
+static constexpr int TOP_LEVEL_DEPTH = 3;
+
+// Calls go to recently defined functions, like code that builds on itself
+static constexpr size_t CALL_WINDOW = 32;
+
+static constexpr std::string_view PRELUDE =
+    "# Synthetic Kaleidoscope corpus\n"
+    "extern sin(x);\n"
+    "extern cos(x);\n"
+    "extern sqrt(x);\n"
+    "extern putchard(c);\n"
+    "\n"
+    "def unary!(v)\n"
+    "    if v then 0 else 1;\n"
+    "\n"
+    "def unary-(v)\n"
+    "    0 - v;\n"
+    "\n"
+    "def binary> 10 (LHS RHS)\n"
+    "    RHS < LHS;\n"
+    "\n"
+    "def binary| 5 (LHS RHS)\n"
+    "    if LHS then 1 else if RHS then 1 else 0;\n"
+    "\n"
+    "def binary& 6 (LHS RHS)\n"
+    "    if !LHS then 0 else !!RHS;\n"
+    "\n"
+    "def binary : 1 (x y)\n"
+    "    y;\n"
+    "\n";
+
+static constexpr char BINARY_OPS[] = {'+', '-', '*', '<', '>', '|', '&', ':'};
+static constexpr char UNARY_OPS[] = {'!', '-'};
+
+const std::vector<std::pair<char, int>>& CorpusGenerator::getBinaryOperators() {
+    static const std::vector<std::pair<char, int>> operators = {
+        {'>', 10},
+        {'|', 5},
+        {'&', 6},
+        {':', 1},
+    };
+    return operators;
+}
+
+std::string CorpusGenerator::generate(size_t targetBytes) {
+    std::string out;
+    out.reserve(targetBytes + 4096);
+    emitPrelude(out);
+    while (out.size() < targetBytes) {
+        if (pick(5) == 0) {
+            emitTopLevelExpr(out);
+        } else {
+            emitDefinition(out);
+        }
+    }
+    return out;
+}
+
+void CorpusGenerator::emitPrelude(std::string& out) {
+    out += PRELUDE;
+    for (const char* name : {"sin", "cos", "sqrt", "putchard"}) {
+        functions.push_back({name, 1});
+    }
+}
+
+void CorpusGenerator::emitDefinition(std::string& out) {
+    std::string name = "f" + std::to_string(functions.size());
+    if (pick(8) == 0) {
+        out += "# " + name + " is generated\n";
+    }
+
+    nextVar = 0;
+    scope.clear();
+    size_t arity = pick(5);
+    out += "def " + name + "(";
+    for (size_t i = 0; i < arity; ++i) {
+        scope.push_back(freshName());
+        out += i ? " " : "";
+        out += scope.back();
+    }
+    out += ")\n    ";
+    emitExpr(out, DEFINITION_DEPTH);
+    out += ";\n\n";
+
+    // Added afterwards, the body must not call itself forever
+    functions.push_back({std::move(name), arity});
+}
+
+void CorpusGenerator::emitTopLevelExpr(std::string& out) {
+    nextVar = 0;
+    scope.clear();
+    emitExpr(out, TOP_LEVEL_DEPTH);
+    out += ";\n\n";
+}
+
+void CorpusGenerator::emitExpr(std::string& out, int depth) {
+    if (depth <= 0) {
+        emitOperand(out, 0);
+        return;
+    }
+
+    switch (pick(10)) {
+        case 0:
+            emitCall(out, depth);
+            return;
+        case 1:
+            emitIf(out, depth);
+            return;
+        case 2:
+            emitFor(out, depth);
+            return;
+        case 3:
+            emitVar(out, depth);
+            return;
+        case 4:
+            if (!scope.empty()) {
+                out += scope[pick(scope.size())] + " = ";
+                emitExpr(out, depth - 1);
+                return;
+            }
+            break;
+        default:
+            break;
+    }
+
+    emitOperand(out, depth - 1);
+    size_t ops = 1 + pick(2);
+    for (size_t i = 0; i < ops; ++i) {
+        out += ' ';
+        out += BINARY_OPS[pick(std::size(BINARY_OPS))];
+        out += ' ';
+        emitOperand(out, depth - 1);
+    }
+}
+
+void CorpusGenerator::emitOperand(std::string& out, int depth) {
+    if (depth <= 0) {
+        emitLeaf(out);
+        return;
+    }
+
+    switch (pick(6)) {
+        case 0:
+        case 1:
+        case 2:
+            emitLeaf(out);
+            return;
+        case 3:
+            emitCall(out, depth);
+            return;
+        case 4:
+            out += '(';
+            emitExpr(out, depth);
+            out += ')';
+            return;
+        default:
+            out += UNARY_OPS[pick(std::size(UNARY_OPS))];
+            emitOperand(out, depth - 1);
+            return;
+    }
+}
+
+void CorpusGenerator::emitLeaf(std::string& out) {
+    if (!scope.empty() && pick(2)) {
+        out += scope[pick(scope.size())];
+    } else {
+        emitNumber(out);
+    }
+}
+
+void CorpusGenerator::emitNumber(std::string& out) {
+    switch (pick(16)) {
+        case 0:
+            out += std::to_string(pick(10)) + "." + std::to_string(pick(100)) + "e" + std::to_string(pick(8));
+            return;
+        case 1:
+            out += std::to_string(1 + pick(9)) + "e-" + std::to_string(pick(4));
+            return;
+        case 2:
+            out += "0x" + std::string(1, "0123456789ABCDEF"[pick(16)]) + std::string(1, "0123456789abcdef"[pick(16)]);
+            return;
+        case 3:
+            out += std::to_string(1 + pick(9)) + "_" + std::to_string(100 + pick(900));
+            return;
+        case 4:
+            out += "0x1." + std::to_string(pick(10)) + "p" + std::to_string(pick(4));
+            return;
+        case 5:
+        case 6:
+        case 7:
+            out += std::to_string(pick(100)) + "." + std::to_string(pick(10));
+            return;
+        default:
+            out += std::to_string(pick(100));
+            return;
+    }
+}
+
+void CorpusGenerator::emitCall(std::string& out, int depth) {
+    size_t window = std::min(functions.size(), CALL_WINDOW);
+    const Function& callee = functions[functions.size() - 1 - pick(window)];
+    out += callee.name + "(";
+    for (size_t i = 0; i < callee.arity; ++i) {
+        out += i ? ", " : "";
+        // Mostly plain arguments, sometimes a nested call
+        if (pick(4) == 0) {
+            emitCall(out, depth - 1);
+        } else {
+            emitExpr(out, depth - 2);
+        }
+    }
+    out += ')';
+}
+
+void CorpusGenerator::emitIf(std::string& out, int depth) {
+    out += "if ";
+    emitExpr(out, depth - 1);
+    out += " then ";
+    emitExpr(out, depth - 1);
+    out += " else ";
+    emitExpr(out, depth - 1);
+}
+
+void CorpusGenerator::emitFor(std::string& out, int depth) {
+    std::string var = freshName();
+    out += "for " + var + " = ";
+    // The start value is a primary, a unary operator there is a parse error
+    if (pick(3) == 0) {
+        emitCall(out, depth - 1);
+    } else {
+        emitLeaf(out);
+    }
+
+    scope.push_back(var);
+    out += ", " + var + " < ";
+    emitOperand(out, depth - 1);
+    if (pick(2)) {
+        out += ", ";
+        emitNumber(out);
+    }
+    out += " in ";
+    emitExpr(out, depth - 1);
+    scope.pop_back();
+}
+
+void CorpusGenerator::emitVar(std::string& out, int depth) {
+    size_t count = 1 + pick(3);
+    size_t outer = scope.size();
+    out += "var ";
+    for (size_t i = 0; i < count; ++i) {
+        std::string var = freshName();
+        out += i ? ", " : "";
+        out += var;
+        if (pick(3)) {
+            out += " = ";
+            emitExpr(out, depth - 2);
+        }
+        scope.push_back(std::move(var));
+    }
+    out += " in ";
+    emitExpr(out, depth - 1);
+    scope.resize(outer);
+}
+
+std::string CorpusGenerator::freshName() {
+    return "v" + std::to_string(nextVar++);
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+//===----------------------------------------------------------------------===//
+// Deterministic generator for synthetic Kaleidoscope sources. The same seed
+// and size always produce the same bytes, so benchmark runs stay comparable.
+//
+// Every grammar production shows up: externs, definitions, top-level
+// expressions, if/then/else, for/in with and without a step, var/in with and
+// without initializers, assignment, user-defined unary and binary operators,
+// nested calls, parentheses, comments and the number literal forms.
+//===----------------------------------------------------------------------===//
+
+class CorpusGenerator {
+public:
+    explicit CorpusGenerator(uint32_t seed = 42) : rng(seed) {}
+
+    // Produces at least `targetBytes` of source made of whole top-level items
+    std::string generate(size_t targetBytes);
+
+    // Binary operators the corpus defines, with their precedences. Parsing
+    // the corpus without codegen needs these registered up front.
+    static const std::vector<std::pair<char, int>>& getBinaryOperators();
+
+private:
+    struct Function {
+        std::string name;
+        size_t arity;
+    };
+
+    std::mt19937 rng;
+    std::vector<Function> functions;
+    std::vector<std::string> scope;
+    size_t nextVar = 0;
+
+    size_t pick(size_t n) {
+        return rng() % n;
+    }
+
+    void emitPrelude(std::string& out);
+    void emitDefinition(std::string& out);
+    void emitTopLevelExpr(std::string& out);
+
+    void emitExpr(std::string& out, int depth);
+    void emitOperand(std::string& out, int depth);
+    void emitLeaf(std::string& out);
+    void emitNumber(std::string& out);
+    void emitCall(std::string& out, int depth);
+    void emitIf(std::string& out, int depth);
+    void emitFor(std::string& out, int depth);
+    void emitVar(std::string& out, int depth);
+
+    std::string freshName();
+};
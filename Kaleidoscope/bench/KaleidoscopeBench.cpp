@@ -0,0 +1,427 @@
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "AST/ASTSerializer.hpp"
+#include "AST/FlatAST.hpp"
+#include "AST/FlatIRSize.hpp"
+#include "AST/NodeWalker.hpp"
+#include "AST/OperatorTable.hpp"
+#include "AST/PrototypeRegistry.hpp"
+#include "AST/StaticVisitor.hpp"
+#include "AST/ValueVisitor.hpp"
+#include "frontend/Lexer.hpp"
+#include "frontend/ParallelParser.hpp"
+#include "frontend/Parser.hpp"
+#include "frontend/TokenStream.hpp"
+
+#include "CorpusGenerator.hpp"
+
+using namespace lang;
+
+//===----------------------------------------------------------------------===//
+// Front end throughput over generated sources of three sizes. Reports tokens
+// per second for the lexer paths, top-level items per second for the
+// parser, which runs without codegen, nodes per second for passes over
+// the parsed items, and instructions per second for sizing the program
+// against running codegen on it.
+//
+//   kaleidoscope_bench [large MB] [min MB per measurement]
+//   kaleidoscope_bench --emit <bytes> <file>
+//===----------------------------------------------------------------------===//
+
+struct Result {
+    size_t units = 0;
+    size_t errors = 0;
+};
+
+static size_t lexAll(Lexer& lexer) {
+    size_t tokens = 0;
+    while (lexer.advance() != tok_eof) {
+        ++tokens;
+    }
+    return tokens;
+}
+
+// Same dispatch as Driver::MainLoop, dropping each item once it is parsed
+static Result parseAll(Lexer& lexer, const OperatorTable& operators, bool hashConsing = false) {
+    Parser parser(lexer, operators);
+    parser.setHashConsing(hashConsing);
+    Result result;
+    lexer.advance();
+    while (true) {
+        bool parsed;
+        switch (lexer.getCurrentToken()) {
+            case tok_eof:
+                return result;
+            case tok_semicolon:
+                lexer.advance();
+                continue;
+            case tok_def:
+                parsed = parser.parseDefinition() != nullptr;
+                break;
+            case tok_extern:
+                parsed = parser.parseExtern() != nullptr;
+                break;
+            default:
+                parsed = parser.parseTopLevelExpr() != nullptr;
+                break;
+        }
+
+        ++result.units;
+        if (!parsed) {
+            ++result.errors;
+            parser.synchronize();
+        }
+    }
+}
+
+// The "walk tree" pass again, dispatching with a switch instead of accept()
+class CalleeCollector final : public StaticVisitor<CalleeCollector> {
+public:
+    CalleeCollector(Result& result, std::vector<Symbol>& callees) : result(result), callees(callees) {}
+
+    void visitNumberExpr(NumberExpr&) {
+        ++result.units;
+    }
+
+    void visitVariableExpr(VariableExpr&) {
+        ++result.units;
+    }
+
+    void visitBinaryExpr(BinaryExpr& expr) {
+        ++result.units;
+        visit(*expr.getLHS());
+        visit(*expr.getRHS());
+    }
+
+    void visitUnaryExpr(UnaryExpr& expr) {
+        ++result.units;
+        visit(*expr.getOperand());
+    }
+
+    void visitCallExpr(CallExpr& expr) {
+        ++result.units;
+        callees.push_back(expr.getCalleeName());
+        for (Expr* arg : expr.getArgs()) {
+            visit(*arg);
+        }
+    }
+
+    void visitIfExpr(IfExpr& expr) {
+        ++result.units;
+        visit(*expr.getCond());
+        visit(*expr.getThen());
+        visit(*expr.getElse());
+    }
+
+    void visitForExpr(ForExpr& expr) {
+        ++result.units;
+        visit(*expr.getStart());
+        visit(*expr.getEnd());
+        if (expr.getStep()) {
+            visit(*expr.getStep());
+        }
+        visit(*expr.getBody());
+    }
+
+    void visitVarExpr(VarExpr& expr) {
+        ++result.units;
+        for (auto [name, init] : expr.getVarNames()) {
+            if (init) {
+                visit(*init);
+            }
+        }
+        visit(*expr.getBody());
+    }
+
+    void visitFcnPrototype(FcnPrototype&) {}
+    void visitFcn(Fcn&) {}
+    void visitOther(ASTNode&) {}
+
+private:
+    Result& result;
+    std::vector<Symbol>& callees;
+};
+
+// `result` is from one of `reps` rounds over `bytes` of source
+static void report(const char* name, const char* unit, size_t bytes, size_t reps, Result result,
+                   std::chrono::duration<double> secs) {
+    double perSec = static_cast<double>(result.units) * reps / secs.count();
+    double mbPerSec = static_cast<double>(bytes) * reps / secs.count() / (1 << 20);
+    printf("  %-16s %12.0f %s/sec %8.1f MB/sec", name, perSec, unit, mbPerSec);
+    if (result.errors) {
+        printf(" (%zu errors)", result.errors);
+    }
+    printf("\n");
+}
+
+// Repeats `fn` until at least `minBytes` went through it, so small inputs
+// are not dominated by timer resolution
+template<typename F>
+static void run(const char* name, const char* unit, std::string_view source, size_t minBytes, F fn) {
+    size_t reps = std::max<size_t>(1, minBytes / source.size());
+    Result result;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t r = 0; r < reps; ++r) {
+        result = fn(source);
+    }
+    report(name, unit, source.size(), reps, result, std::chrono::steady_clock::now() - start);
+}
+
+// Runs CodegenVisitor over the items in `serialized`, counting functions
+// that fail or whose size differs from `estimates` as errors. Codegen takes
+// the prototypes out of the trees, so every round reads them back first,
+// outside the timer. Bodies are dropped once counted to keep memory flat.
+static void codegenAll(size_t bytes, size_t minBytes, const std::string& serialized,
+                       const std::vector<size_t>& estimates) {
+    size_t reps = std::max<size_t>(1, minBytes / bytes);
+    Result result;
+    std::chrono::steady_clock::duration elapsed{0};
+    for (size_t r = 0; r < reps; ++r) {
+        std::vector<std::unique_ptr<Fcn>> fcns;
+        std::vector<std::unique_ptr<FcnPrototype>> protos;
+        ASTReader reader(serialized, 0);
+        uint64_t kind;
+        while (!reader.atEnd() && reader.readVarint(kind)) {
+            if (kind == 0) {
+                fcns.push_back(reader.readFcn());
+            } else {
+                protos.push_back(reader.readPrototype());
+            }
+        }
+
+        llvm::LLVMContext context;
+        llvm::Module module("bench", context);
+        llvm::IRBuilder<> builder(context);
+        OperatorTable operators;
+        CodegenVisitor visitor(&context, &module, &builder, operators);
+        visitor.setFPM(nullptr);
+        visitor.setFAM(nullptr);
+        PrototypeRegistry::get()->setModule(&module);
+
+        auto start = std::chrono::steady_clock::now();
+        for (std::unique_ptr<FcnPrototype>& proto : protos) {
+            proto->accept(visitor);
+            Symbol name = proto->getName();
+            PrototypeRegistry::addFcnPrototype(name, std::move(proto));
+        }
+        result = Result{};
+        for (size_t i = 0; i < fcns.size(); ++i) {
+            auto* function = llvm::dyn_cast_or_null<llvm::Function>(visitor.visit(*fcns[i]));
+            if (!function) {
+                ++result.errors;
+                continue;
+            }
+            size_t size = function->getInstructionCount();
+            result.units += size;
+            result.errors += i >= estimates.size() || size != estimates[i];
+            if (function->getName() == "main") {
+                function->eraseFromParent();
+            } else {
+                function->deleteBody();
+            }
+        }
+        elapsed += std::chrono::steady_clock::now() - start;
+        PrototypeRegistry::reset();
+    }
+    report("codegen tree", "instrs", bytes, reps, result, elapsed);
+}
+
+static void runAll(const char* label, size_t bytes, size_t minBytes, const OperatorTable& operators) {
+    std::string source = CorpusGenerator().generate(bytes);
+    printf("%s: %.1f MB\n", label, static_cast<double>(source.size()) / (1 << 20));
+
+    run("lex", "tokens", source, minBytes, [](std::string_view src) {
+        Lexer lexer(src);
+        return Result{lexAll(lexer)};
+    });
+
+    run("prelex", "tokens", source, minBytes, [](std::string_view src) {
+        Lexer lexer(src);
+        TokenStream tokens(lexer);
+        return Result{tokens.size(), tokens.getDiagnostics().size()};
+    });
+
+    unsigned jobs = std::max(1u, std::thread::hardware_concurrency());
+    run("prelex parallel", "tokens", source, minBytes, [jobs](std::string_view src) {
+        TokenStream tokens = TokenStream::lexParallel(src, jobs);
+        return Result{tokens.size(), tokens.getDiagnostics().size()};
+    });
+
+    run("parse", "items", source, minBytes, [&operators](std::string_view src) {
+        Lexer lexer(src);
+        return parseAll(lexer, operators);
+    });
+
+    run("parse hash-consed", "items", source, minBytes, [&operators](std::string_view src) {
+        Lexer lexer(src);
+        return parseAll(lexer, operators, true);
+    });
+
+    // Lexing happens outside the timer, only replay and parsing are measured
+    Lexer prelexer(source);
+    TokenStream tokens(prelexer);
+    run("parse prelexed", "items", source, minBytes, [&tokens, &operators](std::string_view) {
+        Lexer lexer(tokens);
+        return parseAll(lexer, operators);
+    });
+
+    run("parse parallel", "items", source, minBytes, [&tokens, &operators, jobs](std::string_view) {
+        Result result;
+        for (const ParallelParser::Item& item : ParallelParser(tokens, operators).parse(jobs)) {
+            ++result.units;
+            result.errors += item.kind == ParallelParser::ItemKind::Error;
+        }
+        return result;
+    });
+
+    // Serialized outside the timer as well, only reading back is measured
+    std::vector<ParallelParser::Item> items = ParallelParser(tokens, operators).parse(1);
+    std::string serialized;
+    ASTWriter writer(serialized, 0);
+    for (ParallelParser::Item& item : items) {
+        if (item.fcn) {
+            writer.writeVarint(0);
+            writer.writeFcn(*item.fcn);
+        } else if (item.proto) {
+            writer.writeVarint(1);
+            writer.writePrototype(*item.proto);
+        }
+    }
+    run("deserialize", "items", source, minBytes, [&serialized](std::string_view) {
+        ASTReader reader(serialized, 0);
+        Result result;
+        uint64_t kind;
+        while (!reader.atEnd()) {
+            ++result.units;
+            bool read = reader.readVarint(kind) && (kind == 0 ? reader.readFcn() != nullptr
+                                                              : reader.readPrototype() != nullptr);
+            if (!read) {
+                ++result.errors;
+                break;
+            }
+        }
+        return result;
+    });
+
+    // Whole-program passes collecting every callee, the way the Driver does
+    // for lazy definitions, over the trees and over a flat copy of them
+    std::vector<Fcn*> fcns;
+    for (ParallelParser::Item& item : items) {
+        if (item.fcn) {
+            fcns.push_back(item.fcn.get());
+        }
+    }
+    FlatAST flat;
+    run("flatten", "nodes", source, minBytes, [&fcns, &flat](std::string_view) {
+        flat.clear();
+        for (Fcn* fcn : fcns) {
+            flat.append(*fcn->getBody());
+        }
+        return Result{flat.size()};
+    });
+
+    std::vector<Symbol> callees;
+    run("walk tree", "nodes", source, minBytes, [&fcns, &callees](std::string_view) {
+        Result result;
+        callees.clear();
+        NodeWalker collectCallees([&result, &callees](ASTNode& node) {
+            ++result.units;
+            if (auto* call = llvm::dyn_cast<CallExpr>(&node)) {
+                callees.push_back(call->getCalleeName());
+            }
+        });
+        for (Fcn* fcn : fcns) {
+            fcn->getBody()->accept(collectCallees);
+        }
+        return result;
+    });
+
+    run("walk static", "nodes", source, minBytes, [&fcns, &callees](std::string_view) {
+        Result result;
+        callees.clear();
+        CalleeCollector collectCallees(result, callees);
+        for (Fcn* fcn : fcns) {
+            collectCallees.visit(*fcn->getBody());
+        }
+        return result;
+    });
+
+    run("walk flat", "nodes", source, minBytes, [&flat, &callees](std::string_view) {
+        callees.clear();
+        for (FlatAST::NodeId id = 0; id < flat.size(); ++id) {
+            if (flat.getKind(id) == FlatAST::Kind::Call) {
+                callees.push_back(flat.getName(id));
+            }
+        }
+        return Result{flat.size()};
+    });
+
+    // A whole-program pass that does real work: how many instructions
+    // codegen will emit, over the flat copy, against running codegen
+    flat.clear();
+    std::vector<std::pair<FlatAST::NodeId, size_t>> bodies;
+    for (Fcn* fcn : fcns) {
+        bodies.emplace_back(flat.append(*fcn->getBody()), fcn->getPrototype()->getArgs().size());
+    }
+    std::vector<size_t> estimates;
+    run("size flat", "instrs", source, minBytes, [&flat, &bodies, &estimates](std::string_view) {
+        Result result;
+        estimates.clear();
+        FlatIRSize sizes(flat);
+        for (auto [body, numArgs] : bodies) {
+            estimates.push_back(sizes.getFunctionSize(body, numArgs));
+            result.units += estimates.back();
+        }
+        return result;
+    });
+
+    codegenAll(source.size(), minBytes, serialized, estimates);
+}
+
+// Whole argument as a positive count, small enough to shift into bytes
+static bool parseCount(std::string_view arg, size_t& count) {
+    auto [end, ec] = std::from_chars(arg.data(), arg.data() + arg.size(), count);
+    return ec == std::errc() && end == arg.data() + arg.size() && count > 0 && count < (size_t(1) << 40);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string_view(argv[1]) == "--emit") {
+        size_t bytes = 0;
+        if (argc != 4 || !parseCount(argv[2], bytes)) {
+            fprintf(stderr, "usage: %s --emit <bytes> <file>\n", argv[0]);
+            return 1;
+        }
+        std::ofstream out(argv[3], std::ios::binary);
+        out << CorpusGenerator().generate(bytes);
+        return out ? 0 : 1;
+    }
+
+    size_t largeMB = 100;
+    size_t minMB = 64;
+    if (argc > 3 || (argc > 1 && !parseCount(argv[1], largeMB)) || (argc > 2 && !parseCount(argv[2], minMB))) {
+        fprintf(stderr, "usage: %s [large MB] [min MB per measurement]\n"
+                        "       %s --emit <bytes> <file>\n", argv[0], argv[0]);
+        return 1;
+    }
+    size_t minBytes = minMB << 20;
+
+    // Codegen registers these when it sees the operator definitions, the
+    // parser alone needs them up front
+    OperatorTable operators;
+    for (auto [op, prec] : CorpusGenerator::getBinaryOperators()) {
+        operators.setBinaryOperator(op, prec);
+    }
+
+    runAll("small", 64 << 10, minBytes, operators);
+    runAll("medium", 4 << 20, minBytes, operators);
+    runAll("large", largeMB << 20, minBytes, operators);
+    return 0;
+}
@@ -0,0 +1,109 @@
+#include <charconv>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "frontend/Keywords.hpp"
+
+using namespace lang;
+
+//===----------------------------------------------------------------------===//
+// Compares the old sequential keyword comparisons against the perfect hash
+// in Keywords.hpp. Reports identifiers classified per second.
+//
+//   keyword_bench [identifiers] [repetitions]
+//===----------------------------------------------------------------------===//
+
+// The chain Lexer::getTokFromWord used before the perfect hash
+static Token legacyTokFromWord(const std::string &word) {
+    if (word == "def") {
+        return tok_def;
+    }
+    if (word == "extern") {
+        return tok_extern;
+    }
+    if (word == "if") {
+        return tok_if;
+    }
+    if (word == "then") {
+        return tok_then;
+    }
+    if (word == "else") {
+        return tok_else;
+    }
+    if (word == "for") {
+        return tok_for;
+    }
+    if (word == "in") {
+        return tok_in;
+    }
+    if (word == "binary") {
+        return tok_binary;
+    }
+    if (word == "unary") {
+        return tok_unary;
+    }
+    if (word == "var") {
+        return tok_var;
+    }
+    return tok_identifier;
+}
+
+static std::vector<std::string> makeWords(size_t count) {
+    static const char ALNUM[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+    std::mt19937 rng(42);
+    std::vector<std::string> words;
+    words.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        // Roughly one in five words is a keyword, like typical sources
+        if (rng() % 5 == 0) {
+            words.emplace_back(KEYWORDS[rng() % KEYWORDS.size()].spelling);
+            continue;
+        }
+        std::string word(1, ALNUM[rng() % 52]);
+        size_t len = rng() % 10;
+        for (size_t j = 0; j < len; ++j) {
+            word += ALNUM[rng() % (sizeof(ALNUM) - 1)];
+        }
+        words.push_back(std::move(word));
+    }
+    return words;
+}
+
+template<typename F>
+static void run(const char* name, const std::vector<std::string>& words, int reps, F classify) {
+    int keywords = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < reps; ++r) {
+        for (const auto& word : words) {
+            keywords += classify(word) != tok_identifier;
+        }
+    }
+    std::chrono::duration<double> secs = std::chrono::steady_clock::now() - start;
+    double perSec = static_cast<double>(words.size()) * reps / secs.count();
+    printf("%-14s %12.0f identifiers/sec (%d keywords)\n", name, perSec, keywords);
+}
+
+// Whole argument as a positive count that fits in an int
+static bool parseCount(std::string_view arg, size_t& count) {
+    auto [end, ec] = std::from_chars(arg.data(), arg.data() + arg.size(), count);
+    return ec == std::errc() && end == arg.data() + arg.size() && count > 0 && count <= INT_MAX;
+}
+
+int main(int argc, char* argv[]) {
+    size_t count = 1000000;
+    size_t reps = 20;
+    if (argc > 3 || (argc > 1 && !parseCount(argv[1], count)) || (argc > 2 && !parseCount(argv[2], reps))) {
+        fprintf(stderr, "usage: %s [identifiers] [repetitions]\n", argv[0]);
+        return 1;
+    }
+    auto words = makeWords(count);
+
+    run("legacy chain", words, static_cast<int>(reps), [](const std::string& w) { return legacyTokFromWord(w); });
+    run("perfect hash", words, static_cast<int>(reps), [](const std::string& w) { return lookupKeyword(w); });
+    return 0;
+}
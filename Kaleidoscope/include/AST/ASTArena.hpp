@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "Expr.hpp"
+
+// Bump allocator for the expression nodes of one top-level item, so parsing
+// a body costs a handful of mallocs instead of one per node.
+//
+// The ExprUPtrs linking arena nodes together do not own them. The arena
+// destroys its nodes itself, newest first: a parent is always created after
+// its children, so no destructor sees a child that is already gone, and a
+// deep tree comes down without recursing.
+class ASTArena {
+public:
+    ASTArena() = default;
+    ASTArena(const ASTArena&) = delete;
+    ASTArena& operator=(const ASTArena&) = delete;
+    ~ASTArena();
+
+    template<typename T, typename... Args>
+    std::unique_ptr<T, ExprDeleter> create(Args&&... args) {
+        static_assert(std::is_base_of_v<Expr, T>, "only expressions live in an ASTArena");
+        static_assert(alignof(T) <= ALIGN && sizeof(Entry) % ALIGN == 0, "misaligned node");
+
+        auto* entry = static_cast<Entry*>(allocate(sizeof(Entry) + sizeof(T)));
+        T* expr = new (entry + 1) T(std::forward<Args>(args)...);
+        expr->InArena = true;
+        entry->prev = last;
+        entry->expr = expr;
+        last = entry;
+        ++numNodes;
+        return std::unique_ptr<T, ExprDeleter>(expr);
+    }
+
+    size_t getNumNodes() const {
+        return numNodes;
+    }
+
+    // Slab bytes handed out so far, including the per-node bookkeeping
+    size_t getBytesUsed() const {
+        return bytesUsed + (cur - slabBegin);
+    }
+
+private:
+    // Precedes every node, chaining them newest first for destruction
+    struct Entry {
+        Entry* prev;
+        Expr* expr;
+    };
+
+    struct Slab {
+        Slab* next;
+    };
+
+    static constexpr size_t ALIGN = alignof(std::max_align_t);
+    static constexpr size_t INLINE_SIZE = 1024;
+    static constexpr size_t MAX_SLAB_SIZE = 64 * 1024;
+
+    void* allocate(size_t size) {
+        size = (size + ALIGN - 1) & ~(ALIGN - 1);
+        if (static_cast<size_t>(end - cur) < size) {
+            grow(size);
+        }
+        void* result = cur;
+        cur += size;
+        return result;
+    }
+
+    void grow(size_t size);
+
+    Entry* last = nullptr;
+    size_t numNodes = 0;
+
+    Slab* slabs = nullptr;
+    size_t nextSlabSize = 4096;
+    size_t bytesUsed = 0; // In slabs before the current one
+
+    // Most items fit here and never allocate a slab
+    alignas(ALIGN) std::byte inlineSlab[INLINE_SIZE];
+    std::byte* slabBegin = inlineSlab;
+    std::byte* cur = inlineSlab;
+    std::byte* end = inlineSlab + INLINE_SIZE;
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "llvm/Support/raw_ostream.h"
+
+#include "Expr.hpp"
+
+// Writes expressions to a stream in the toString() format, a node at a
+// time and without recursion, so the output is never held in memory as a
+// whole. Wrap a std::ostream in an llvm::raw_os_ostream to print to one.
+//
+// With an indent width set, tabs in the layout become that many spaces and
+// the lines of an if, for or var are indented one level deeper than the
+// line it starts on. A byte cap cuts the output short with "...", for log
+// lines about very large functions.
+class ASTPrinter {
+public:
+    explicit ASTPrinter(llvm::raw_ostream& out) : out(out) {}
+
+    // 0, the default, keeps the tabs toString() uses
+    void setIndentWidth(unsigned width) {
+        indentWidth = width;
+    }
+
+    // Bytes written over all print() calls before the output is cut,
+    // 0 for no cap
+    void setMaxBytes(size_t max) {
+        maxBytes = max;
+    }
+
+    void print(const Expr& root);
+
+    // Whether the cap cut the output short
+    bool isTruncated() const {
+        return truncated;
+    }
+
+private:
+    // Writes `text` of a node `depth` constructs deep, indenting its lines
+    void write(std::string_view text, unsigned depth);
+    void writeSpaces(size_t count);
+    // Writes up to the cap
+    void writeRaw(std::string_view text);
+
+    llvm::raw_ostream& out;
+    unsigned indentWidth = 0;
+    size_t maxBytes = 0;
+    size_t written = 0;
+    bool truncated = false;
+
+    // Reused across nodes and calls
+    std::string text;
+    std::vector<Expr::PrintItem> pending;
+    std::vector<unsigned> depths; // Of the pending items
+};
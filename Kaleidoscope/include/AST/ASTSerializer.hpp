@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Fcn.hpp"
+
+// Compact binary form of parsed functions and prototypes, used to cache
+// parses on disk. Nodes are written parents first and read back without
+// recursion, children before parents, so deserialized bodies go into an
+// ASTArena like parsed ones. Numbers are stored in host byte order.
+//
+// Identifiers are written once per writer and referenced by index after
+// that. Source locations are stored relative to a base offset, so an item
+// that moved within its file still reads back with the right locations.
+// Nodes that never had a location read back without one.
+class ASTWriter {
+public:
+    // Appends to `out`, locations are made relative to `base`
+    ASTWriter(std::string& out, SourceOffset base) : out(out), base(base) {}
+
+    // Not const, the nodes are walked with an ASTVisitor
+    void writeFcn(Fcn& fcn);
+    void writePrototype(const FcnPrototype& proto);
+
+    // Primitives, for containers that wrap serialized items
+    void writeVarint(uint64_t value);
+    void writeString(std::string_view str);
+    void writeSymbol(Symbol symbol);
+    void writeLoc(SourceOffset loc);
+    void writeFixed64(uint64_t value);
+
+private:
+    friend class NodeEncoder;
+
+    std::string& out;
+    SourceOffset base;
+    std::unordered_map<Symbol, uint32_t> symbolIndex;
+    std::vector<Expr*> stack;
+};
+
+// Reads what an ASTWriter wrote. Every read returns null or false on
+// truncated or malformed input, after which the reader is unusable.
+class ASTReader {
+public:
+    // Locations are made relative to `base` again
+    ASTReader(std::string_view in, SourceOffset base);
+    ~ASTReader();
+
+    std::unique_ptr<Fcn> readFcn();
+    std::unique_ptr<FcnPrototype> readPrototype();
+
+    bool readVarint(uint64_t& value);
+    bool readString(std::string_view& str);
+    bool readSymbol(Symbol& symbol);
+    bool readLoc(SourceOffset& loc);
+    bool readFixed64(uint64_t& value);
+
+    bool atEnd() const {
+        return pos == in.size();
+    }
+
+private:
+    struct Frame;
+
+    ExprUPtr readExpr(ASTArena& arena);
+    ExprUPtr readNodes(ASTArena& arena);
+
+    std::string_view in;
+    size_t pos = 0;
+    SourceOffset base;
+    std::vector<Symbol> symbols;
+    // Kept between items so their capacity is reused
+    std::vector<ExprUPtr> operands;
+    std::vector<Frame> frames;
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "debug/SourceLocation.hpp"
+#include "Fcn.hpp"
+#include "Symbol.hpp"
+
+class SourceManager;
+
+// Size and shape of one parsed top-level item, or of several summed up
+struct ItemStats {
+    Symbol name; // "main" for top-level expressions
+    SourceOffset loc = 0;
+
+    // Keyed by getType(). A node shared by several parents, see
+    // ExprInterner, counts once per parent.
+    std::map<std::string, size_t> nodesByType;
+    size_t numNodes = 0;
+    // Arena slabs of the body, or the nodes themselves when they are on
+    // the heap, plus the function and prototype
+    size_t nodeBytes = 0;
+    // Storage of call arguments, var bindings and prototype arguments
+    size_t childBytes = 0;
+    // Names interned for the first time while the item was parsed. The
+    // lexer is a token ahead, so a new name in the first token of an item
+    // counts against the item before it.
+    size_t stringBytes = 0;
+    // Nodes on the longest path from the function down to a leaf
+    size_t maxDepth = 0;
+    std::chrono::nanoseconds parseTime{0};
+
+    // Adds up counts, bytes and times, keeps the larger depth
+    void add(const ItemStats& other);
+};
+
+// Collects ItemStats for the items of a program as they are parsed, to size
+// arenas and catch pathological trees. Call beginItem() before parsing an
+// item and endItem() with the result, items that fail to parse are left
+// out.
+class ASTStats {
+public:
+    void beginItem();
+
+    // Not const, the tree is walked with a visitor
+    void endItem(Fcn& fcn);
+    void endItem(const FcnPrototype& proto);
+
+    const std::vector<ItemStats>& getItems() const {
+        return items;
+    }
+
+    ItemStats getTotal() const;
+
+    // One line per item, then the total
+    void print(std::ostream& out, std::string_view filename, const SourceManager& sources) const;
+
+    // Measures `fcn` alone, without a parse time or string bytes
+    static ItemStats measure(Fcn& fcn);
+
+private:
+    std::vector<ItemStats> items;
+    std::chrono::steady_clock::time_point itemStart;
+    size_t stringBytesAtStart = 0;
+};
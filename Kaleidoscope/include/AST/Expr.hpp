@@ -2,13 +2,36 @@
 
 #include <format>
 #include <memory>
+#include <ranges>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "Node.hpp"
+#include "Symbol.hpp"
+
+class ASTPrinter;
+class Expr;
+
+// Deletes heap nodes and leaves arena nodes to their ASTArena. Converts from
+// std::default_delete so std::make_unique results can be stored as usual.
+struct ExprDeleter {
+    ExprDeleter() = default;
+
+    template<typename T>
+    ExprDeleter(std::default_delete<T>) {}
+
+    void operator()(Expr* expr) const;
+};
+
+using ExprUPtr = std::unique_ptr<Expr, ExprDeleter>;
+
+// Deletes a heap tree one node at a time, however deep it is
+void deleteExprTree(Expr* root);
 
 class Expr : public ASTNode {
 public:
+    Expr() = default;
     virtual ~Expr() = default;
 
     void accept(ASTVisitor &visitor) override = 0;
@@ -16,19 +39,56 @@ public:
 
     const std::string getType() const override = 0;
     virtual std::string toString() const = 0;
+
+    // Adds the slots holding the children, for passes that replace them.
+    // Missing optional children, like a for without a step, are null.
+    virtual void getChildSlots(std::vector<ExprUPtr*>& /*slots*/) {}
+
+protected:
+    explicit Expr(NodeKind kind) : ASTNode(kind) {}
+
+    // A piece of toString output, an expression when `expr` is set
+    struct PrintItem {
+        const Expr* expr;
+        std::string_view text;
+    };
+
+    // toString without recursion: leaves append to `out`, everything else
+    // pushes its pieces onto `pending`, last one first. Expressions defined
+    // outside this file print through their own toString.
+    virtual void print(std::string& out, std::vector<PrintItem>& /*pending*/) const {
+        out += toString();
+    }
+
+    // Moves the owned children into `children`, see deleteExprTree
+    virtual void releaseChildren(std::vector<ExprUPtr>& /*children*/) {}
+
+    // toString through an ASTPrinter
+    static std::string printTree(const Expr& root);
+
+    friend class ASTPrinter;
+    friend void deleteExprTree(Expr* root);
 };
 
-using ExprUPtr = std::unique_ptr<Expr>;
+inline void ExprDeleter::operator()(Expr* expr) const {
+    if (!expr->isArenaAllocated()) {
+        deleteExprTree(expr);
+    }
+}
 
 class NumberExpr : public Expr {
     double value;
 
 public:
-    NumberExpr(double val) : value(val) {}
+    NumberExpr(double val) : Expr(NodeKind::Number), value(val) {}
 
     void accept(ASTVisitor &visitor) override;
     llvm::Value* accept(ValueVisitor &visitor) override;
 
+    static bool classof(const ASTNode* node) {
+        return node->getKind() == NodeKind::Number;
+    }
+
     const std::string getType() const override {
         return "Number";
     }
@@ -43,24 +103,33 @@ public:
 };
 
 class VariableExpr : public Expr {
-    std::string name;
+    Symbol name;
 
 public:
-    VariableExpr(const std::string &varName) : name(varName) {}
+    VariableExpr(Symbol varName) : Expr(NodeKind::Variable), name(varName) {}
 
     void accept(ASTVisitor &visitor) override;
     llvm::Value* accept(ValueVisitor &visitor) override;
 
+    static bool classof(const ASTNode* node) {
+        return node->getKind() == NodeKind::Variable;
+    }
+
     const std::string getType() const override {
         return "Variable";
     }
 
-    const std::string& getName() const {
+    Symbol getName() const {
         return name;
     }
 
     std::string toString() const override {
-        return name;
+        return std::string(name.str());
+    }
+
+protected:
+    void print(std::string& out, std::vector<PrintItem>& /*pending*/) const override {
+        out += name.str();
     }
 };
 
@@ -70,11 +139,15 @@ class BinaryExpr : public Expr {
 
 public:
     BinaryExpr(char op, ExprUPtr lhs, ExprUPtr rhs)
-        : Op(op), LHS(std::move(lhs)), RHS(std::move(rhs)) {}
+        : Expr(NodeKind::Binary), Op(op), LHS(std::move(lhs)), RHS(std::move(rhs)) {}
 
     void accept(ASTVisitor &visitor) override;
     llvm::Value* accept(ValueVisitor &visitor) override;
 
+    static bool classof(const ASTNode* node) {
+        return node->getKind() == NodeKind::Binary;
+    }
+
     Expr* getLHS() const {
         return LHS.get();
     }
@@ -92,7 +165,28 @@ public:
     }
 
     std::string toString() const override {
-        return "(" + LHS->toString() + " " + getOp() + " " + RHS->toString() + ")";
+        return printTree(*this);
+    }
+
+    void getChildSlots(std::vector<ExprUPtr*>& slots) override {
+        slots.push_back(&LHS);
+        slots.push_back(&RHS);
+    }
+
+protected:
+    void print(std::string& out, std::vector<PrintItem>& pending) const override {
+        out += '(';
+        pending.push_back({nullptr, ")"});
+        pending.push_back({RHS.get(), {}});
+        pending.push_back({nullptr, " "});
+        pending.push_back({nullptr, std::string_view(&Op, 1)});
+        pending.push_back({nullptr, " "});
+        pending.push_back({LHS.get(), {}});
+    }
+
+    void releaseChildren(std::vector<ExprUPtr>& children) override {
+        children.push_back(std::move(LHS));
+        children.push_back(std::move(RHS));
     }
 };
 
@@ -102,11 +196,15 @@ class UnaryExpr : public Expr {
 
 public:
     UnaryExpr(char Op, ExprUPtr Operand)
-        : op(Op), operand(std::move(Operand)) {}
+        : Expr(NodeKind::Unary), op(Op), operand(std::move(Operand)) {}
 
     void accept(ASTVisitor &visitor) override;
     llvm::Value* accept(ValueVisitor &visitor) override;
 
+    static bool classof(const ASTNode* node) {
+        return node->getKind() == NodeKind::Unary;
+    }
+
     const char getOp() const {
         return op;
     }
@@ -120,31 +218,47 @@ public:
     }
 
     std::string toString() const override {
-        return getOp() + operand->toString();
+        return printTree(*this);
     }
 
+    void getChildSlots(std::vector<ExprUPtr*>& slots) override {
+        slots.push_back(&operand);
+    }
+
+protected:
+    void print(std::string& out, std::vector<PrintItem>& pending) const override {
+        out += op;
+        pending.push_back({operand.get(), {}});
+    }
+
+    void releaseChildren(std::vector<ExprUPtr>& children) override {
+        children.push_back(std::move(operand));
+    }
 };
 
 class CallExpr : public Expr {
-    std::string callee;
+    Symbol callee;
     std::vector<ExprUPtr> args;
 
 public:
-    CallExpr(const std::string &callee, std::vector<ExprUPtr> args)
-        : callee(callee), args(std::move(args)) {}
+    CallExpr(Symbol callee, std::vector<ExprUPtr> args)
+        : Expr(NodeKind::Call), callee(callee), args(std::move(args)) {}
 
     void accept(ASTVisitor &visitor) override;
     llvm::Value* accept(ValueVisitor &visitor) override;
 
-    std::vector<Expr*> getArgs() const {
-        std::vector<Expr*> argsOut;
-        for (const auto &arg : args) {
-            argsOut.push_back(arg.get());
-        }
-        return argsOut;
+    static bool classof(const ASTNode* node) {
+        return node->getKind() == NodeKind::Call;
+    }
+
+    // A view over the arguments, sized and indexable, allocates nothing
+    auto getArgs() const {
+        return std::views::transform(args, [](const ExprUPtr& arg) {
+            return arg.get();
+        });
     }
 
-    const std::string& getCalleeName() const {
+    Symbol getCalleeName() const {
         return callee;
     }
 
@@ -157,15 +271,32 @@ public:
     }
 
     std::string toString() const override {
-        std::string result = callee + "(";
-        for (const auto &arg : args) {
-            result += arg->toString() + ", ";
+        return printTree(*this);
+    }
+
+    void getChildSlots(std::vector<ExprUPtr*>& slots) override {
+        for (auto& arg : args) {
+            slots.push_back(&arg);
         }
-        if (!args.empty()) {
-            result.erase(result.size() - 2); // Remove trailing comma and space
+    }
+
+protected:
+    void print(std::string& out, std::vector<PrintItem>& pending) const override {
+        out += callee.str();
+        out += '(';
+        pending.push_back({nullptr, ")"});
+        for (size_t i = args.size(); i-- > 0;) {
+            pending.push_back({args[i].get(), {}});
+            if (i) {
+                pending.push_back({nullptr, ", "});
+            }
+        }
+    }
+
+    void releaseChildren(std::vector<ExprUPtr>& children) override {
+        for (auto& arg : args) {
+            children.push_back(std::move(arg));
         }
-        result += ")";
-        return result;
     }
 };
 
@@ -175,11 +306,15 @@ class IfExpr : public Expr {
 public:
     IfExpr(ExprUPtr aCond, ExprUPtr aThen,
             ExprUPtr aElse) 
-        : Cond(std::move(aCond)), Then(std::move(aThen)), Else(std::move(aElse)) {}
+        : Expr(NodeKind::If), Cond(std::move(aCond)), Then(std::move(aThen)), Else(std::move(aElse)) {}
 
     void accept(ASTVisitor &visitor) override;
     llvm::Value* accept(ValueVisitor &visitor) override;
 
+    static bool classof(const ASTNode* node) {
+        return node->getKind() == NodeKind::If;
+    }
+
     Expr* getCond() const {
         return Cond.get();
     }
@@ -197,29 +332,51 @@ public:
     }
 
     std::string toString() const override {
-        std::string result = "if " + Cond->toString() + " then\n";
-        result += "\t" + Then->toString() + "\n";
-        result += "else\n";
-        result += "\t" + Else->toString();
-        return result;
+        return printTree(*this);
+    }
+
+    void getChildSlots(std::vector<ExprUPtr*>& slots) override {
+        slots.push_back(&Cond);
+        slots.push_back(&Then);
+        slots.push_back(&Else);
+    }
+
+protected:
+    void print(std::string& out, std::vector<PrintItem>& pending) const override {
+        out += "if ";
+        pending.push_back({Else.get(), {}});
+        pending.push_back({nullptr, "\nelse\n\t"});
+        pending.push_back({Then.get(), {}});
+        pending.push_back({nullptr, " then\n\t"});
+        pending.push_back({Cond.get(), {}});
+    }
+
+    void releaseChildren(std::vector<ExprUPtr>& children) override {
+        children.push_back(std::move(Cond));
+        children.push_back(std::move(Then));
+        children.push_back(std::move(Else));
     }
 };
 
 class ForExpr : public Expr {
-    std::string varName;
+    Symbol varName;
     ExprUPtr start, end, step, body;
 
 public:
-    ForExpr(const std::string& aVarName, ExprUPtr aStart,
+    ForExpr(Symbol aVarName, ExprUPtr aStart,
             ExprUPtr aEnd, ExprUPtr aStep,
             ExprUPtr aBody)
-        : varName(aVarName), start(std::move(aStart)), end(std::move(aEnd)),
+        : Expr(NodeKind::For), varName(aVarName), start(std::move(aStart)), end(std::move(aEnd)),
             step(std::move(aStep)), body(std::move(aBody)) {}
 
     void accept(ASTVisitor &visitor) override;
     llvm::Value* accept(ValueVisitor &visitor) override;
 
-    const std::string& getVarName() const {
+    static bool classof(const ASTNode* node) {
+        return node->getKind() == NodeKind::For;
+    }
+
+    Symbol getVarName() const {
         return varName;
     }
 
@@ -244,55 +401,104 @@ public:
     }
 
     std::string toString() const override {
-        std::string result = "for " + start->toString() + ", "
-            + end->toString() + ", " + step->toString() + "\n"
-            + "\t" + body->toString();
-        return result;
+        return printTree(*this);
+    }
+
+    void getChildSlots(std::vector<ExprUPtr*>& slots) override {
+        slots.push_back(&start);
+        slots.push_back(&end);
+        slots.push_back(&step);
+        slots.push_back(&body);
+    }
+
+protected:
+    void print(std::string& out, std::vector<PrintItem>& pending) const override {
+        out += "for ";
+        pending.push_back({body.get(), {}});
+        pending.push_back({nullptr, "\n\t"});
+        if (step) {
+            pending.push_back({step.get(), {}});
+            pending.push_back({nullptr, ", "});
+        }
+        pending.push_back({end.get(), {}});
+        pending.push_back({nullptr, ", "});
+        pending.push_back({start.get(), {}});
+    }
+
+    void releaseChildren(std::vector<ExprUPtr>& children) override {
+        children.push_back(std::move(start));
+        children.push_back(std::move(end));
+        children.push_back(std::move(step));
+        children.push_back(std::move(body));
     }
 };
 
-using VarNameVector = std::vector<std::pair<std::string, ExprUPtr>>;
+using VarNameVector = std::vector<std::pair<Symbol, ExprUPtr>>;
 class VarExpr : public Expr {
     VarNameVector varNames;
     ExprUPtr body;
 
 public:
     VarExpr(VarNameVector VarNames, ExprUPtr Body)
-        : varNames(std::move(VarNames)), body(std::move(Body)) {}
+        : Expr(NodeKind::Var), varNames(std::move(VarNames)), body(std::move(Body)) {}
 
     void accept(ASTVisitor &visitor) override;
     llvm::Value* accept(ValueVisitor &visitor) override;
 
+    static bool classof(const ASTNode* node) {
+        return node->getKind() == NodeKind::Var;
+    }
+
     const std::string getType() const override {
         return "Var";
     }
 
     std::string toString() const override {
-        std::string result = "var ";
-        for (const auto& var : varNames) {
-            result += var.first;
-            if (var.second) {
-                result += " = " + var.second->toString();
-            }
-            result += ", ";
-        }
+        return printTree(*this);
+    }
 
-        result = result.substr(0, result.size() - 2);
-        if (body) {
-            result += " in\n" + body->toString();
+    // A view of (name, initializer or null) pairs, made as they are read,
+    // so bind them by value or const reference
+    auto getVarNames() const {
+        return std::views::transform(varNames, [](const auto& var) {
+            return std::pair<Symbol, Expr*>(var.first, var.second.get());
+        });
+    }
+
+    Expr* getBody() const {
+        return body.get();
+    }
+
+    void getChildSlots(std::vector<ExprUPtr*>& slots) override {
+        for (auto& var : varNames) {
+            slots.push_back(&var.second);
         }
-        return result;
+        slots.push_back(&body);
     }
 
-    std::vector<std::pair<std::string, Expr*>> getVarNames() const {
-        std::vector<std::pair<std::string, Expr*>> result;
-        for (const auto& var : varNames) {
-            result.push_back(std::make_pair(var.first, var.second.get()));
+protected:
+    void print(std::string& out, std::vector<PrintItem>& pending) const override {
+        out += "var ";
+        if (body) {
+            pending.push_back({body.get(), {}});
+            pending.push_back({nullptr, " in\n"});
+        }
+        for (size_t i = varNames.size(); i-- > 0;) {
+            if (varNames[i].second) {
+                pending.push_back({varNames[i].second.get(), {}});
+                pending.push_back({nullptr, " = "});
+            }
+            pending.push_back({nullptr, varNames[i].first.str()});
+            if (i) {
+                pending.push_back({nullptr, ", "});
+            }
         }
-        return result;
     }
 
-    Expr* getBody() const {
-        return body.get();
+    void releaseChildren(std::vector<ExprUPtr>& children) override {
+        for (auto& var : varNames) {
+            children.push_back(std::move(var.second));
+        }
+        children.push_back(std::move(body));
     }
 };
\ No newline at end of file
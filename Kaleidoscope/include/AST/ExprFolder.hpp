@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "llvm/ADT/SmallPtrSet.h"
+
+#include "Expr.hpp"
+#include "Fcn.hpp"
+
+// Simplifies function bodies before codegen, so constant arithmetic is not
+// turned into IR only for InstCombine to take apart again. Results are
+// exactly what the generated code would compute at run time:
+//
+//   - builtin + - * < over two numbers become a number, < is true when
+//     either side is NaN like the fcmp ult codegen emits
+//   - x * 1, 1 * x, x - 0, x + -0 and -0 + x become x, which hold for every
+//     double including NaNs, infinities and signed zeros. x + 0 and x * 0
+//     do not and are kept.
+//   - an if with a number for a condition becomes the branch it takes,
+//     else for 0 and NaN, as long as the other branch holds nothing codegen
+//     could reject: numbers, ifs, builtin operators, the function's
+//     arguments, and calls and user operators `isCallable` knows. Folding
+//     must not turn a program that fails to compile into one that does.
+//
+// There are no builtin unary operators, those are calls to user code and
+// left alone, as is everything else that is not a builtin. The destination
+// of = is left as written, codegen checks it is a variable.
+//
+// Works bottom-up on an explicit stack, deep trees do not recurse. Nodes
+// shared by several parents, see ExprInterner, are folded once, and one
+// that drops out of a parent stays intact for the others. Arena nodes that
+// drop out stay in their arena until the function goes away, new numbers
+// are allocated on the heap.
+class ExprFolder {
+public:
+    // Whether a call to `callee` with that many arguments compiles. User
+    // operators are asked for as binary<op> and unary<op>.
+    using CallableFn = std::function<bool(Symbol callee, size_t numArgs)>;
+
+    // Without `isCallable`, branches with calls or user operators are kept
+    explicit ExprFolder(CallableFn isCallable = nullptr) : isCallable(std::move(isCallable)) {}
+
+    void fold(Fcn& fcn);
+    // Folds the tree in `root`, which may be replaced entirely
+    void fold(ExprUPtr& root);
+
+    // Nodes replaced so far
+    size_t getNumFolded() const {
+        return numFolded;
+    }
+
+private:
+    // Replaces the node in `slot` with a simpler one if it can, its
+    // children are folded already
+    void simplify(ExprUPtr& slot);
+    void replace(ExprUPtr& slot, ExprUPtr& child);
+    // Whether codegen of the tree under `root` cannot fail, so it can be
+    // dropped without hiding an error
+    bool compiles(Expr* root);
+
+    CallableFn isCallable;
+    // Of the function being folded, always in scope
+    std::vector<Symbol> arguments;
+
+    // A slot on the way down, and whether its children are pushed already
+    std::vector<std::pair<ExprUPtr*, bool>> pending;
+    std::vector<ExprUPtr*> children;
+    llvm::SmallPtrSet<const Expr*, 32> expanded;
+    size_t numFolded = 0;
+};
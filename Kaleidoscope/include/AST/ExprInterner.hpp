@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+#include "ASTArena.hpp"
+#include "Expr.hpp"
+#include "Symbol.hpp"
+
+// Hash-consing for the expressions of one item. Numbers, variables and
+// the builtin arithmetic operators over them have no side effects, so
+// structurally identical ones become a single node with several parents
+// and the item's AST becomes a DAG. A node reached twice on a walk is work
+// done twice, later stages can tell by comparing pointers.
+//
+// Nodes are looked up before they are created, so a repeated subtree costs
+// no arena memory at all. Only arena nodes are shared, since the ExprUPtrs
+// linking them do not own them. A shared node keeps the location of its
+// first occurrence, and anything that rewrites nodes in place has to expect
+// to see one several times.
+class ExprInterner {
+public:
+    // Each returns the existing equal node if there is one, or creates it
+    // in `arena` at `loc`
+    ExprUPtr getNumber(ASTArena& arena, double value);
+    ExprUPtr getVariable(ASTArena& arena, Symbol name, SourceOffset loc);
+    // Anything but builtin arithmetic over interned operands is created as
+    // a node of its own
+    ExprUPtr getBinary(ASTArena& arena, char op, ExprUPtr lhs, ExprUPtr rhs, SourceOffset loc);
+
+    // Equal subtrees hash equal, computed once when a node is interned.
+    // 0 for nodes that are not.
+    size_t getStructuralHash(const Expr* expr) const {
+        auto it = hashes.find(expr);
+        return it == hashes.end() ? 0 : it->second;
+    }
+
+    // Lookups that returned an existing node
+    size_t getNumShared() const {
+        return numShared;
+    }
+
+    // Forgets every node, before the arena they live in goes away
+    void clear() {
+        nodes.clear();
+        hashes.clear();
+    }
+
+private:
+    enum class Kind : uint8_t {
+        Number,
+        Variable,
+        Binary,
+    };
+
+    // Operands are interned already, so comparing them by pointer is a
+    // structural comparison
+    struct Key {
+        size_t hash;
+        Kind kind;
+        char op = 0;
+        uint64_t value = 0; // Bits of a number, id of a variable
+        const Expr* lhs = nullptr;
+        const Expr* rhs = nullptr;
+
+        bool operator==(const Key& other) const {
+            return kind == other.kind && op == other.op && value == other.value
+                && lhs == other.lhs && rhs == other.rhs;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            return key.hash;
+        }
+    };
+
+    // The node interned under `key`, or null
+    Expr* find(const Key& key);
+    // Interns a node just created for `key`
+    ExprUPtr record(const Key& key, ExprUPtr expr);
+
+    std::unordered_map<Key, Expr*, KeyHash> nodes;
+    std::unordered_map<const Expr*, size_t> hashes;
+    size_t numShared = 0;
+};
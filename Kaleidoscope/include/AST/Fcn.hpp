@@ -4,29 +4,41 @@
 #include <string>
 #include <vector>
 
+#include "ASTArena.hpp"
 #include "Expr.hpp"
 #include "Node.hpp"
+#include "Symbol.hpp"
 
 class FcnPrototype : public ASTNode {
-    std::string name;
-    std::vector<std::string> args;
+    Symbol name;
+    std::vector<Symbol> args;
     bool isOperator;
     unsigned binaryPrecedence;
 
 public:
-    FcnPrototype(const std::string &Name, std::vector<std::string> Args,
+    FcnPrototype(Symbol Name, std::vector<Symbol> Args,
                     bool IsOperator = false, unsigned Prec = 0)
-        : name(Name), args(std::move(Args)), 
+        : ASTNode(NodeKind::FcnPrototype), name(Name), args(std::move(Args)), 
+            isOperator(IsOperator), binaryPrecedence(Prec) {}
+
+    // Convenience for callers holding plain strings, interns every arg
+    FcnPrototype(Symbol Name, const std::vector<std::string>& Args,
+                    bool IsOperator = false, unsigned Prec = 0)
+        : ASTNode(NodeKind::FcnPrototype), name(Name), args(Args.begin(), Args.end()), 
             isOperator(IsOperator), binaryPrecedence(Prec) {}
         
     void accept(ASTVisitor &visitor) override;
     llvm::Value* accept(ValueVisitor &visitor) override;
 
-    const std::vector<std::string>& getArgs() const {
+    static bool classof(const ASTNode* node) {
+        return node->getKind() == NodeKind::FcnPrototype;
+    }
+
+    const std::vector<Symbol>& getArgs() const {
         return args;
     }
 
-    const std::string &getName() const {
+    Symbol getName() const {
         return name;
     }
 
@@ -40,25 +52,32 @@ public:
     char getOperatorName() const {
         assert(isUnaryOp() || isBinaryOp() && 
             "Not a binary or unary operator");
-        return name[name.size() - 1];
+        return name.str().back();
     }
 
     unsigned getBinaryPrecedence() const { return binaryPrecedence; }
 };
 
 class Fcn : public ASTNode {
+    // Declared first so the body nodes it holds are destroyed last
+    std::unique_ptr<ASTArena> arena;
     std::unique_ptr<FcnPrototype> prototype;
-    std::unique_ptr<Expr> body;
+    ExprUPtr body;
 
 public:
-    Fcn(std::unique_ptr<FcnPrototype> Prototype, std::unique_ptr<Expr> Body)
-        : prototype(std::move(Prototype)), body(std::move(Body)) {}
+    Fcn(std::unique_ptr<FcnPrototype> Prototype, ExprUPtr Body,
+            std::unique_ptr<ASTArena> Arena = nullptr)
+        : ASTNode(NodeKind::Fcn), arena(std::move(Arena)), prototype(std::move(Prototype)), body(std::move(Body)) {}
     
     void accept(ASTVisitor &visitor) override;
     llvm::Value* accept(ValueVisitor &visitor) override;
 
-    const std::string getName() const {
-        return prototype ? prototype->getName() : "";
+    static bool classof(const ASTNode* node) {
+        return node->getKind() == NodeKind::Fcn;
+    }
+
+    Symbol getName() const {
+        return prototype ? prototype->getName() : Symbol();
     }
 
     FcnPrototype* getPrototype() const {
@@ -69,10 +88,28 @@ public:
         return std::move(prototype);
     }
 
+    void setPrototype(std::unique_ptr<FcnPrototype> Prototype) {
+        prototype = std::move(Prototype);
+    }
+
     Expr* getBody() const {
         return body.get();
     }
 
+    ExprUPtr releaseBody() {
+        return std::move(body);
+    }
+
+    // The arena keeps the nodes it holds, so a new body may reuse them
+    void setBody(ExprUPtr Body) {
+        body = std::move(Body);
+    }
+
+    // Owns the body's nodes when it was parsed, null for hand-built bodies
+    const ASTArena* getArena() const {
+        return arena.get();
+    }
+
     const std::string getType() const override{
         return "Function";
     }
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "debug/SourceLocation.hpp"
+#include "Expr.hpp"
+#include "Symbol.hpp"
+
+// Struct-of-arrays copy of expression trees, for passes over a whole
+// program that would spend their time chasing child pointers through the
+// heap. Every node is an index into parallel arrays of kinds, locations
+// and payloads, and its operands are a contiguous run of indices.
+//
+// Nodes are stored children before parents, so a loop over the indices
+// sees every operand before the node using it and a bottom-up pass needs
+// no stack. walk() does that with static dispatch.
+class FlatAST {
+public:
+    using NodeId = uint32_t;
+
+    // Stands in for a missing for step or var initializer
+    static constexpr NodeId NONE = std::numeric_limits<NodeId>::max();
+
+    enum class Kind : uint8_t {
+        Number,
+        Variable,
+        Binary,
+        Unary,
+        Call,
+        If,
+        For,
+        Var,
+    };
+
+    FlatAST() {
+        operandBegin.push_back(0);
+    }
+
+    // Appends the tree under `root`, returns the id of `root`. A subtree
+    // shared by several parents, see ExprInterner, is copied for each.
+    // Not const, the tree is walked with an ASTVisitor.
+    NodeId append(Expr& root);
+
+    void clear();
+
+    size_t size() const {
+        return kinds.size();
+    }
+
+    Kind getKind(NodeId id) const {
+        return kinds[id];
+    }
+
+    SourceOffset getLoc(NodeId id) const {
+        return locs[id];
+    }
+
+    // Number only
+    double getNumber(NodeId id) const {
+        return payloads[id].number;
+    }
+
+    // Variable, the callee of a Call, or the loop variable of a For
+    Symbol getName(NodeId id) const {
+        return SymbolTable::get()->fromId(payloads[id].symbol);
+    }
+
+    // Binary and Unary only
+    char getOp(NodeId id) const {
+        return payloads[id].op;
+    }
+
+    // Binary: lhs, rhs. Unary: operand. Call: args. If: cond, then, else.
+    // For: start, end, step or NONE, body. Var: an initializer or NONE
+    // per name, then the body.
+    std::span<const NodeId> getOperands(NodeId id) const {
+        return std::span<const NodeId>(operands).subspan(operandBegin[id], operandBegin[id + 1] - operandBegin[id]);
+    }
+
+    // Var only, in the order of its initializers
+    std::span<const Symbol> getVarNames(NodeId id) const {
+        return std::span<const Symbol>(varNames).subspan(payloads[id].varNames, getOperands(id).size() - 1);
+    }
+
+    // Calls visitor.visitNumber(id), visitVariable(id) and so on for nodes
+    // [begin, end), children before parents. Resolved at compile time, the
+    // visitor needs no common base.
+    template<typename V>
+    void walk(V& visitor, NodeId begin = 0, NodeId end = NONE) const {
+        end = end == NONE ? static_cast<NodeId>(size()) : end;
+        for (NodeId id = begin; id < end; ++id) {
+            switch (kinds[id]) {
+                case Kind::Number:
+                    visitor.visitNumber(id);
+                    break;
+                case Kind::Variable:
+                    visitor.visitVariable(id);
+                    break;
+                case Kind::Binary:
+                    visitor.visitBinary(id);
+                    break;
+                case Kind::Unary:
+                    visitor.visitUnary(id);
+                    break;
+                case Kind::Call:
+                    visitor.visitCall(id);
+                    break;
+                case Kind::If:
+                    visitor.visitIf(id);
+                    break;
+                case Kind::For:
+                    visitor.visitFor(id);
+                    break;
+                case Kind::Var:
+                    visitor.visitVar(id);
+                    break;
+            }
+        }
+    }
+
+private:
+    friend class FlatASTBuilder;
+
+    union Payload {
+        double number;
+        uint32_t symbol;
+        char op;
+        uint32_t varNames; // Index of the first one
+    };
+
+    NodeId addNode(Kind kind, SourceOffset loc, Payload payload);
+
+    std::vector<Kind> kinds;
+    std::vector<SourceOffset> locs;
+    std::vector<Payload> payloads;
+    // One more entry than there are nodes, node i owns operands
+    // [operandBegin[i], operandBegin[i + 1])
+    std::vector<uint32_t> operandBegin;
+    std::vector<NodeId> operands;
+    std::vector<Symbol> varNames;
+};
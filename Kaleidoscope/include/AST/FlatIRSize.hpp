@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "FlatAST.hpp"
+
+// How many LLVM instructions CodegenVisitor emits for the trees in a
+// FlatAST, before any optimization passes run. Mirrors what every node
+// lowers to, including the constants IRBuilder folds. An analysis over the
+// flat form that sizes a whole program without building any IR, the bench
+// runs it against CodegenVisitor. Nothing in the Driver uses it.
+//
+// One bottom-up walk over the nodes computes the size of every subtree.
+class FlatIRSize {
+public:
+    explicit FlatIRSize(const FlatAST& ast);
+
+    // Instructions emitted for the subtree under `id`
+    size_t getSize(FlatAST::NodeId id) const {
+        return sizes[id];
+    }
+
+    // Whether the subtree under `id` lowers to a constant
+    bool isConstant(FlatAST::NodeId id) const {
+        return constants[id];
+    }
+
+    // A function with `numArgs` arguments and the body under `body`, each
+    // argument gets an alloca and a store, the body a ret
+    size_t getFunctionSize(FlatAST::NodeId body, size_t numArgs) const {
+        return 2 * numArgs + sizes[body] + 1;
+    }
+
+    // Called by FlatAST::walk()
+    void visitNumber(FlatAST::NodeId id);
+    void visitVariable(FlatAST::NodeId id);
+    void visitBinary(FlatAST::NodeId id);
+    void visitUnary(FlatAST::NodeId id);
+    void visitCall(FlatAST::NodeId id);
+    void visitIf(FlatAST::NodeId id);
+    void visitFor(FlatAST::NodeId id);
+    void visitVar(FlatAST::NodeId id);
+
+private:
+    const FlatAST& ast;
+    std::vector<uint32_t> sizes;
+    std::vector<bool> constants;
+
+    // Size of an operand, missing ones emit nothing
+    uint32_t sizeOf(FlatAST::NodeId id) const {
+        return id == FlatAST::NONE ? 0 : sizes[id];
+    }
+
+    void add(uint32_t size, bool constant) {
+        sizes.push_back(size);
+        constants.push_back(constant);
+    }
+};
@@ -1,17 +1,47 @@
 #pragma once
 
 #include <cassert>
+#include <cstdint>
 #include <string>
 
 #include "llvm/IR/Value.h"
 
 #include "debug/SourceLocation.hpp"
 
+class ASTArena;
 class ASTVisitor;
 class ValueVisitor;
 
+// Concrete class of a node, for dispatching with a switch instead of a
+// virtual accept(), see StaticVisitor. Other covers every class outside
+// this list, like the mocks, and only those go through accept().
+enum class NodeKind : uint8_t {
+    Other,
+    Number,
+    Variable,
+    Binary,
+    Unary,
+    Call,
+    If,
+    For,
+    Var,
+    FcnPrototype,
+    Fcn,
+};
+
 class ASTNode {
-    SourceLocation Loc;
+    friend class ASTArena;
+
+    SourceOffset Loc = 0;
+    bool InArena = false;
+    // Fills padding after InArena, nodes are no larger for it
+    NodeKind Kind = NodeKind::Other;
+    // Offset 0 is a real location too, the start of the source
+    bool HasLoc = false;
+
+protected:
+    ASTNode() = default;
+    explicit ASTNode(NodeKind kind) : Kind(kind) {}
 
 public:
     virtual ~ASTNode() = default;
@@ -19,12 +49,21 @@ public:
     virtual void accept(ASTVisitor &visitor) = 0;
     virtual llvm::Value* accept(ValueVisitor &visitor) = 0;
 
-    void setSourceLoc(SourceLocation loc) {
+    void setSourceLoc(SourceOffset loc) {
         Loc = loc;
+        HasLoc = true;
     }
 
-    int getLine() const { return Loc.Line; }
-    int getCol() const { return Loc.Col; }
+    // Not every node is given one, a NumberExpr for instance
+    bool hasSourceLoc() const { return HasLoc; }
+
+    // Resolve through a SourceManager to get a line and column
+    SourceOffset getSourceLoc() const { return Loc; }
+
+    // Arena nodes are destroyed by their ASTArena, never deleted one by one
+    bool isArenaAllocated() const { return InArena; }
+
+    NodeKind getKind() const { return Kind; }
 
     virtual const std::string getType() const = 0;
 };
\ No newline at end of file
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "ASTVisitor.hpp"
+
+// Calls `fn` on every node of an item, parents before children. Children
+// go on an explicit stack instead of being visited recursively, so trees
+// as deep as the parser accepts don't overflow the call stack.
+class NodeWalker : public ASTVisitor {
+public:
+    explicit NodeWalker(std::function<void(ASTNode&)> fn) : fn(std::move(fn)) {}
+
+    void visitNumberExpr(NumberExpr &expr) override {
+        fn(expr);
+    }
+
+    void visitVariableExpr(VariableExpr &expr) override {
+        fn(expr);
+    }
+
+    void visitBinaryExpr(BinaryExpr &expr) override {
+        fn(expr);
+        push(expr.getRHS());
+        push(expr.getLHS());
+        drain();
+    }
+
+    void visitUnaryExpr(UnaryExpr &expr) override {
+        fn(expr);
+        push(expr.getOperand());
+        drain();
+    }
+
+    void visitCallExpr(CallExpr &expr) override {
+        fn(expr);
+        auto args = expr.getArgs();
+        for (size_t i = args.size(); i-- > 0;) {
+            push(args[i]);
+        }
+        drain();
+    }
+
+    void visitIfExpr(IfExpr &expr) override {
+        fn(expr);
+        push(expr.getElse());
+        push(expr.getThen());
+        push(expr.getCond());
+        drain();
+    }
+
+    void visitForExpr(ForExpr &expr) override {
+        fn(expr);
+        push(expr.getBody());
+        push(expr.getStep());
+        push(expr.getEnd());
+        push(expr.getStart());
+        drain();
+    }
+
+    void visitVarExpr(VarExpr &expr) override {
+        fn(expr);
+        push(expr.getBody());
+        auto vars = expr.getVarNames();
+        for (size_t i = vars.size(); i-- > 0;) {
+            push(vars[i].second);
+        }
+        drain();
+    }
+
+    void visitFcnPrototype(FcnPrototype &proto) override {
+        fn(proto);
+    }
+
+    void visitFcn(Fcn &fcn) override {
+        fn(fcn);
+        push(fcn.getBody());
+        push(fcn.getPrototype());
+        drain();
+    }
+
+private:
+    std::function<void(ASTNode&)> fn;
+    std::vector<ASTNode*> pending;
+    bool draining = false;
+
+    // Pushed last child first, so children come off the stack in order
+    void push(ASTNode* node) {
+        if (node) {
+            pending.push_back(node);
+        }
+    }
+
+    // Only the visit a walk started with empties the stack, the visits it
+    // makes just push their children
+    void drain() {
+        if (draining) {
+            return;
+        }
+        draining = true;
+        while (!pending.empty()) {
+            ASTNode* node = pending.back();
+            pending.pop_back();
+            node->accept(*this);
+        }
+        draining = false;
+    }
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+enum class Associativity : uint8_t {
+    Left,
+    Right,
+};
+
+// The operators of one compilation session, indexed by operator character.
+// Starts out with the builtin binary operators; codegen adds the ones
+// defined with `def binary` and `def unary`. The parser reads it on every
+// token of an expression, so lookups are a single array access.
+class OperatorTable {
+public:
+    OperatorTable();
+
+    // The builtins only, for parsing outside of a session
+    static const OperatorTable& builtins();
+
+    // Precedence of a binary operator token, -1 for anything else
+    int getPrecedence(int tok) const {
+        return inRange(tok) ? entries[tok].precedence : -1;
+    }
+
+    bool isRightAssociative(int tok) const {
+        return inRange(tok) && entries[tok].associativity == Associativity::Right;
+    }
+
+    bool isUnaryOperator(int tok) const {
+        return inRange(tok) && entries[tok].unary;
+    }
+
+    void setBinaryOperator(char op, int precedence, Associativity associativity = Associativity::Left) {
+        auto& entry = entries[static_cast<unsigned char>(op)];
+        entry.precedence = static_cast<int8_t>(precedence);
+        entry.associativity = associativity;
+    }
+
+    void removeBinaryOperator(char op) {
+        auto& entry = entries[static_cast<unsigned char>(op)];
+        entry.precedence = -1;
+        entry.associativity = Associativity::Left;
+    }
+
+    void setUnaryOperator(char op, bool defined = true) {
+        entries[static_cast<unsigned char>(op)].unary = defined;
+    }
+
+    // Hash of every entry, equal tables parse everything the same way
+    uint64_t getFingerprint() const;
+
+    bool operator==(const OperatorTable& other) const = default;
+
+private:
+    struct Entry {
+        int8_t precedence = -1; // Definitions only allow 1-100
+        Associativity associativity = Associativity::Left;
+        bool unary = false;
+
+        bool operator==(const Entry& other) const = default;
+    };
+
+    // Keywords and other named tokens are negative
+    static bool inRange(int tok) {
+        return static_cast<unsigned>(tok) < 256;
+    }
+
+    std::array<Entry, 256> entries;
+};
@@ -1,5 +0,0 @@
-#pragma once
-
-#include <unordered_map>
-
-extern std::unordered_map<char, int> BIN_OP_PRECEDENCE;
\ No newline at end of file
@@ -7,6 +7,8 @@
 #include "llvm/IR/Function.h"
 #include "llvm/IR/Module.h"
 
+#include "Symbol.hpp"
+
 class FcnPrototype;
 class CodegenVisitor;
 
@@ -27,8 +29,8 @@ public:
         get()->module = aModule;
     }
 
-    static void addFcnPrototype(const std::string& name, std::unique_ptr<FcnPrototype> fcnProto);
-    static llvm::Function* getFunction(const std::string& name, CodegenVisitor& visitor);
+    static void addFcnPrototype(Symbol name, std::unique_ptr<FcnPrototype> fcnProto);
+    static llvm::Function* getFunction(Symbol name, CodegenVisitor& visitor);
 
     PrototypeRegistry(const PrototypeRegistry&) = delete;
     PrototypeRegistry& operator=(const PrototypeRegistry&) = delete;
@@ -38,9 +40,9 @@ public:
 private:
     PrototypeRegistry() = default;
 
-    FcnPrototype* getFcnPrototype(const std::string& name);
+    FcnPrototype* getFcnPrototype(Symbol name);
 
     llvm::Module* module;
-    std::unordered_map<std::string, std::unique_ptr<FcnPrototype>> fcnPrototypes;
+    std::unordered_map<Symbol, std::unique_ptr<FcnPrototype>> fcnPrototypes;
     static std::unique_ptr<PrototypeRegistry> instance;
 };
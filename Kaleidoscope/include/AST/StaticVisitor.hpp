@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Expr.hpp"
+#include "Fcn.hpp"
+
+// Visits nodes by switching on ASTNode::getKind(), where accept() costs two
+// virtual calls per node. `Derived` has the visit methods of ASTVisitor or
+// ValueVisitor returning `RetTy`, and since they are called on the derived
+// type, a final class gets them inlined into the switch.
+//
+// Nodes of kind Other, mocks and anything else outside the AST's own
+// classes, go to Derived::visitOther, which usually hands them to accept().
+//
+//   class DepthCounter : public StaticVisitor<DepthCounter, size_t> {
+//   public:
+//       size_t visitNumberExpr(NumberExpr&) { return 1; }
+//       ...
+//   };
+template<typename Derived, typename RetTy = void>
+class StaticVisitor {
+public:
+    RetTy visit(ASTNode& node) {
+        Derived& self = static_cast<Derived&>(*this);
+        switch (node.getKind()) {
+            case NodeKind::Number:
+                return self.visitNumberExpr(static_cast<NumberExpr&>(node));
+            case NodeKind::Variable:
+                return self.visitVariableExpr(static_cast<VariableExpr&>(node));
+            case NodeKind::Binary:
+                return self.visitBinaryExpr(static_cast<BinaryExpr&>(node));
+            case NodeKind::Unary:
+                return self.visitUnaryExpr(static_cast<UnaryExpr&>(node));
+            case NodeKind::Call:
+                return self.visitCallExpr(static_cast<CallExpr&>(node));
+            case NodeKind::If:
+                return self.visitIfExpr(static_cast<IfExpr&>(node));
+            case NodeKind::For:
+                return self.visitForExpr(static_cast<ForExpr&>(node));
+            case NodeKind::Var:
+                return self.visitVarExpr(static_cast<VarExpr&>(node));
+            case NodeKind::FcnPrototype:
+                return self.visitFcnPrototype(static_cast<FcnPrototype&>(node));
+            case NodeKind::Fcn:
+                return self.visitFcn(static_cast<Fcn&>(node));
+            case NodeKind::Other:
+                break;
+        }
+        return self.visitOther(node);
+    }
+};
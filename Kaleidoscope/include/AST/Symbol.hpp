@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "llvm/ADT/StringMap.h"
+
+// Handle to an interned identifier. Equal strings always intern to the
+// same id, so symbols compare and hash as plain integers. The empty
+// string is always id 0, which is also what a default Symbol holds.
+class Symbol {
+public:
+    Symbol() = default;
+    Symbol(std::string_view str);
+    Symbol(const std::string& str) : Symbol(std::string_view(str)) {}
+    Symbol(const char* str) : Symbol(std::string_view(str)) {}
+
+    uint32_t getId() const {
+        return id;
+    }
+
+    bool empty() const {
+        return id == 0;
+    }
+
+    // Stable for the lifetime of the process
+    std::string_view str() const;
+
+    bool operator==(const Symbol& other) const = default;
+
+private:
+    uint32_t id = 0;
+
+    explicit Symbol(uint32_t Id) : id(Id) {}
+    friend class SymbolTable;
+};
+
+inline std::ostream& operator<<(std::ostream& os, const Symbol& sym) {
+    return os << sym.str();
+}
+
+template<>
+struct std::hash<Symbol> {
+    size_t operator()(const Symbol& sym) const noexcept {
+        return std::hash<uint32_t>()(sym.getId());
+    }
+};
+
+// Session-wide interner backing every Symbol. Strings are never
+// released, so the views handed out stay valid until exit. Safe to use
+// from several threads once get() has been called on one of them.
+class SymbolTable {
+public:
+    static SymbolTable* get() {
+        if (!instance) {
+            instance.reset(new SymbolTable());
+        }
+        return instance.get();
+    }
+
+    Symbol intern(std::string_view str);
+
+    std::string_view getString(Symbol sym) const {
+        std::shared_lock lock(mutex);
+        return strings[sym.getId()];
+    }
+
+    // Inverse of Symbol::getId, for symbols stored as raw ids
+    Symbol fromId(uint32_t id) const {
+        assert(id < size() && "Symbol id was never interned");
+        return Symbol(id);
+    }
+
+    size_t size() const {
+        std::shared_lock lock(mutex);
+        return strings.size();
+    }
+
+    // Characters of every string interned so far
+    size_t getStringBytes() const {
+        std::shared_lock lock(mutex);
+        return stringBytes;
+    }
+
+    SymbolTable(const SymbolTable&) = delete;
+    SymbolTable& operator=(const SymbolTable&) = delete;
+
+private:
+    SymbolTable();
+
+    mutable std::shared_mutex mutex;
+    llvm::StringMap<uint32_t> ids;
+    std::vector<std::string_view> strings;
+    size_t stringBytes = 0;
+    static std::unique_ptr<SymbolTable> instance;
+};
+
+inline Symbol::Symbol(std::string_view str) 
+    : id(SymbolTable::get()->intern(str).id) {}
+
+inline std::string_view Symbol::str() const {
+    return SymbolTable::get()->getString(*this);
+}
@@ -1,6 +1,6 @@
 #pragma once
 
-#include <map>
+#include <unordered_map>
 
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/Module.h"
@@ -9,6 +9,9 @@
 
 #include "Expr.hpp"
 #include "Fcn.hpp"
+#include "OperatorTable.hpp"
+#include "StaticVisitor.hpp"
+#include "Symbol.hpp"
 
 class ValueVisitor {
 public:
@@ -25,10 +28,16 @@ public:
     virtual llvm::Value* visitFcn(Fcn &fcn) = 0;
 };
 
-class CodegenVisitor : public ValueVisitor {
+// Final, so visiting children with visit() instead of accept() resolves
+// every call at compile time
+class CodegenVisitor final : public ValueVisitor,
+                            public StaticVisitor<CodegenVisitor, llvm::Value*> {
 public:
-    CodegenVisitor(llvm::LLVMContext* ctx, llvm::Module* mod, llvm::IRBuilder<>* build)
-        : context(ctx), module(mod), builder(build) {}
+    // Operator definitions are recorded in `ops`, which the session's
+    // parser reads
+    CodegenVisitor(llvm::LLVMContext* ctx, llvm::Module* mod, llvm::IRBuilder<>* build,
+                    OperatorTable& ops)
+        : context(ctx), module(mod), builder(build), operators(ops) {}
 
     llvm::Value* visitNumberExpr(NumberExpr &expr) override;
     llvm::Value* visitVariableExpr(VariableExpr &expr) override;
@@ -42,6 +51,10 @@ public:
     llvm::Value* visitFcnPrototype(FcnPrototype &proto) override;
     llvm::Value* visitFcn(Fcn &fcn) override;
 
+    llvm::Value* visitOther(ASTNode &node) {
+        return node.accept(static_cast<ValueVisitor&>(*this));
+    }
+
     void setFPM(llvm::FunctionPassManager* FPM) {
         fpm = FPM;
     }
@@ -50,7 +63,7 @@ public:
         fam = FAM;
     }
 
-    void setNamedValue(const std::string& name, llvm::AllocaInst* allocaInst) {
+    void setNamedValue(Symbol name, llvm::AllocaInst* allocaInst) {
         namedValues[name] = allocaInst;
     }
 
@@ -67,6 +80,7 @@ private:
     llvm::LLVMContext* context;
     llvm::FunctionPassManager* fpm;
     llvm::FunctionAnalysisManager* fam;
+    OperatorTable& operators;
 
     /// The LLVM module holds functions and global variables, it is
     /// the top-level container for LLVM IR code.
@@ -74,7 +88,7 @@ private:
 
     // Currently only mantains function arguments and loop
     // induction variables
-    std::map<std::string, llvm::AllocaInst*> namedValues;
+    std::unordered_map<Symbol, llvm::AllocaInst*> namedValues;
 
     llvm::Value* logError(const std::string &message) {
         (void)message;
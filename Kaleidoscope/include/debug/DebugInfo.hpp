@@ -4,6 +4,9 @@
 #include "llvm/IR/DIBuilder.h"
 #include "llvm/IR/IRBuilder.h"
 
+#include "SourceManager.hpp"
+
+class ASTNode;
 class Expr;
 
 extern std::unique_ptr<llvm::DIBuilder> DBuilder;
@@ -12,8 +15,11 @@ struct DebugInfo {
     llvm::DICompileUnit *TheCU;
     llvm::DIType *DblTy;
     std::vector<llvm::DIScope*> LexicalBlocks;
+    // Resolves node offsets, locations are all 0 without one
+    const SourceManager* Sources = nullptr;
 
     void emitLocation(llvm::IRBuilder<>* builder, Expr* expr);
+    SourceLocation getLocation(const ASTNode* node) const;
     llvm::DIType *getDoubleTy();
 };
 
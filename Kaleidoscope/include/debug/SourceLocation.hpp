@@ -1,6 +1,12 @@
 #pragma once
 
+#include <cstdint>
+
+// Byte offset from the start of the source. This is what the front end
+// and the AST store, see SourceManager for turning it into a line/column.
+using SourceOffset = uint32_t;
+
 struct SourceLocation {
     int Line = 0;
     int Col = 0;
-};
\ No newline at end of file
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "llvm/Support/MemoryBuffer.h"
+
+#include "SourceLocation.hpp"
+
+// Holds the source being compiled and resolves SourceOffsets into 1-based
+// lines and columns. The line index is only built the first time a
+// location is asked for, so compiling without diagnostics or debug info
+// never pays for it. '\n', '\r' and "\r\n" each end a line.
+class SourceManager {
+public:
+    // Views `source`, which must outlive the manager
+    explicit SourceManager(std::string_view source) : source(source) {}
+
+    explicit SourceManager(std::unique_ptr<llvm::MemoryBuffer> buffer)
+        : buffer(std::move(buffer)), 
+            source(this->buffer->getBufferStart(), this->buffer->getBufferSize()) {}
+
+    std::string_view getSource() const {
+        return source;
+    }
+
+    // Offsets past the end resolve to the end of the last line
+    SourceLocation getLocation(SourceOffset offset) const;
+
+    size_t getNumLines() const {
+        buildLineIndex();
+        return lineStarts.size();
+    }
+
+private:
+    void buildLineIndex() const;
+
+    std::unique_ptr<llvm::MemoryBuffer> buffer;
+    std::string_view source;
+    mutable std::vector<SourceOffset> lineStarts; // Empty until first needed
+};
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "AST/ASTSerializer.hpp"
+#include "AST/Fcn.hpp"
+#include "AST/OperatorTable.hpp"
+#include "debug/SourceLocation.hpp"
+#include "Diagnostic.hpp"
+
+namespace lang {
+
+// On-disk cache of parsed top-level items, so recompiling a mostly
+// unchanged file skips parsing everything that did not change.
+//
+// Item boundaries are only known after parsing, so the source is split
+// into chunks instead, each starting at a line that starts with def or
+// extern (see startsTopLevelItem). A chunk is keyed by a hash of its text
+// and of the operators defined before it, and its entry holds every item
+// in it plus the errors parsing it reported. The text is stored too, so a
+// hash collision is a miss rather than the wrong items.
+//
+// The file is read once up front. save() writes back the entries that
+// were looked up or stored since, so it does not grow without bound as
+// the source is edited.
+class ASTCache {
+public:
+    // Starts out empty if the file is missing, corrupt, or from another
+    // version of this format
+    explicit ASTCache(std::string path);
+
+    static std::vector<std::string_view> splitChunks(std::string_view source);
+
+    static uint64_t getKey(std::string_view chunk, const OperatorTable& operators);
+
+    // The entry stored under `key` for `chunk`, or null
+    const std::string* lookup(uint64_t key, std::string_view chunk);
+
+    void store(uint64_t key, std::string_view chunk, std::string entry);
+
+    // Returns false if the file could not be written
+    bool save() const;
+
+    size_t getNumEntries() const {
+        return entries.size();
+    }
+
+private:
+    struct Entry {
+        std::string text;
+        std::string data;
+        bool used = false;
+    };
+
+    std::string path;
+    std::unordered_map<uint64_t, Entry> entries;
+};
+
+enum class CachedItemKind : uint8_t {
+    Definition,
+    Extern,
+    Expression,
+    Error, // Failed to parse
+};
+
+// Builds one ASTCache entry. Locations are stored relative to `base`, the
+// start of the chunk, so a chunk that moved within the file still hits.
+class CacheEntryWriter {
+public:
+    explicit CacheEntryWriter(SourceOffset base) : writer(items, base), base(base) {}
+
+    // Before codegen, which takes a definition's prototype. `end` is where
+    // the next item starts parsing. `fcn` is set for a Definition or an
+    // Expression and `proto` for an Extern.
+    void addItem(CachedItemKind kind, SourceOffset end, Fcn* fcn, const FcnPrototype* proto);
+
+    // After codegen, the operators the next item is parsed with
+    void addOperators(const OperatorTable& operators);
+
+    std::string finish(const std::vector<Diagnostic>& diagnostics);
+
+private:
+    std::string items;
+    ASTWriter writer;
+    SourceOffset base;
+};
+
+// Reads what a CacheEntryWriter wrote, in the same order. Every read
+// returns false on a malformed entry.
+class CacheEntryReader {
+public:
+    struct Item {
+        CachedItemKind kind = CachedItemKind::Error;
+        SourceOffset end = 0;
+        std::unique_ptr<Fcn> fcn;
+        std::unique_ptr<FcnPrototype> proto;
+    };
+
+    CacheEntryReader(std::string_view entry, SourceOffset base) : reader(entry, base) {}
+
+    bool readDiagnostics(std::vector<Diagnostic>& diagnostics);
+    bool readItem(Item& item);
+    bool readOperators(uint64_t& fingerprint);
+
+    bool atEnd() const {
+        return reader.atEnd();
+    }
+
+private:
+    ASTReader reader;
+};
+
+} // namespace lang
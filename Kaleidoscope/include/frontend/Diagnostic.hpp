@@ -0,0 +1,27 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "debug/SourceLocation.hpp"
+
+class SourceManager;
+
+namespace lang {
+
+struct Diagnostic {
+    SourceOffset loc;
+    std::string message;
+};
+
+// Prints one `file:line:col: error: message` line per diagnostic
+void printDiagnostics(std::ostream& out, std::string_view filename, const SourceManager& sources,
+                      const std::vector<Diagnostic>& diagnostics);
+
+// Prints `name:offset: error: message`, for input that is gone by the time
+// the diagnostic is reported, like a stream
+void printDiagnostic(std::ostream& out, std::string_view name, const Diagnostic& diag);
+
+} // namespace lang
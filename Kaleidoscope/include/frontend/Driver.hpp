@@ -10,10 +10,19 @@
 #include "llvm/Transforms/Scalar/Reassociate.h"
 #include "llvm/Transforms/Scalar/SimplifyCFG.h"
 #include "llvm/Transforms/Utils/Mem2Reg.h"
+#include <algorithm>
 #include <cstdarg>
+#include <functional>
+#include <unordered_set>
 
+#include "AST/ASTStats.hpp"
+#include "AST/ExprFolder.hpp"
+#include "AST/NodeWalker.hpp"
 #include "AST/PrototypeRegistry.hpp"
 #include "AST/ValueVisitor.hpp"
+#include "frontend/ASTCache.hpp"
+#include "frontend/IncrementalParser.hpp"
+#include "frontend/ParallelParser.hpp"
 #include "frontend/Parser.hpp"
 #include "JIT/KaleidoscopeJITCopy.h"
 
@@ -24,14 +33,37 @@ using namespace llvm::orc;
 class Driver {
 public:
     Driver(const std::string& moduleName, std::istream& stream, bool isInteractive, bool useJIT = true) 
-        : ModuleName(moduleName), lexer(stream), parser(lexer), 
+        : ModuleName(moduleName), lexer(stream), parser(lexer, operators), 
             interactive(isInteractive), isJIT(useJIT) {
+        initializeJIT();
+    }
 
-        jit = ExitOnErr(KaleidoscopeJIT::Create());
+    // Lex straight out of an in-memory source, the source must outlive the driver
+    Driver(const std::string& moduleName, std::string_view source, bool isInteractive, bool useJIT = true) 
+        : ModuleName(moduleName), lexer(source), parser(lexer, operators), 
+            interactive(isInteractive), isJIT(useJIT) {
+        initializeJIT();
+    }
 
-        // Prime the first token
-        logInteractive("ready> ");
-        lexer.advance();   
+    // Lex a stream chunk by chunk, releasing chunks after each top-level item
+    Driver(const std::string& moduleName, StreamSource& source, bool isInteractive, bool useJIT = true) 
+        : ModuleName(moduleName), lexer(source), parser(lexer, operators), 
+            interactive(isInteractive), isJIT(useJIT) {
+        initializeJIT();
+    }
+
+    // Parse tokens that were lexed up front, the tokens must outlive the driver
+    Driver(const std::string& moduleName, const TokenStream& tokens, bool isInteractive, bool useJIT = true) 
+        : ModuleName(moduleName), lexer(tokens), parser(lexer, operators), 
+            interactive(isInteractive), isJIT(useJIT), tokenStream(&tokens) {
+        initializeJIT();
+    }
+
+    // Incremental mode, see update()
+    Driver(const std::string& moduleName, bool isInteractive, bool useJIT = true) 
+        : ModuleName(moduleName), lexer(std::string_view()), parser(lexer, operators), 
+            interactive(isInteractive), isJIT(useJIT) {
+        initializeJIT();
     }
 
     void initializeModule() {
@@ -43,7 +75,7 @@ public:
         PrototypeRegistry::get()->setModule(module.get());
 
         builder = std::make_unique<IRBuilder<>>(*context);
-        visitor = std::make_unique<CodegenVisitor>(context.get(), module.get(), builder.get());
+        visitor = std::make_unique<CodegenVisitor>(context.get(), module.get(), builder.get(), operators);
     }
 
 
@@ -56,9 +88,55 @@ public:
         return module.get();
     }
 
+    /// Lexer and parser errors so far, in source order. Leaves out those
+    /// already handed to a diagnostic handler. In incremental mode, those
+    /// of the current version of the source.
+    std::vector<Diagnostic> getDiagnostics() const {
+        std::vector<Diagnostic> result = lexer.getDiagnostics();
+        result.insert(result.end(), parser.getDiagnostics().begin(), parser.getDiagnostics().end());
+        result.insert(result.end(), diagnostics.begin(), diagnostics.end());
+        std::vector<Diagnostic> versionDiagnostics = incremental.getDiagnostics();
+        result.insert(result.end(), versionDiagnostics.begin(), versionDiagnostics.end());
+        std::stable_sort(result.begin(), result.end(), [](const Diagnostic& a, const Diagnostic& b) {
+            return a.loc < b.loc;
+        });
+        return result;
+    }
+
+    /// MainLoop() hands the errors of each item to `handler` once the item
+    /// is done and forgets them, instead of keeping every one until the
+    /// end of the input. For input that is not kept around, like streams.
+    void setDiagnosticHandler(std::function<void(const Diagnostic&)> handler) {
+        diagnosticHandler = std::move(handler);
+    }
+
+    /// Token stream mode only. Definitions are parsed and compiled the first
+    /// time something being compiled calls them, instead of where they are.
+    /// Operator definitions and redefinitions are still compiled right away.
+    void setLazyDefinitions(bool enable) {
+        assert((!enable || tokenStream) && "lazy definitions need a TokenStream");
+        lazy = enable;
+    }
+
+    /// Records every item MainLoop() parses in `stats`, or nothing when
+    /// null. Lazy definitions are not parsed there and are left out.
+    void setStats(ASTStats* collector) {
+        stats = collector;
+    }
+
+    /// Whether bodies go through an ExprFolder before codegen, on by
+    /// default
+    void setConstantFolding(bool enable) {
+        foldConstants = enable;
+    }
+
     /// top ::= definition | external | expression | ';'
     void MainLoop() {
         while (true) {
+            // Nothing refers to the input of earlier items anymore
+            lexer.releaseConsumedInput();
+            reportDiagnostics();
+
             switch (lexer.getCurrentToken()) {
                 case tok_eof:
                     logInteractive("Goodbye!\n");
@@ -79,7 +157,132 @@ public:
             }
         }
     }
+
+    /// Token stream mode only. Parses every top-level item on up to `jobs`
+    /// threads first, then compiles them in source order like MainLoop().
+    void ParallelMainLoop(unsigned jobs) {
+        assert(tokenStream && "ParallelMainLoop needs a TokenStream");
+        ParallelParser parallel(*tokenStream, operators);
+        std::vector<ParallelParser::Item> items = parallel.parse(jobs);
+        diagnostics.insert(diagnostics.end(), parallel.getDiagnostics().begin(), parallel.getDiagnostics().end());
+        for (ParallelParser::Item& item : items) {
+            switch (item.kind) {
+                case ParallelParser::ItemKind::Definition:
+                    compileDefinition(*item.fcn);
+                    break;
+                case ParallelParser::ItemKind::Extern:
+                    compileExtern(std::move(item.proto));
+                    break;
+                case ParallelParser::ItemKind::Expression:
+                    compileTopLevelExpression(*item.fcn);
+                    break;
+                case ParallelParser::ItemKind::Error:
+                    break;
+            }
+        }
+        logInteractive("Goodbye!\n");
+    }
+
+    /// Needs a driver built without a source, like incremental mode.
+    /// Compiles `source` like MainLoop(), but only parses the chunks of it
+    /// `cache` does not have yet, and stores those. Errors in cached chunks
+    /// are reported again. The source must outlive the driver.
+    void CachedMainLoop(std::string_view source, ASTCache& cache) {
+        for (std::string_view chunk : ASTCache::splitChunks(source)) {
+            SourceOffset base = static_cast<SourceOffset>(chunk.data() - source.data());
+            SourceOffset end = base + static_cast<SourceOffset>(chunk.size());
+            uint64_t key = ASTCache::getKey(chunk, operators);
+
+            // Parsing picks up where a stale or damaged entry stops
+            SourceOffset resume = base;
+            if (const std::string* entry = cache.lookup(key, chunk); entry && compileCachedChunk(*entry, base, resume)) {
+                continue;
+            }
+            parseChunk(source.substr(resume, end - resume), resume, resume == base ? &cache : nullptr, key);
+        }
+        logInteractive("Goodbye!\n");
+    }
+
+    /// Incremental mode, for front ends that resubmit the whole source after
+    /// every edit. Only the top-level items the edit touched are compiled.
+    /// A changed definition replaces the previous one in the JIT, and kept
+    /// definitions that call it are recompiled since they were linked
+    /// against the old code.
+    void update(std::string source) {
+        std::vector<IncrementalParser::Item*> changed = incremental.update(std::move(source));
+        // The operators of this version, without those of definitions that
+        // were removed or changed since
+        operators = incremental.getOperators();
+
+        std::unordered_set<Symbol> replaced;
+        for (IncrementalParser::Item* item : changed) {
+            if (item->kind == IncrementalParser::ItemKind::Definition && definitions.count(item->name)) {
+                replaced.insert(item->name);
+            }
+        }
+        std::unordered_set<const IncrementalParser::Item*> recompile(changed.begin(), changed.end());
+        for (bool grew = !replaced.empty(); grew;) {
+            grew = false;
+            for (const IncrementalParser::Item& item : incremental.getItems()) {
+                if (item.kind != IncrementalParser::ItemKind::Definition || recompile.count(&item)) {
+                    continue;
+                }
+                for (Symbol callee : item.callees) {
+                    if (replaced.count(callee)) {
+                        recompile.insert(&item);
+                        replaced.insert(item.name);
+                        grew = true;
+                        break;
+                    }
+                }
+            }
+        }
+
+        for (IncrementalParser::Item& item : incremental.getItems()) {
+            if (!recompile.count(&item)) {
+                continue;
+            }
+            switch (item.kind) {
+                case IncrementalParser::ItemKind::Definition: {
+                    // Codegen hands the prototype to the registry, keep a
+                    // copy in case the definition has to be rebuilt later
+                    auto proto = std::make_unique<FcnPrototype>(*item.fcn->getPrototype());
+                    compileDefinition(*item.fcn, true);
+                    item.fcn->setPrototype(std::move(proto));
+                    break;
+                }
+                case IncrementalParser::ItemKind::Extern:
+                    compileExtern(std::make_unique<FcnPrototype>(*item.proto));
+                    break;
+                case IncrementalParser::ItemKind::Expression:
+                    compileTopLevelExpression(*item.fcn);
+                    break;
+                case IncrementalParser::ItemKind::Error:
+                    break;
+            }
+        }
+    }
+
+    /// The version of the source the last update() got
+    const std::string& getIncrementalSource() const {
+        return incremental.getSource();
+    }
+
 private:
+    // A definition whose body has not been parsed yet
+    struct PendingDefinition {
+        std::unique_ptr<LazyDefinition> definition;
+        std::shared_ptr<const OperatorTable> operators; // Defined before it
+    };
+
+    void initializeJIT() {
+        jit = ExitOnErr(KaleidoscopeJIT::Create());
+
+        // Prime the first token
+        logInteractive("ready> ");
+        lexer.advance();
+    }
+
     void initializeManagers() {
         // Create pass and analysis managers
         fpm = std::make_unique<FunctionPassManager>();
@@ -115,71 +318,309 @@ private:
     }
 
     void HandleDefinition() {
+        if (lazy) {
+            HandleLazyDefinition();
+            return;
+        }
+        beginStats();
         if (auto fcn = parser.parseDefinition()) {
-            if (auto fcnIR = fcn->accept(*visitor)) {
-                dumpIR(fcnIR, "Parsed a function definition.");
-                if (isJIT) {
-                    ExitOnErr(jit->addModule(
-                        ThreadSafeModule(std::move(module), std::move(context))
-                    ));
-                    initilizeModuleAndManagers();
+            endStats(*fcn);
+            compileDefinition(*fcn);
+        } else {
+            parser.synchronize();
+        }
+    }
+
+    void HandleLazyDefinition() {
+        auto definition = parser.parseLazyDefinition();
+        if (!definition) {
+            parser.synchronize();
+            return;
+        }
+
+        // The body is parsed later with the operators defined up to here
+        if (!lazyOperators) {
+            lazyOperators = std::make_shared<const OperatorTable>(operators);
+        }
+        PendingDefinition pending{std::move(definition), lazyOperators};
+
+        // Operators change how everything after them parses, and a
+        // redefinition fails where it is, like in MainLoop()
+        FcnPrototype& proto = *pending.definition->proto;
+        Symbol name = proto.getName();
+        if (proto.isUnaryOp() || proto.isBinaryOp() || definitions.count(name)) {
+            lazyDefinitions.erase(name);
+            materialize(pending);
+            lazyOperators.reset();
+            return;
+        }
+
+        // Calls only need the prototype until the body is compiled
+        PrototypeRegistry::addFcnPrototype(name, std::make_unique<FcnPrototype>(proto));
+        lazyDefinitions[name] = std::move(pending);
+    }
+
+    void materialize(PendingDefinition& pending) {
+        const LazyDefinition& definition = *pending.definition;
+        Lexer bodyLexer(*tokenStream, definition.bodyBegin, definition.bodyEnd);
+        Parser bodyParser(bodyLexer, *pending.operators);
+        bodyLexer.advance();
+        auto fcn = bodyParser.parseLazyBody(*pending.definition);
+        diagnostics.insert(diagnostics.end(), bodyParser.getDiagnostics().begin(), bodyParser.getDiagnostics().end());
+        if (fcn) {
+            compileDefinition(*fcn);
+        }
+    }
+
+    // Before looking for callees, calls in branches that are never taken
+    // go away with them
+    void foldBody(Fcn& fcn) {
+        if (foldConstants) {
+            folder.fold(fcn);
+        }
+    }
+
+    // Compiles the pending lazy definitions `fcn` calls, before `fcn`
+    // itself so they are in the JIT by the time it runs
+    void materializeCallees(Fcn& fcn) {
+        if (lazyDefinitions.empty()) {
+            return;
+        }
+
+        std::vector<Symbol> callees;
+        NodeWalker collectCallees([&callees](ASTNode& node) {
+            if (auto* call = llvm::dyn_cast<CallExpr>(&node)) {
+                callees.push_back(call->getCalleeName());
+            }
+        });
+        fcn.getBody()->accept(collectCallees);
+
+        for (Symbol callee : callees) {
+            auto it = lazyDefinitions.find(callee);
+            if (it == lazyDefinitions.end()) {
+                continue;
+            }
+            // Taken out first, so recursive calls do not materialize it again
+            PendingDefinition pending = std::move(it->second);
+            lazyDefinitions.erase(it);
+            materialize(pending);
+        }
+    }
+
+    // Only update() may `replace` an earlier definition, it recompiles the
+    // callers that were linked against the old code. Anywhere else the
+    // JIT rejects a duplicate definition.
+    void compileDefinition(Fcn& fcn, bool replace = false) {
+        foldBody(fcn);
+        materializeCallees(fcn);
+        Symbol name = fcn.getName();
+        if (auto fcnIR = visitor->visit(fcn)) {
+            dumpIR(fcnIR, "Parsed a function definition.");
+            if (isJIT) {
+                // Track each replaceable definition so it can be removed
+                ResourceTrackerSP rt;
+                if (replace) {
+                    rt = jit->getMainJITDylib().createResourceTracker();
+                    if (auto old = definitions.find(name); old != definitions.end() && old->second) {
+                        ExitOnErr(old->second->remove());
+                    }
                 }
+                definitions[name] = rt;
+
+                ExitOnErr(jit->addModule(
+                    ThreadSafeModule(std::move(module), std::move(context)), rt
+                ));
+                initilizeModuleAndManagers();
             }
-        } else {
-            lexer.advance();
         }
     }
 
     void HandleExtern() {
+        beginStats();
         if (auto fcnProto = parser.parseExtern()) {
-            if (auto fcnIR = fcnProto->accept(*visitor)) {
-                dumpIR(fcnIR, "Parsed an extern");
-                PrototypeRegistry::addFcnPrototype(fcnProto->getName(), std::move(fcnProto));
-            }
+            endStats(*fcnProto);
+            compileExtern(std::move(fcnProto));
         } else {
-          // Skip token for error recovery.
-          lexer.advance();
+            parser.synchronize();
+        }
+    }
+
+    void compileExtern(std::unique_ptr<FcnPrototype> fcnProto) {
+        if (auto fcnIR = visitor->visit(*fcnProto)) {
+            dumpIR(fcnIR, "Parsed an extern");
+            PrototypeRegistry::addFcnPrototype(fcnProto->getName(), std::move(fcnProto));
         }
     }
 
     void HandleTopLevelExpression() {
         // Evaluate a top-level expression into an anonymous function.
+        beginStats();
         if (auto fcnAST = parser.parseTopLevelExpr()) {
-            if (auto fcnIR = fcnAST->accept(*visitor)) {
-                dumpIR(fcnIR, "Parsed a top-level expr");
-
-                // TODO: Actually separate out JIT code
-                if (isJIT) {
-                    // Create a ResourceTracker for JIT memory allocated to the
-                    // anonymous expression so we can free it after execution
-                    auto rt = jit->getMainJITDylib().createResourceTracker();
-                    
-                    auto tsm = ThreadSafeModule(std::move(module), 
-                                                            std::move(context));
-                    ExitOnErr(jit->addModule(std::move(tsm), rt));
-                    
-                    // Module has been added to JIT and can't be modified, open
-                    // a new module for subsequent code
-                    initilizeModuleAndManagers();
-
-                    // Search JIT for anon exprs
-                    auto exprSym = ExitOnErr(jit->lookup("main"));
-                    assert(exprSym.getAddress() && "Function not found");
-                    
-                    // Get the symbol's address and cast it to the correct type
-                    // to call it as a native function
-                    double (*FP)() = exprSym.getAddress().toPtr<double (*)()>();
-                    fprintf(stderr, "Evaluated to %f\n", FP());
-
-                    // Remove the anonymous expression module from the JIT since
-                    // we don't support re-evaluation of top level exprs
-                    ExitOnErr(rt->remove());
-                }
+            endStats(*fcnAST);
+            compileTopLevelExpression(*fcnAST);
+        } else {
+            parser.synchronize();
+        }
+    }
+
+    void compileTopLevelExpression(Fcn& fcnAST) {
+        foldBody(fcnAST);
+        materializeCallees(fcnAST);
+        if (auto fcnIR = visitor->visit(fcnAST)) {
+            dumpIR(fcnIR, "Parsed a top-level expr");
 
+            // TODO: Actually separate out JIT code
+            if (isJIT) {
+                // Create a ResourceTracker for JIT memory allocated to the
+                // anonymous expression so we can free it after execution
+                auto rt = jit->getMainJITDylib().createResourceTracker();
+                
+                auto tsm = ThreadSafeModule(std::move(module), 
+                                                        std::move(context));
+                ExitOnErr(jit->addModule(std::move(tsm), rt));
+                
+                // Module has been added to JIT and can't be modified, open
+                // a new module for subsequent code
+                initilizeModuleAndManagers();
+
+                // Search JIT for anon exprs
+                auto exprSym = ExitOnErr(jit->lookup("main"));
+                assert(exprSym.getAddress() && "Function not found");
+                
+                // Get the symbol's address and cast it to the correct type
+                // to call it as a native function
+                double (*FP)() = exprSym.getAddress().toPtr<double (*)()>();
+                fprintf(stderr, "Evaluated to %f\n", FP());
+
+                // Remove the anonymous expression module from the JIT since
+                // we don't support re-evaluation of top level exprs
+                ExitOnErr(rt->remove());
             }
-        } else {
-            // Skip token for error recovery.
-            lexer.advance();
+        }
+    }
+
+    // Returns true if the whole chunk came from `entry`. Otherwise `resume`
+    // is set to the end of the last item compiled from it. An item that
+    // left different operators behind than when it was cached, e.g.
+    // because codegen of an operator definition failed differently, makes
+    // everything after it parse differently too.
+    bool compileCachedChunk(const std::string& entry, SourceOffset base, SourceOffset& resume) {
+        CacheEntryReader reader(entry, base);
+        std::vector<Diagnostic> cached;
+        if (!reader.readDiagnostics(cached)) {
+            return false;
+        }
+
+        bool complete = false;
+        CacheEntryReader::Item item;
+        while (true) {
+            if (reader.atEnd()) {
+                complete = true;
+                break;
+            }
+            if (!reader.readItem(item)) {
+                break;
+            }
+            compileItem(item.kind, std::move(item.fcn), std::move(item.proto));
+            resume = item.end;
+
+            uint64_t fingerprint;
+            if (!reader.readOperators(fingerprint) || fingerprint != operators.getFingerprint()) {
+                break;
+            }
+        }
+
+        // Errors past `resume` are reported by the parse from there
+        for (Diagnostic& diag : cached) {
+            if (complete || diag.loc <= resume) {
+                diagnostics.push_back(std::move(diag));
+            }
+        }
+        return complete;
+    }
+
+    // Same dispatch as MainLoop. Stores the chunk under `key` unless
+    // `cache` is null.
+    void parseChunk(std::string_view text, SourceOffset begin, ASTCache* cache, uint64_t key) {
+        Lexer chunkLexer(text, begin);
+        Parser chunkParser(chunkLexer, operators);
+        chunkLexer.advance();
+        CacheEntryWriter writer(begin);
+
+        while (true) {
+            while (chunkLexer.getCurrentToken() == tok_semicolon) {
+                chunkLexer.advance();
+            }
+            if (chunkLexer.getCurrentToken() == tok_eof) {
+                break;
+            }
+
+            CachedItemKind kind;
+            std::unique_ptr<Fcn> fcn;
+            std::unique_ptr<FcnPrototype> proto;
+            switch (chunkLexer.getCurrentToken()) {
+                case tok_def:
+                    kind = CachedItemKind::Definition;
+                    fcn = chunkParser.parseDefinition();
+                    break;
+                case tok_extern:
+                    kind = CachedItemKind::Extern;
+                    proto = chunkParser.parseExtern();
+                    break;
+                default:
+                    kind = CachedItemKind::Expression;
+                    fcn = chunkParser.parseTopLevelExpr();
+                    break;
+            }
+            if (!fcn && !proto) {
+                kind = CachedItemKind::Error;
+                chunkParser.synchronize();
+            }
+
+            // Before codegen takes the prototype
+            if (cache) {
+                writer.addItem(kind, chunkLexer.getCurrentOffset(), fcn.get(), proto.get());
+            }
+            compileItem(kind, std::move(fcn), std::move(proto));
+            if (cache) {
+                writer.addOperators(operators);
+            }
+        }
+
+        std::vector<Diagnostic> chunkDiagnostics = chunkLexer.getDiagnostics();
+        chunkDiagnostics.insert(chunkDiagnostics.end(), chunkParser.getDiagnostics().begin(),
+                                chunkParser.getDiagnostics().end());
+        diagnostics.insert(diagnostics.end(), chunkDiagnostics.begin(), chunkDiagnostics.end());
+        if (cache) {
+            cache->store(key, text, writer.finish(chunkDiagnostics));
+        }
+    }
+
+    void reportDiagnostics() {
+        if (!diagnosticHandler) {
+            return;
+        }
+        for (const Diagnostic& diag : getDiagnostics()) {
+            diagnosticHandler(diag);
+        }
+        lexer.clearDiagnostics();
+        parser.clearDiagnostics();
+        diagnostics.clear();
+    }
+
+    void compileItem(CachedItemKind kind, std::unique_ptr<Fcn> fcn, std::unique_ptr<FcnPrototype> proto) {
+        switch (kind) {
+            case CachedItemKind::Definition:
+                compileDefinition(*fcn);
+                break;
+            case CachedItemKind::Extern:
+                compileExtern(std::move(proto));
+                break;
+            case CachedItemKind::Expression:
+                compileTopLevelExpression(*fcn);
+                break;
+            case CachedItemKind::Error:
+                break;
         }
     }
 
@@ -192,6 +633,19 @@ private:
         va_end(args);
     }
 
+    void beginStats() {
+        if (stats) {
+            stats->beginItem();
+        }
+    }
+
+    template<typename Item>
+    void endStats(Item& item) {
+        if (stats) {
+            stats->endItem(item);
+        }
+    }
+
     void dumpIR(Value* IR, const char* parseMsg) {
         if (interactive) {
             fprintf(stderr, "%s\n", parseMsg);
@@ -200,12 +654,31 @@ private:
         }
     }
 
+    // Binary and unary operators defined so far in this session
+    OperatorTable operators;
     Parser parser;
     Lexer lexer;
     ExitOnError ExitOnErr;
     std::string ModuleName;
     bool interactive;
     bool isJIT;
+    const TokenStream* tokenStream = nullptr; // Set in token stream mode
+    std::vector<Diagnostic> diagnostics; // From parsers other than `parser`
+    std::function<void(const Diagnostic&)> diagnosticHandler;
+
+    ASTStats* stats = nullptr;
+    bool foldConstants = true;
+    // Looking a function up declares it in the current module, harmless
+    // even when the branch calling it is dropped
+    ExprFolder folder{[this](Symbol callee, size_t numArgs) {
+        llvm::Function* function = PrototypeRegistry::getFunction(callee, *visitor);
+        return function && function->arg_size() == numArgs;
+    }};
+
+    bool lazy = false;
+    std::unordered_map<Symbol, PendingDefinition> lazyDefinitions;
+    // Shared by the pending definitions since the last operator definition
+    std::shared_ptr<const OperatorTable> lazyOperators;
 
     std::unique_ptr<CodegenVisitor> visitor;
     std::unique_ptr<LLVMContext> context;
@@ -221,5 +694,8 @@ private:
     std::unique_ptr<StandardInstrumentations> si;
 
     std::unique_ptr<KaleidoscopeJIT> jit;
+    // Compiled definitions, with a tracker for those update() may replace
+    std::unordered_map<Symbol, ResourceTrackerSP> definitions;
+    IncrementalParser incremental{operators};
     std::unordered_map<std::string, FcnPrototype*> functionProtos;
 };
\ No newline at end of file
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "AST/Fcn.hpp"
+#include "AST/OperatorTable.hpp"
+#include "AST/Symbol.hpp"
+#include "debug/SourceLocation.hpp"
+#include "Diagnostic.hpp"
+
+namespace lang {
+
+// Parses a source that gets resubmitted in full after every edit, e.g. by
+// a notebook or editor, and only re-lexes and re-parses the top-level
+// items the edit touched. Items whose text, and the token after them that
+// ended them, lie before the edit are kept as they are. Parsing restarts
+// at the first touched item and stops as soon as it reaches the start of
+// an old item past the edit, from where the old items are kept with their
+// offsets shifted.
+//
+// Operator definitions change how everything after them parses. Every item
+// remembers the operators it was parsed with, built up from the items
+// before it the way codegen registers them, and an old item is only kept
+// past the edit if the operators defined before it are still the same.
+class IncrementalParser {
+public:
+    enum class ItemKind {
+        Definition,
+        Extern,
+        Expression,
+        Error, // Failed to parse, skipped to the next ';', def or extern like the Driver does
+    };
+
+    struct Item {
+        ItemKind kind = ItemKind::Error;
+        SourceOffset begin = 0; // First token
+        SourceOffset end = 0; // First token after the item
+        SourceOffset readEnd = 0; // One past the last character lexed to find `end`
+        Symbol name; // Definition or Extern
+        std::vector<Symbol> callees; // Definition, every function its body calls
+        bool definesOperator = false; // Registers an operator for the items after it
+        // What the item was parsed with, shared until the next item that
+        // defines an operator
+        std::shared_ptr<const OperatorTable> operators;
+        std::unique_ptr<Fcn> fcn; // Definition or Expression
+        std::unique_ptr<FcnPrototype> proto; // Extern
+        // Lexer and parser errors in [begin, end), kept and dropped with
+        // the item
+        std::vector<Diagnostic> diagnostics;
+    };
+
+    // `operators` is what the first item is parsed with
+    explicit IncrementalParser(const OperatorTable& operators = OperatorTable::builtins())
+        : initialOperators(std::make_shared<const OperatorTable>(operators)), operators(operators) {}
+
+    // Replaces the source, returns the items that were re-parsed in source
+    // order. These are the only ones that need codegen. The pointers are
+    // valid until the next call.
+    std::vector<Item*> update(std::string newSource);
+
+    const std::vector<Item>& getItems() const {
+        return items;
+    }
+
+    std::vector<Item>& getItems() {
+        return items;
+    }
+
+    const std::string& getSource() const {
+        return source;
+    }
+
+    // The operators after the last item, which has none from removed
+    // operator definitions
+    const OperatorTable& getOperators() const {
+        return operators;
+    }
+
+    // Errors of every item, in source order
+    std::vector<Diagnostic> getDiagnostics() const;
+
+private:
+    std::shared_ptr<const OperatorTable> initialOperators;
+    OperatorTable operators;
+    std::string source;
+    std::vector<Item> items;
+};
+
+} // namespace lang
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <array>
+#include <initializer_list>
+#include <string_view>
+
+#include "Token.hpp"
+
+namespace lang {
+
+struct Keyword {
+    std::string_view spelling;
+    Token token;
+};
+
+// The one keyword list, anything that needs to know the reserved
+// words (lexer, tooling, generators) should read it from here
+inline constexpr std::array<Keyword, 10> KEYWORDS = {{
+    {"def", tok_def},
+    {"extern", tok_extern},
+    {"if", tok_if},
+    {"then", tok_then},
+    {"else", tok_else},
+    {"for", tok_for},
+    {"in", tok_in},
+    {"binary", tok_binary},
+    {"unary", tok_unary},
+    {"var", tok_var},
+}};
+
+namespace detail {
+
+constexpr size_t KEYWORD_TABLE_SIZE = 16;
+
+consteval size_t maxKeywordLength() {
+    size_t len = 0;
+    for (const auto& kw : KEYWORDS) {
+        len = kw.spelling.size() > len ? kw.spelling.size() : len;
+    }
+    return len;
+}
+
+constexpr size_t MAX_KEYWORD_LENGTH = maxKeywordLength();
+
+// Only looks at the length and the first and last characters, which
+// is enough to tell the keywords apart once a good seed is found
+constexpr size_t keywordHash(std::string_view word, unsigned seed) {
+    unsigned h = static_cast<unsigned>(word.size()) * seed;
+    h += static_cast<unsigned char>(word.front()) * 31u;
+    h ^= static_cast<unsigned char>(word.back()) * seed;
+    return (h ^ (h >> 4)) & (KEYWORD_TABLE_SIZE - 1);
+}
+
+// Searches for a seed that maps every keyword to its own slot
+consteval unsigned findKeywordSeed() {
+    for (unsigned seed = 1; seed < 100000; ++seed) {
+        bool used[KEYWORD_TABLE_SIZE] = {};
+        bool perfect = true;
+        for (const auto& kw : KEYWORDS) {
+            size_t slot = keywordHash(kw.spelling, seed);
+            if (used[slot]) {
+                perfect = false;
+                break;
+            }
+            used[slot] = true;
+        }
+        if (perfect) {
+            return seed;
+        }
+    }
+    return 0;
+}
+
+constexpr unsigned KEYWORD_SEED = findKeywordSeed();
+static_assert(KEYWORD_SEED != 0, "No perfect hash seed for the keyword table");
+
+consteval std::array<Keyword, KEYWORD_TABLE_SIZE> buildKeywordTable() {
+    std::array<Keyword, KEYWORD_TABLE_SIZE> table{};
+    for (auto& slot : table) {
+        slot = {"", tok_identifier};
+    }
+    for (const auto& kw : KEYWORDS) {
+        table[keywordHash(kw.spelling, KEYWORD_SEED)] = kw;
+    }
+    return table;
+}
+
+constexpr std::array<Keyword, KEYWORD_TABLE_SIZE> KEYWORD_TABLE = buildKeywordTable();
+
+} // namespace detail
+
+// Classifies a word as a keyword token, or tok_identifier. Costs one
+// hash and at most one string comparison regardless of the word.
+constexpr Token lookupKeyword(std::string_view word) {
+    if (word.empty() || word.size() > detail::MAX_KEYWORD_LENGTH) {
+        return tok_identifier;
+    }
+    const Keyword& kw = detail::KEYWORD_TABLE[detail::keywordHash(word, detail::KEYWORD_SEED)];
+    return kw.spelling == word ? kw.token : tok_identifier;
+}
+
+// Whether `text` starts with def or extern as a whole word. Neither occurs
+// inside an expression, so a line starting with one starts a new item.
+constexpr bool startsTopLevelItem(std::string_view text) {
+    for (std::string_view keyword : {"def", "extern"}) {
+        if (!text.starts_with(keyword)) {
+            continue;
+        }
+        if (text.size() == keyword.size()) {
+            return true;
+        }
+        char next = text[keyword.size()];
+        bool isAlnum = (next >= '0' && next <= '9') || (next >= 'A' && next <= 'Z') || (next >= 'a' && next <= 'z');
+        return !isAlnum;
+    }
+    return false;
+}
+
+} // namespace lang
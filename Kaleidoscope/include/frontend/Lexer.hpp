@@ -1,39 +1,24 @@
 #pragma once
 
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
 #include <iostream>
 #include <string>
+#include <string_view>
+#include <vector>
 
+#include "AST/Symbol.hpp"
 #include "debug/SourceLocation.hpp"
+#include "Diagnostic.hpp"
+#include "Keywords.hpp"
+#include "NumberLiteral.hpp"
+#include "Scanner.hpp"
+#include "StreamSource.hpp"
+#include "Token.hpp"
+#include "TokenStream.hpp"
 
-// Return token [0-255] for unknown chars, otherwise a known token
 namespace lang {
-enum Token : int {
-    tok_open_paren = '(',
-    tok_close_paren = ')',
-    tok_comma = ',',
-    tok_semicolon = ';',
-
-    tok_eof = -1,
-
-    tok_def = -2,
-    tok_extern = -3,
-
-    tok_identifier = -4,
-    tok_number = -5,
-
-    tok_if = -6,
-    tok_then = -7,
-    tok_else = -8,
-
-    tok_for = -9,
-    tok_in = -10,
-
-    tok_binary = -11,
-    tok_unary = -12,
-
-    tok_var = -13,
-};
 
 static bool isnum(char c) {
     return isdigit(c) || c == '.';
@@ -45,17 +30,57 @@ static bool iseol(char c) {
 
 class Lexer {
 public:
-    Lexer(std::istream& input = std::cin) : fInput(input) {}
+    // Stream backend, reads one character at a time. Only meant for
+    // interactive input where the source isn't known up front.
+    Lexer(std::istream& input = std::cin) : fInput(&input) {}
+
+    // Buffer backend, walks a contiguous source (e.g. a memory mapped file)
+    // with a raw pointer. The source must outlive the lexer. `baseOffset`
+    // is added to every offset, for lexing a tail of a larger source.
+    Lexer(std::string_view source, SourceOffset baseOffset = 0)
+        : fChunk(source.data()), fCur(source.data()), fEnd(source.data() + source.size()),
+            fChunkOffset(baseOffset) {}
+
+    // Streaming backend, runs the buffer backend over one chunk of `source`
+    // at a time. Identifiers stay valid until the chunks are released with
+    // releaseConsumedInput(). The source must outlive the lexer.
+    Lexer(StreamSource& source) : fSource(&source) {}
+
+    // Replay backend, hands out tokens that were lexed up front. Only this
+    // backend supports peek(), mark() and rewind(). The token stream must
+    // outlive the lexer.
+    Lexer(const TokenStream& tokens) : fTokens(&tokens), fTokenEnd(tokens.size() - 1) {}
+
+    // Replays tokens [begin, end) of `tokens`, then tok_eof at the offset
+    // of token `end`
+    Lexer(const TokenStream& tokens, size_t begin, size_t end)
+        : fTokens(&tokens), fTokenBegin(begin), fNextToken(begin), fTokenEnd(end) {
+        assert(begin <= end && end < tokens.size());
+    }
 
     Token getCurrentToken() const {
         return fCurTok;
     }
 
-    const SourceLocation& getCurrentLoc() const {
-        return fCurLoc;
+    // Byte offset of the current token from the start of the source,
+    // a SourceManager turns it into a line and column
+    SourceOffset getCurrentOffset() const {
+        return fCurOffset;
+    }
+
+    // One past the last character read to lex the current token, which
+    // includes the character after it that ended the token. Hitting the
+    // end of the input counts as reading one past it. Not for the replay
+    // backend.
+    SourceOffset getReadOffset() const {
+        assert(!fTokens && "Lexer::getReadOffset needs a character backend");
+        return getLexOffset() + (fLastChar == EOF ? 1 : 0);
     }
 
     Token advance() {
+        if (fTokens) {
+            return fCurTok = replay();
+        }
         return fCurTok = getTok();
     }
 
@@ -64,9 +89,15 @@ public:
         advance(); // Advance to the next token
     }
 
-    // Get the identifier string if tok_identifier
-    const std::string &getIdentifierStr() const {
-        return fIdentiferStr;
+    // Get the identifier string if tok_identifier. Only valid until
+    // the next call to advance()
+    std::string_view getIdentifierStr() const {
+        return fIdentifier;
+    }
+
+    // Get the interned identifier if tok_identifier
+    Symbol getIdentifier() const {
+        return fSymbol;
     }
 
     // Get the number value if tok_number
@@ -74,69 +105,177 @@ public:
         return fNumVal;
     }
 
+    // Problems found so far, one per tok_error returned
+    const std::vector<Diagnostic>& getDiagnostics() const {
+        return fTokens ? fTokens->getDiagnostics() : fDiagnostics;
+    }
+
+    // Once they are reported, so a long stream does not keep them all.
+    // Token stream mode keeps its diagnostics in the TokenStream.
+    void clearDiagnostics() {
+        fDiagnostics.clear();
+    }
+
+    // Streaming backend only, a no-op otherwise. Lets the source recycle
+    // every chunk before the one being lexed. Call once the parser is done
+    // with everything lexed so far, e.g. after each top-level item.
+    void releaseConsumedInput() {
+        if (fSource) {
+            fSource->releaseConsumed();
+        }
+    }
+
+    // Replay backend only. Kind of the token `n` positions past the
+    // current one, without advancing
+    Token peek(size_t n = 1) const {
+        assert(fTokens && "Lexer::peek needs a TokenStream");
+        size_t i = fNextToken + n - 1;
+        return i >= fTokenEnd ? tok_eof : fTokens->getKind(i);
+    }
+
+    // Replay backend only. Position that rewind() can later return to
+    size_t mark() const {
+        assert(fTokens && "Lexer::mark needs a TokenStream");
+        return fNextToken;
+    }
+
+    // Replay backend only. Restores the current token saved by mark()
+    void rewind(size_t position) {
+        assert(fTokens && "Lexer::rewind needs a TokenStream");
+        if (position == fTokenBegin) {
+            fNextToken = fTokenBegin;
+            fCurTok = tok_eof; // Nothing has been read yet
+            return;
+        }
+        fNextToken = position - 1;
+        advance();
+    }
+
 private:
     Token fCurTok = tok_eof;
-    std::string fIdentiferStr; // Filled in if tok_identifier
-    std::istream& fInput; // Input stream, default is std::cin
+    std::string_view fIdentifier; // Filled in if tok_identifier
+    Symbol fSymbol; // Filled in if tok_identifier
+    std::string fIdentiferStr; // Backing storage for the stream backend
+    std::istream* fInput = nullptr; // Null when lexing from a buffer
+    const char* fChunk = nullptr; // The whole buffer, or the current streamed chunk
+    const char* fCur = nullptr;
+    const char* fEnd = nullptr;
+    SourceOffset fChunkOffset = 0; // Offset of fChunk in the source
+    StreamSource* fSource = nullptr; // Set for the streaming backend
     Token fLastChar = Token(' ');
     double fNumVal; // Filled in if tok_number
-
-    SourceLocation fCurLoc;
-    SourceLocation fLexLoc = {1, 0};
+    std::vector<Diagnostic> fDiagnostics;
+    const TokenStream* fTokens = nullptr; // Set for the replay backend
+    size_t fTokenBegin = 0;
+    size_t fNextToken = 0;
+    size_t fTokenEnd = 0; // Replayed as tok_eof
+
+    SourceOffset fCurOffset = 0;
+    SourceOffset fLexOffset = 0; // Characters read so far by the stream backend
+
+    Token replay() {
+        size_t i = std::min(fNextToken, fTokenEnd);
+        fNextToken = i + 1;
+
+        fCurOffset = fTokens->getOffset(i);
+        if (i == fTokenEnd) {
+            return tok_eof;
+        }
+        Token tok = fTokens->getKind(i);
+        if (tok == tok_identifier) {
+            fSymbol = fTokens->getSymbol(i);
+            fIdentifier = fSymbol.str();
+        } else if (tok == tok_number) {
+            fNumVal = fTokens->getNumVal(i);
+        }
+        return tok;
+    }
 
     int getNextChar() {
-        return fInput.get();
+        if (!fInput) {
+            if (fCur == fEnd && fSource) {
+                // Chunks end on a line break, so no token is cut in two
+                std::string_view chunk = fSource->nextChunk();
+                fChunkOffset += fEnd - fChunk;
+                fChunk = fCur = chunk.data();
+                fEnd = chunk.data() + chunk.size();
+            }
+            return fCur != fEnd ? static_cast<unsigned char>(*fCur++) : EOF;
+        }
+
+        int c = fInput->get();
+        if (c != EOF) {
+            fLexOffset++;
+        }
+        return c;
     }
 
     Token next() {
-        int lastChar = getNextChar();
+        return Token(getNextChar());
+    }
 
-        if (lastChar == '\n' || lastChar == '\r') {
-            fLexLoc.Line++;
-            fLexLoc.Col = 0;
-        } else {
-            fLexLoc.Col++;
-        }
-        return Token(lastChar);
+    // Offset of the next character getNextChar() will return
+    SourceOffset getLexOffset() const {
+        return fInput ? fLexOffset : fChunkOffset + static_cast<SourceOffset>(fCur - fChunk);
+    }
+
+    // Buffer backend only. Moves to `target` as if next() had been called
+    // for every character in between, then reads the character at `target`.
+    void skipTo(const char* target) {
+        fCur = target;
+        fLastChar = next();
     }
 
     Token getTok() {
         // Skip whitespace
-        while (isspace(fLastChar)) {
-            fLastChar = next();
+        if (!fInput) {
+            // Loops only when whitespace runs into the next streamed chunk
+            while (isspace(fLastChar)) {
+                skipTo(scan::skipWhitespace(fCur, fEnd));
+            }
+        } else {
+            while (isspace(fLastChar)) {
+                fLastChar = next();
+            }
         }
 
-        fCurLoc = fLexLoc;
+        // fLastChar has already been read, unless it is EOF
+        fCurOffset = fLastChar == EOF ? getLexOffset() : getLexOffset() - 1;
 
         if (std::isalpha(fLastChar)) {
-            fIdentiferStr = (char)fLastChar;
-            while (std::isalnum((fLastChar = next()))) {
-                fIdentiferStr += (char)fLastChar;
+            if (!fInput) {
+                // Slice the identifier straight out of the buffer
+                const char* start = fCur - 1;
+                const char* end = scan::skipIdentifier(fCur, fEnd);
+                skipTo(end);
+                fIdentifier = std::string_view(start, end - start);
+            } else {
+                fIdentiferStr = (char)fLastChar;
+                while (std::isalnum((fLastChar = next()))) {
+                    fIdentiferStr += (char)fLastChar;
+                }
+                fIdentifier = fIdentiferStr;
             }
-            return getTokFromWord(fIdentiferStr);
+            Token tok = getTokFromWord(fIdentifier);
+            if (tok == tok_identifier) {
+                fSymbol = SymbolTable::get()->intern(fIdentifier);
+            }
+            return tok;
         }
 
-        // Match [0-9.]+ , needs to be improved to handle more cases
         if (isnum(fLastChar)) {
-            std::string NumStr;
-            int decimal = 0;
-            do {
-                NumStr += fLastChar;
-                fLastChar = next();
-                if (fLastChar == '.') {
-                    decimal++;
-                    assert(decimal < 2 && "Cannot handle multiple decimals in a number");
-                }
-            } while (isnum(fLastChar));
-            fNumVal = strtod(NumStr.c_str(), nullptr);
-            return tok_number;
+            return lexNumber();
         }
 
         if (fLastChar == '#') {
             // Comment until end of line
-            do {
-                fLastChar = next();
-            } while (!iseol(fLastChar));
+            if (!fInput) {
+                skipTo(scan::findEndOfLine(fCur, fEnd));
+            } else {
+                do {
+                    fLastChar = next();
+                } while (!iseol(fLastChar));
+            }
 
             if (fLastChar != EOF) {
                 return getTok(); // Recurse to get next token
@@ -152,38 +291,48 @@ private:
         return ThisChar;
     }
 
-    Token getTokFromWord(const std::string &word) {
-        if (word == "def") {
-            return tok_def;
-        }
-        if (word == "extern") {
-            return tok_extern;
-        }
-        if (word == "if") {
-            return tok_if;
-        }
-        if (word == "then") {
-            return tok_then;
-        }
-        if (word == "else") {
-            return tok_else;
-        }
-        if (word == "for") {
-            return tok_for;
-        }
-        if (word == "in") {
-            return tok_in;
-        }
-        if (word == "binary") {
-            return tok_binary;
-        }
-        if (word == "unary") {
-            return tok_unary;
+    // Gathers the whole literal, then parses it in place. The buffer
+    // backend parses straight out of the source, the stream backend
+    // copies into a stack buffer, neither allocates.
+    Token lexNumber() {
+        char scratch[MAX_NUMBER_LENGTH];
+        std::string_view text;
+        bool tooLong = false;
+
+        NumberScanner scanner(fLastChar);
+        if (!fInput) {
+            const char* start = fCur - 1;
+            const char* end = fCur;
+            while (end != fEnd && scanner.accept(static_cast<unsigned char>(*end))) {
+                ++end;
+            }
+            skipTo(end);
+            text = std::string_view(start, end - start);
+        } else {
+            size_t length = 0;
+            do {
+                if (length < MAX_NUMBER_LENGTH) {
+                    scratch[length++] = static_cast<char>(fLastChar);
+                } else {
+                    tooLong = true;
+                }
+                fLastChar = next();
+            } while (scanner.accept(fLastChar));
+            text = std::string_view(scratch, length);
         }
-        if (word == "var") {
-            return tok_var;
+
+        const char* error = tooLong ? "numeric literal is too long"
+                                    : parseNumberLiteral(text, fNumVal);
+        if (error) {
+            fNumVal = 0;
+            fDiagnostics.push_back({fCurOffset, std::string(error) + " '" + std::string(text) + "'"});
+            return tok_error;
         }
-        return tok_identifier;
+        return tok_number;
+    }
+
+    Token getTokFromWord(std::string_view word) {
+        return lookupKeyword(word);
     }
 };
 
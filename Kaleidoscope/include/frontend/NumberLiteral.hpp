@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cctype>
+#include <cstddef>
+#include <string_view>
+
+namespace lang {
+
+// Longest literal accepted, lets literals be parsed out of a stack buffer
+constexpr size_t MAX_NUMBER_LENGTH = 256;
+
+// Decides which characters belong to a numeric literal. Literals are
+// scanned greedily, like C pp-numbers, and validated afterwards so that
+// e.g. "1.2.3" or "12ab" become one malformed literal instead of a run
+// of unrelated tokens. A sign only continues a literal right after an
+// exponent marker ('e' for decimal, 'p' for hex).
+class NumberScanner {
+public:
+    explicit NumberScanner(int first) : prev(first) {}
+
+    bool accept(int c) {
+        bool isSign = c == '+' || c == '-';
+        if (!std::isalnum(c) && c != '.' && c != '_' && !(isSign && afterExponentMarker())) {
+            return false;
+        }
+        if (length == 1 && prev == '0' && (c == 'x' || c == 'X')) {
+            hex = true;
+        }
+        prev = c;
+        ++length;
+        return true;
+    }
+
+private:
+    bool afterExponentMarker() const {
+        return hex ? (prev == 'p' || prev == 'P') : (prev == 'e' || prev == 'E');
+    }
+
+    int prev;
+    size_t length = 1;
+    bool hex = false;
+};
+
+// Parses a scanned literal without allocating. Supports
+//     decimal:    12  0.5  .5  5.  1e-9  2.5E+3
+//     hex:        0xFF  0x1.8p3  0x.8p-1 (a '.' requires the 'p' exponent)
+//     separators: 1_000_000  0xFF_FF  1e1_0 (only between two digits)
+// Returns nullptr on success, otherwise a description of the problem.
+const char* parseNumberLiteral(std::string_view text, double& value);
+
+} // namespace lang
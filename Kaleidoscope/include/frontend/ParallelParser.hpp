@@ -0,0 +1,76 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "AST/Fcn.hpp"
+#include "AST/OperatorTable.hpp"
+#include "debug/SourceLocation.hpp"
+#include "Diagnostic.hpp"
+#include "TokenStream.hpp"
+
+namespace lang {
+
+// Parses a pre-lexed source on several threads, for front ends that want
+// every AST before codegen starts.
+//
+// The keywords def and extern never occur inside an expression, so a scan
+// over the token kinds splits the source into independent segments, each
+// starting at one of them. Segments are parsed concurrently and their items
+// come back in source order.
+//
+// The same scan records every `def binary` prototype. A segment is parsed
+// with the operators defined before it, like the Driver sees them after
+// compiling the earlier items. Unlike the Driver, a definition whose body
+// fails to parse or compile still defines its operator.
+class ParallelParser {
+public:
+    enum class ItemKind {
+        Definition,
+        Extern,
+        Expression,
+        Error, // Failed to parse, skipped to the next item like the Driver does
+    };
+
+    struct Item {
+        ItemKind kind = ItemKind::Error;
+        SourceOffset begin = 0; // First token
+        std::unique_ptr<Fcn> fcn; // Definition or Expression
+        std::unique_ptr<FcnPrototype> proto; // Extern
+    };
+
+    // Both must outlive the parser. `operators` are the ones defined before
+    // the first token.
+    ParallelParser(const TokenStream& tokens, const OperatorTable& operators);
+
+    // Every item in source order, parsed on up to `jobs` threads
+    std::vector<Item> parse(unsigned jobs);
+
+    // Errors of the last parse(), in source order
+    const std::vector<Diagnostic>& getDiagnostics() const {
+        return diagnostics;
+    }
+
+    size_t getNumSegments() const {
+        return segments.size();
+    }
+
+private:
+    struct Segment {
+        size_t begin; // Token indices
+        size_t end;
+        size_t operators; // Index into `tables`
+        bool definesOperator; // Starts with a `def binary`
+    };
+
+    void parseSegment(const Segment& segment, std::vector<Item>& items, 
+                      std::vector<Diagnostic>& taskDiagnostics) const;
+
+    const TokenStream& tokens;
+    std::vector<Segment> segments;
+    // One table per operator definition, each adding it to the previous
+    std::vector<OperatorTable> tables;
+    std::vector<Diagnostic> diagnostics;
+};
+
+} // namespace lang
@@ -1,15 +1,37 @@
 #pragma once
 
+#include "AST/ASTArena.hpp"
 #include "AST/Expr.hpp"
+#include "AST/ExprInterner.hpp"
 #include "AST/Fcn.hpp"
-#include "AST/Precedence.hpp"
+#include "AST/OperatorTable.hpp"
 #include "Lexer.hpp"
 
 namespace lang {
 
+/// A definition whose body has been skipped, see Parser::parseLazyDefinition()
+struct LazyDefinition {
+    std::unique_ptr<FcnPrototype> proto;
+    size_t bodyBegin; // Token indices into the replayed TokenStream
+    size_t bodyEnd;
+};
+
 class Parser {
 public:
-    Parser(Lexer& lexer) : fLexer(lexer) {}
+    Parser(Lexer& lexer, const OperatorTable& operators = OperatorTable::builtins())
+        : fLexer(lexer), fOperators(operators) {}
+
+    /// Shares structurally identical side-effect-free subtrees within each
+    /// item from now on, see ExprInterner. Off by default, the items become
+    /// DAGs that anything rewriting nodes in place has to be ready for.
+    void setHashConsing(bool enable) {
+        fInterner = enable ? std::make_unique<ExprInterner>() : nullptr;
+    }
+
+    /// Null unless hash-consing is on
+    const ExprInterner* getInterner() const {
+        return fInterner.get();
+    }
 
     /// Parses a function definition, which is of the form:
     ///     def <prototype> <expression>
@@ -22,10 +44,50 @@ public:
         if (!proto) {
             return nullptr; // Error in prototype parsing
         }
+        return parseBody(std::move(proto));
+    }
 
+    /// Replay backend only. Parses the prototype of a function definition
+    /// and skips its body, recording where it is. No expression can contain
+    /// ';', def or extern, so the body ends before the first of them.
+    std::unique_ptr<LazyDefinition> parseLazyDefinition() {
+        if (fLexer.getCurrentToken() != tok_def) {
+            return logErrorAndReturnNull<LazyDefinition>("Expected 'def' keyword for function definition");
+        }
+        fLexer.consume(tok_def);
+        auto proto = parsePrototype();
+        if (!proto) {
+            return nullptr; // Error in prototype parsing
+        }
+
+        // mark() is the index of the token after the current one
+        size_t bodyBegin = fLexer.mark() - 1;
+        synchronize();
+        if (fLexer.mark() - 1 == bodyBegin) {
+            return logErrorAndReturnNull<LazyDefinition>("Expected expression in function definition");
+        }
+        return std::make_unique<LazyDefinition>(LazyDefinition{std::move(proto), bodyBegin, fLexer.mark() - 1});
+    }
+
+    /// Parses the body skipped by parseLazyDefinition(), the lexer has to
+    /// replay exactly tokens [bodyBegin, bodyEnd). A body that stops short
+    /// of them is an error, a def without a trailing ';' has to be parsed
+    /// eagerly to tell where it ends.
+    std::unique_ptr<Fcn> parseLazyBody(LazyDefinition& definition) {
+        auto fcn = parseBody(std::move(definition.proto));
+        if (fcn && fLexer.getCurrentToken() != tok_eof) {
+            return logErrorAndReturnNull<Fcn>("Expected ';' after lazily parsed function body");
+        }
+        return fcn;
+    }
+
+    /// Parses the <expression> of a definition with the given prototype
+    std::unique_ptr<Fcn> parseBody(std::unique_ptr<FcnPrototype> proto) {
+        startItem();
         if (auto expr = parseExpression()) {
-            return std::make_unique<Fcn>(std::move(proto), std::move(expr));
+            return std::make_unique<Fcn>(std::move(proto), std::move(expr), std::move(fArena));
         } else {
+            fArena.reset(); // Frees the nodes of the partial body
             return logErrorAndReturnNull<Fcn>("Expected expression in function definition");
         }   
     }
@@ -43,43 +105,106 @@ public:
     /// Parses a top-level expression, which is of the form:
     ///     <expression>
     std::unique_ptr<Fcn> parseTopLevelExpr() {
-        SourceLocation fnLoc = fLexer.getCurrentLoc();
+        SourceOffset fnLoc = fLexer.getCurrentOffset();
+        startItem();
         if (auto expr = parseExpression()) {
-            auto proto = std::make_unique<FcnPrototype>("main", std::vector<std::string>());
+            auto proto = std::make_unique<FcnPrototype>("main", std::vector<Symbol>());
             proto->setSourceLoc(fnLoc);
-            return std::make_unique<Fcn>(std::move(proto), std::move(expr));
+            return std::make_unique<Fcn>(std::move(proto), std::move(expr), std::move(fArena));
         }
+        fArena.reset(); // Frees the nodes of the partial expression
         return nullptr;
     }
 
+    /// Panic-mode recovery after an item failed to parse: skips to the next
+    /// ';', def or extern. None of them can occur inside an item, so the
+    /// rest of a broken item is skipped in one go instead of being parsed
+    /// as a string of further broken items.
+    void synchronize() {
+        while (fLexer.getCurrentToken() != tok_semicolon && fLexer.getCurrentToken() != tok_def 
+                && fLexer.getCurrentToken() != tok_extern && fLexer.getCurrentToken() != tok_eof) {
+            fLexer.advance();
+        }
+    }
+
+    /// Errors found so far, one per item that failed to parse. The lexer
+    /// keeps its own.
+    const std::vector<Diagnostic>& getDiagnostics() const {
+        return fDiagnostics;
+    }
+
+    void clearDiagnostics() {
+        fDiagnostics.clear();
+    }
+
 private:
     Lexer& fLexer;
+    const OperatorTable& fOperators;
+    std::vector<Diagnostic> fDiagnostics;
+
+    // An operator parseExpression has seen but not applied yet
+    struct PendingOp {
+        // Binary operators hold their precedence, which is never negative
+        static constexpr int UNARY = 1000;
+        static constexpr int OPEN_PAREN = -1;
+
+        int tok;
+        int precedence;
+        SourceOffset loc;
+    };
+    std::vector<ExprUPtr> fOperandStack;
+    std::vector<PendingOp> fOpStack;
+    // Receives the nodes of the item being parsed, handed to its Fcn when done
+    std::unique_ptr<ASTArena> fArena;
+    // Set in hash-consing mode, holds nodes of the current item only
+    std::unique_ptr<ExprInterner> fInterner;
+
+    void startItem() {
+        fArena = std::make_unique<ASTArena>();
+        if (fInterner) {
+            fInterner->clear();
+        }
+    }
+
+    template<typename T, typename... Args>
+    std::unique_ptr<T, ExprDeleter> makeExpr(Args&&... args) {
+        assert(fArena && "expressions are only parsed inside an item");
+        return fArena->create<T>(std::forward<Args>(args)...);
+    }
 
     template<typename R>
     inline std::unique_ptr<R> logErrorAndReturnNull(const char* str) {
-        (void)str;
-        // fprintf(stderr, "ParseError: %s\n", str);
+        // The lexer has reported bad tokens already, and callers that fail
+        // because of an error below them report it at the same token again
+        SourceOffset loc = fLexer.getCurrentOffset();
+        if (fLexer.getCurrentToken() != tok_error 
+                && (fDiagnostics.empty() || fDiagnostics.back().loc != loc)) {
+            fDiagnostics.push_back({loc, str});
+        }
         return nullptr;
     }
     
     /// An IdentifierExpr is of the form:
     ///     <identifier> for a VariableExpr, or
     ///     <identifier> ( <expression> , ... ) for a CallExpr.
-    std::unique_ptr<Expr> parseIdentifierExpr() {
+    ExprUPtr parseIdentifierExpr() {
         if (fLexer.getCurrentToken() != tok_identifier) {
             return logErrorAndReturnNull<Expr>("Expected identifier");
         }
 
-        std::string idName = fLexer.getIdentifierStr();
-        SourceLocation litLoc = fLexer.getCurrentLoc();
+        Symbol idName = fLexer.getIdentifier();
+        SourceOffset litLoc = fLexer.getCurrentOffset();
 
         if (fLexer.advance() != tok_open_paren) {
-            auto varExpr = std::make_unique<VariableExpr>(idName);
+            if (fInterner) {
+                return fInterner->getVariable(*fArena, idName, litLoc);
+            }
+            auto varExpr = makeExpr<VariableExpr>(idName);
             varExpr->setSourceLoc(litLoc);
             return std::move(varExpr);
         }
 
-        std::vector<std::unique_ptr<Expr>> args;
+        std::vector<ExprUPtr> args;
         if (!gatherCallExprArgs(args)) {
             return nullptr;
         }
@@ -89,12 +214,12 @@ private:
         }
 
         fLexer.advance();
-        auto callExpr = std::make_unique<CallExpr>(idName, std::move(args));
+        auto callExpr = makeExpr<CallExpr>(idName, std::move(args));
         callExpr->setSourceLoc(litLoc);
         return std::move(callExpr);
     }
 
-    bool gatherCallExprArgs(std::vector<std::unique_ptr<Expr>>& args) {
+    bool gatherCallExprArgs(std::vector<ExprUPtr>& args) {
         if (fLexer.advance() == tok_close_paren) {
             return true;
         }
@@ -120,15 +245,16 @@ private:
 
     /// A NumberExpr is of the form:
     ///     <number>
-    std::unique_ptr<Expr> parseNumberExpr() {
-        auto result = std::make_unique<NumberExpr>(fLexer.getNumVal());
+    ExprUPtr parseNumberExpr() {
+        ExprUPtr result = fInterner ? fInterner->getNumber(*fArena, fLexer.getNumVal())
+                                    : makeExpr<NumberExpr>(fLexer.getNumVal());
         fLexer.consume(tok_number);
-        return std::move(result);
+        return result;
     }
 
     /// A ParenExpr is of the form:
     ///     (<expression>)
-    std::unique_ptr<Expr> parseParenExpr() {
+    ExprUPtr parseParenExpr() {
         fLexer.consume(tok_open_paren);
         auto expr = parseExpression();
         if (!expr) 
@@ -141,26 +267,130 @@ private:
         return expr;
     }
 
-    /// An Expression is a sequence of primary expressions
+    /// An Expression is a sequence of unary expressions
     /// combined with binary operators, respecting operator precedence.
     /// It is of the form:
-    ///     <primary> <binOp> <primary> <binOp> <primary> ...
-    std::unique_ptr<Expr> parseExpression() {
-        auto LHS = parseUnary();
-        if (!LHS) 
-            return nullptr;
+    ///     <unary> <binOp> <unary> <binOp> <unary> ...
+    ///
+    /// Prefix operators, parentheses and operator chains go through the
+    /// explicit stacks below instead of recursion (shunting-yard), so
+    /// generated expressions can nest as deep as memory allows. Only calls,
+    /// if, for and var recurse back into parseExpression.
+    ExprUPtr parseExpression() {
+        // Nested calls share the stacks, each one works above where it started
+        size_t operandBase = fOperandStack.size();
+        size_t opBase = fOpStack.size();
+
+        ExprUPtr result;
+        if (parseOperatorExpression(opBase)) {
+            assert(fOperandStack.size() == operandBase + 1);
+            result = std::move(fOperandStack.back());
+        }
+        fOperandStack.resize(operandBase);
+        fOpStack.resize(opBase);
+        return result;
+    }
 
-        return parseBinOpRHS(0, std::move(LHS));
+    /// Leaves the parsed expression on top of fOperandStack. The operators
+    /// of this expression are the ones above opBase.
+    bool parseOperatorExpression(size_t opBase) {
+        size_t openParens = 0;
+        while (true) {
+            // An operand, after any prefix operators and open parentheses.
+            // Every ascii char other than '(' and ',' is a prefix operator.
+            while (true) {
+                int tok = fLexer.getCurrentToken();
+                if (tok == tok_open_paren) {
+                    fOpStack.push_back({tok, PendingOp::OPEN_PAREN, 0});
+                    ++openParens;
+                } else if (isascii(tok) && tok != tok_comma) {
+                    fOpStack.push_back({tok, PendingOp::UNARY, 0});
+                } else {
+                    break;
+                }
+                fLexer.advance();
+            }
+
+            auto operand = parsePrimary();
+            if (!operand) {
+                return false;
+            }
+            fOperandStack.push_back(std::move(operand));
+
+            // Close what parentheses we can, a ')' without a matching '('
+            // belongs to whatever contains this expression
+            while (openParens && fLexer.getCurrentToken() == tok_close_paren) {
+                while (fOpStack.back().precedence != PendingOp::OPEN_PAREN) {
+                    reduceOp();
+                }
+                fOpStack.pop_back();
+                --openParens;
+                fLexer.consume(tok_close_paren);
+            }
+
+            int binOp = fLexer.getCurrentToken();
+            int tokPrec = getTokenPrecedence();
+            if (tokPrec < 0) {
+                if (openParens) {
+                    logErrorAndReturnNull<Expr>("Expected ')'");
+                    return false;
+                }
+                while (fOpStack.size() > opBase) {
+                    reduceOp();
+                }
+                return true;
+            }
+
+            // Everything on the stack that binds tighter takes its operands
+            // first. Prefix operators bind tighter than any binary operator,
+            // and a right associative one takes the next operator of the same
+            // precedence into its RHS.
+            while (fOpStack.size() > opBase) {
+                const PendingOp& top = fOpStack.back();
+                if (top.precedence == PendingOp::OPEN_PAREN || top.precedence < tokPrec
+                        || (top.precedence == tokPrec && fOperators.isRightAssociative(top.tok))) {
+                    break;
+                }
+                reduceOp();
+            }
+
+            fOpStack.push_back({binOp, tokPrec, fLexer.getCurrentOffset()});
+            fLexer.consume(Token(binOp)); // Consume the operator token
+        }
+    }
+
+    // Applies the operator on top of fOpStack to its operands
+    void reduceOp() {
+        PendingOp op = fOpStack.back();
+        fOpStack.pop_back();
+
+        if (op.precedence == PendingOp::UNARY) {
+            fOperandStack.back() = makeExpr<UnaryExpr>(op.tok, std::move(fOperandStack.back()));
+            return;
+        }
+
+        ExprUPtr RHS = std::move(fOperandStack.back());
+        fOperandStack.pop_back();
+        if (fInterner) {
+            fOperandStack.back() = fInterner->getBinary(*fArena, op.tok, std::move(fOperandStack.back()),
+                                                        std::move(RHS), op.loc);
+            return;
+        }
+        auto binExpr = makeExpr<BinaryExpr>(op.tok, std::move(fOperandStack.back()), std::move(RHS));
+        binExpr->setSourceLoc(op.loc);
+        fOperandStack.back() = std::move(binExpr);
     }
 
     /// A PrimaryExpr is either:
     ///     - An IdentifierExpr (VariableExpr or CallExpr)
     ///     - A NumberExpr
     ///     - A ParenExpr
-    std::unique_ptr<Expr> parsePrimary() {
+    ExprUPtr parsePrimary() {
         switch (fLexer.getCurrentToken()) {
             default:
                 return logErrorAndReturnNull<Expr>("Unknown token when expecting an expression");
+            case tok_error:
+                return nullptr; // Already reported by the lexer
             case tok_identifier:
                 return parseIdentifierExpr();
             case tok_number:
@@ -179,61 +409,16 @@ private:
     // Used for Operator-Precedence Parsing, as binary operators
     // have an expected "precedence" in mathematics that we want to respect.
     int getTokenPrecedence() {
-        if (!isascii(fLexer.getCurrentToken())) {
-            return -1;
-        }
-
-        auto it = BIN_OP_PRECEDENCE.find(static_cast<char>(fLexer.getCurrentToken()));
-        if (it == BIN_OP_PRECEDENCE.end()) {
-            return -1;
-        }
-        return it->second;
-    }
-
-    /// Recursively parse binary operators with precedence.
-    /// This function assumes that LHS is already parsed and
-    /// that the current token is a binary operator with precedence >= exprPrec.
-    ///
-    /// It will parse the right-hand side (RHS) of the binary operation,
-    /// and continue parsing if the next token is also a binary operator
-    /// with higher or equal precedence.
-    ///
-    /// BinaryExprs are of the form:
-    ///     <binOp> <primary>*
-    std::unique_ptr<Expr> parseBinOpRHS(int exprPrec, std::unique_ptr<Expr> LHS) {
-        while (true) {
-            int tokPrec = getTokenPrecedence();
-            if (tokPrec < exprPrec) {
-                return LHS; // No more binary operators with higher precedence
-            }
-
-            int binOp = fLexer.getCurrentToken();
-            SourceLocation binLoc = fLexer.getCurrentLoc();
-            fLexer.consume(Token(binOp)); // Consume the operator token
-
-            auto RHS = parseUnary();
-            if (!RHS) 
-                return nullptr;
-
-            int nextPrec = getTokenPrecedence();
-            if (tokPrec < nextPrec) {
-                RHS = parseBinOpRHS(tokPrec + 1, std::move(RHS));
-                if (!RHS) 
-                    return nullptr;
-            }
-
-            LHS = std::make_unique<BinaryExpr>(binOp, std::move(LHS), std::move(RHS));
-            LHS->setSourceLoc(binLoc);
-        }
+        return fOperators.getPrecedence(fLexer.getCurrentToken());
     }
 
     /// Parses a function prototype, which is of the form:
     ///     <identifier> ( <identifier> , ... )
     ///     <binary><CHAR> number? (id id)
     std::unique_ptr<FcnPrototype> parsePrototype() {
-        std::string fcnName;
+        Symbol fcnName;
 
-        SourceLocation fnLoc = fLexer.getCurrentLoc();
+        SourceOffset fnLoc = fLexer.getCurrentOffset();
 
         unsigned Kind = 0; // 0 = ID, 1 = Unary, 2 = Binary
         unsigned BinaryPrecedence = 30;
@@ -242,7 +427,7 @@ private:
             default:
                 return logErrorAndReturnNull<FcnPrototype>("Expected function name in prototype");
             case tok_identifier:
-                fcnName = fLexer.getIdentifierStr();
+                fcnName = fLexer.getIdentifier();
                 Kind = 0;
                 fLexer.consume(tok_identifier);
                 break;
@@ -251,8 +436,7 @@ private:
                 if (!isascii(fLexer.getCurrentToken()) || std::isalnum(fLexer.getCurrentToken())) {
                     return logErrorAndReturnNull<FcnPrototype>("Expected unary operator");
                 }
-                fcnName = "unary";
-                fcnName += (char)fLexer.getCurrentToken();
+                fcnName = std::string("unary") + (char)fLexer.getCurrentToken();
                 Kind = 1;
                 fLexer.advance();
                 break;
@@ -261,8 +445,7 @@ private:
                 if (!isascii(fLexer.getCurrentToken()) || std::isalnum(fLexer.getCurrentToken())) {
                     return logErrorAndReturnNull<FcnPrototype>("Expected binary operator");
                 }
-                fcnName = "binary";
-                fcnName += (char)fLexer.getCurrentToken();
+                fcnName = std::string("binary") + (char)fLexer.getCurrentToken();
                 Kind = 2;
                 fLexer.advance();
 
@@ -280,9 +463,9 @@ private:
         }
 
         // What about commas?
-        std::vector<std::string> argNames;
+        std::vector<Symbol> argNames;
         while (fLexer.advance() == tok_identifier) {
-            argNames.push_back(fLexer.getIdentifierStr());
+            argNames.push_back(fLexer.getIdentifier());
         }
 
         if (fLexer.getCurrentToken() != tok_close_paren) {
@@ -299,8 +482,8 @@ private:
         return std::move(fcnProto);
     }
 
-    std::unique_ptr<Expr> parseIfExpr() {
-        SourceLocation ifLoc = fLexer.getCurrentLoc();
+    ExprUPtr parseIfExpr() {
+        SourceOffset ifLoc = fLexer.getCurrentOffset();
         fLexer.consume(tok_if);
 
         auto Cond = parseExpression();
@@ -328,19 +511,19 @@ private:
             return nullptr;
         }
 
-        auto ifExpr = std::make_unique<IfExpr>(std::move(Cond), std::move(Then), std::move(Else));
+        auto ifExpr = makeExpr<IfExpr>(std::move(Cond), std::move(Then), std::move(Else));
         ifExpr->setSourceLoc(ifLoc);
         return std::move(ifExpr);
     }
 
-    std::unique_ptr<Expr> parseForExpr() {
+    ExprUPtr parseForExpr() {
         fLexer.consume(tok_for);
 
         if (fLexer.getCurrentToken() != tok_identifier) {
             return logErrorAndReturnNull<ForExpr>("Expected identifier after for");
         }
 
-        std::string idName = fLexer.getIdentifierStr();
+        Symbol idName = fLexer.getIdentifier();
         fLexer.advance();
 
         if (fLexer.getCurrentToken() != '=') {
@@ -348,7 +531,7 @@ private:
         }
         fLexer.advance();
 
-        // Don't use parseExpression to ensure parseUnary is not called
+        // Don't use parseExpression so no prefix operator is parsed
         // upfront, that can swallow a missing comma
         auto start = parsePrimary();
         if (!start) {
@@ -364,7 +547,7 @@ private:
             return nullptr;
         }
 
-        std::unique_ptr<Expr> step;
+        ExprUPtr step;
         if (fLexer.getCurrentToken() == tok_comma) {
             fLexer.advance();
             step = parseExpression();
@@ -383,27 +566,11 @@ private:
             return nullptr;
         }
         
-        return std::make_unique<ForExpr>(idName, std::move(start), 
+        return makeExpr<ForExpr>(idName, std::move(start), 
                         std::move(end),std::move(step), std::move(body));
     }
 
-    /// unary of the form:
-    ///     <primary>
-    ///     unary<op>
-    std::unique_ptr<Expr> parseUnary() {
-        auto curTok = fLexer.getCurrentToken();
-        if (!isascii(curTok) || curTok == tok_open_paren || curTok == tok_comma) {
-            return parsePrimary();
-        }
-
-        fLexer.advance();
-        if (auto operand = parseUnary()) {
-            return std::make_unique<UnaryExpr>(curTok, std::move(operand));
-        }
-        return nullptr;
-    }
-
-    std::unique_ptr<Expr> parseVarExpr() {
+    ExprUPtr parseVarExpr() {
         fLexer.consume(tok_var);
 
         VarNameVector varNames;
@@ -413,7 +580,7 @@ private:
         }
 
         while (true) {
-            std::string name = fLexer.getIdentifierStr();
+            Symbol name = fLexer.getIdentifier();
             fLexer.consume(tok_identifier);
 
             ExprUPtr init;
@@ -447,7 +614,7 @@ private:
             return nullptr;
         }
 
-        return std::make_unique<VarExpr>(std::move(varNames), std::move(body));
+        return makeExpr<VarExpr>(std::move(varNames), std::move(body));
     }
 };
 } // namespace lang
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+
+namespace lang {
+
+// Bulk character scanners used by the buffer backend of the Lexer. Each
+// one is vectorized when the CPU supports it (AVX2, then SSE2) and falls
+// back to a scalar loop otherwise. The implementation is picked once at
+// startup. All scanners return `end` if nothing stops them.
+namespace scan {
+
+enum class Impl {
+    Scalar,
+    SSE2,
+    AVX2,
+};
+
+// Skips ' ', '\t', '\n', '\v', '\f' and '\r', i.e. isspace() in the C locale
+const char* skipWhitespace(const char* p, const char* end);
+
+// Finds the next '\n' or '\r'
+const char* findEndOfLine(const char* p, const char* end);
+
+// Skips [A-Za-z0-9], i.e. isalnum() in the C locale
+const char* skipIdentifier(const char* p, const char* end);
+
+Impl getImpl();
+
+// Forces an implementation, mainly for testing and benchmarking.
+// Returns false and changes nothing if the CPU doesn't support it.
+bool setImpl(Impl impl);
+
+const char* getImplName(Impl impl);
+
+} // namespace scan
+} // namespace lang
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace lang {
+
+// Feeds the Lexer from a file descriptor (e.g. piped stdin) in bounded
+// memory. Input is read with large read() calls into fixed size chunks,
+// and every chunk handed out ends right after a line break. Tokens never
+// span a line break, so the Lexer can run its buffer backend over each
+// chunk in turn. Chunks stay valid until releaseConsumed() and are then
+// recycled, so memory only depends on how much input a single top-level
+// item spans, not on the length of the stream.
+class StreamSource {
+public:
+    static constexpr size_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+    explicit StreamSource(int fd, size_t chunkSize = DEFAULT_CHUNK_SIZE);
+
+    StreamSource(const StreamSource&) = delete;
+    StreamSource& operator=(const StreamSource&) = delete;
+
+    // The next piece of input, empty once the stream is exhausted. Only the
+    // last chunk may end without a line break. A line longer than the chunk
+    // size gets a chunk of its own, grown to fit.
+    std::string_view nextChunk();
+
+    // Recycles every chunk handed out before the most recent one
+    void releaseConsumed();
+
+    // Chunks currently allocated, whether in use or free
+    size_t getAllocatedChunks() const {
+        return inUse.size() + freeList.size();
+    }
+
+private:
+    struct Chunk {
+        std::unique_ptr<char[]> data;
+        size_t capacity = 0;
+        size_t size = 0; // Bytes handed out
+        size_t filled = 0; // Bytes read, the rest carries over to the next chunk
+    };
+
+    // Appends to `chunk` with a single read(), returns false at end of input
+    bool fill(Chunk& chunk);
+
+    int fd;
+    size_t chunkSize;
+    bool atEof = false;
+    std::vector<Chunk> inUse; // Oldest first, the last one is current
+    std::vector<Chunk> freeList;
+};
+
+} // namespace lang
@@ -0,0 +1,36 @@
+#pragma once
+
+namespace lang {
+
+// Return token [0-255] for unknown chars, otherwise a known token
+enum Token : int {
+    tok_open_paren = '(',
+    tok_close_paren = ')',
+    tok_comma = ',',
+    tok_semicolon = ';',
+
+    tok_eof = -1,
+
+    tok_def = -2,
+    tok_extern = -3,
+
+    tok_identifier = -4,
+    tok_number = -5,
+
+    tok_if = -6,
+    tok_then = -7,
+    tok_else = -8,
+
+    tok_for = -9,
+    tok_in = -10,
+
+    tok_binary = -11,
+    tok_unary = -12,
+
+    tok_var = -13,
+
+    // Malformed input, the lexer has already reported a diagnostic
+    tok_error = -14,
+};
+
+} // namespace lang
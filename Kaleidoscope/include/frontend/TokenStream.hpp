@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "AST/Symbol.hpp"
+#include "debug/SourceLocation.hpp"
+#include "Diagnostic.hpp"
+#include "Token.hpp"
+
+namespace lang {
+
+class Lexer;
+
+// A whole source lexed up front, stored as parallel arrays so the parser
+// can index it directly. Replayed through Lexer(const TokenStream&) it
+// gives the parser arbitrary lookahead and backtracking, and lets lexing
+// and parsing be timed separately. Always ends with tok_eof.
+class TokenStream {
+public:
+    // Sources are only split into pieces at least this large
+    static constexpr size_t MIN_PARALLEL_CHUNK = 1 << 20;
+
+    // Drains everything `lexer` has left, up to and including tok_eof
+    explicit TokenStream(Lexer& lexer);
+
+    // Splits `source` at line starts and lexes the pieces concurrently on up
+    // to `jobs` threads, giving the same tokens as lexing it in one go.
+    // Pieces prefer to start at a top-level def or extern.
+    static TokenStream lexParallel(std::string_view source, unsigned jobs,
+                                   size_t minChunk = MIN_PARALLEL_CHUNK);
+
+    size_t size() const {
+        return kinds.size();
+    }
+
+    Token getKind(size_t i) const {
+        return static_cast<Token>(kinds[i]);
+    }
+
+    SourceOffset getOffset(size_t i) const {
+        return offsets[i];
+    }
+
+    // Only meaningful if getKind(i) is tok_identifier
+    Symbol getSymbol(size_t i) const {
+        return SymbolTable::get()->fromId(payloads[i].symbol);
+    }
+
+    // Only meaningful if getKind(i) is tok_number
+    double getNumVal(size_t i) const {
+        return payloads[i].number;
+    }
+
+    const std::vector<Diagnostic>& getDiagnostics() const {
+        return diagnostics;
+    }
+
+private:
+    TokenStream() = default;
+
+    // Appends a piece lexed on its own, which starts `offsetBase` bytes into
+    // the full source. Drops its tok_eof unless `last`.
+    void append(const TokenStream& piece, SourceOffset offsetBase, bool last);
+
+    union Payload {
+        double number;
+        uint32_t symbol;
+    };
+
+    // Tokens are either characters or small negative enumerators
+    std::vector<int16_t> kinds;
+    std::vector<SourceOffset> offsets;
+    std::vector<Payload> payloads;
+    std::vector<Diagnostic> diagnostics;
+};
+
+} // namespace lang
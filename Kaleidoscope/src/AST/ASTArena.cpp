@@ -0,0 +1,33 @@
+#include "AST/ASTArena.hpp"
+
+#include <algorithm>
+
+ASTArena::~ASTArena() {
+    // Newest first, parents go before their children
+    for (Entry* entry = last; entry; entry = entry->prev) {
+        entry->expr->~Expr();
+    }
+
+    while (slabs) {
+        Slab* next = slabs->next;
+        ::operator delete(slabs);
+        slabs = next;
+    }
+}
+
+void ASTArena::grow(size_t size) {
+    // Keeps the first node in a slab aligned
+    constexpr size_t SLAB_HEADER_SIZE = ALIGN;
+    static_assert(sizeof(Slab) <= SLAB_HEADER_SIZE && ALIGN <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+
+    bytesUsed += cur - slabBegin;
+    size_t slabSize = std::max(nextSlabSize, size + SLAB_HEADER_SIZE);
+    nextSlabSize = std::min(nextSlabSize * 2, MAX_SLAB_SIZE);
+
+    auto* slab = static_cast<Slab*>(::operator new(slabSize));
+    slab->next = slabs;
+    slabs = slab;
+
+    slabBegin = cur = reinterpret_cast<std::byte*>(slab) + SLAB_HEADER_SIZE;
+    end = reinterpret_cast<std::byte*>(slab) + slabSize;
+}
@@ -0,0 +1,85 @@
+#include "AST/ASTPrinter.hpp"
+
+#include <algorithm>
+
+namespace {
+
+// Their bodies go one level deeper
+bool opensBlock(const Expr& expr) {
+    NodeKind kind = expr.getKind();
+    return kind == NodeKind::If || kind == NodeKind::For || kind == NodeKind::Var;
+}
+
+} // namespace
+
+void ASTPrinter::print(const Expr& root) {
+    pending.clear();
+    depths.clear();
+    pending.push_back({&root, {}});
+    depths.push_back(0);
+    while (!pending.empty() && !truncated) {
+        Expr::PrintItem item = pending.back();
+        unsigned depth = depths.back();
+        pending.pop_back();
+        depths.pop_back();
+        if (!item.expr) {
+            write(item.text, depth);
+            continue;
+        }
+
+        // The node's own text goes to `text`, its pieces onto `pending`
+        size_t first = pending.size();
+        text.clear();
+        item.expr->print(text, pending);
+        write(text, depth);
+
+        unsigned childDepth = depth + opensBlock(*item.expr);
+        for (size_t i = first; i < pending.size(); ++i) {
+            depths.push_back(pending[i].expr ? childDepth : depth);
+        }
+    }
+}
+
+void ASTPrinter::write(std::string_view text, unsigned depth) {
+    if (indentWidth == 0) {
+        writeRaw(text);
+        return;
+    }
+    while (!text.empty()) {
+        size_t special = text.find_first_of("\n\t");
+        writeRaw(text.substr(0, special));
+        if (special == std::string_view::npos) {
+            return;
+        }
+        if (text[special] == '\n') {
+            writeRaw("\n");
+            writeSpaces(static_cast<size_t>(depth) * indentWidth);
+        } else {
+            writeSpaces(indentWidth);
+        }
+        text.remove_prefix(special + 1);
+    }
+}
+
+void ASTPrinter::writeSpaces(size_t count) {
+    constexpr std::string_view SPACES = "                                ";
+    while (count) {
+        size_t n = std::min(count, SPACES.size());
+        writeRaw(SPACES.substr(0, n));
+        count -= n;
+    }
+}
+
+void ASTPrinter::writeRaw(std::string_view text) {
+    if (truncated) {
+        return;
+    }
+    if (maxBytes && text.size() > maxBytes - written) {
+        out << text.substr(0, maxBytes - written) << "...";
+        written = maxBytes;
+        truncated = true;
+        return;
+    }
+    out << text;
+    written += text.size();
+}
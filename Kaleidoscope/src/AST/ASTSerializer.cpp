@@ -0,0 +1,469 @@
+#include "AST/ASTSerializer.hpp"
+
+#include <bit>
+#include <cassert>
+#include <cstring>
+
+#include "AST/ASTVisitor.hpp"
+
+namespace {
+
+enum class Tag : uint8_t {
+    Number = 1,
+    Variable,
+    Binary,
+    Unary,
+    Call,
+    If,
+    For,
+    ForWithStep,
+    Var,
+};
+
+// Flags in a node's tag byte and in a prototype's flags byte. Offset 0 is
+// a real location, so whether one follows is a flag of its own.
+constexpr uint8_t IS_OPERATOR = 0x01;
+constexpr uint8_t HAS_LOC = 0x80;
+
+// Varints are at most this long
+constexpr int MAX_VARINT_BYTES = 10;
+
+uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+} // namespace
+
+// Writes the fields of one node and queues its children, so the writer
+// walks a tree of any depth with its own stack
+class NodeEncoder : public ASTVisitor {
+public:
+    explicit NodeEncoder(ASTWriter& writer) : writer(writer) {}
+
+    void visitNumberExpr(NumberExpr &expr) override {
+        writeHeader(Tag::Number, expr);
+        writer.writeFixed64(std::bit_cast<uint64_t>(expr.getValue()));
+    }
+
+    void visitVariableExpr(VariableExpr &expr) override {
+        writeHeader(Tag::Variable, expr);
+        writer.writeSymbol(expr.getName());
+    }
+
+    void visitBinaryExpr(BinaryExpr &expr) override {
+        writeHeader(Tag::Binary, expr);
+        writer.out += expr.getOp();
+        push(expr.getRHS());
+        push(expr.getLHS());
+    }
+
+    void visitUnaryExpr(UnaryExpr &expr) override {
+        writeHeader(Tag::Unary, expr);
+        writer.out += expr.getOp();
+        push(expr.getOperand());
+    }
+
+    void visitCallExpr(CallExpr &expr) override {
+        writeHeader(Tag::Call, expr);
+        writer.writeSymbol(expr.getCalleeName());
+        auto args = expr.getArgs();
+        writer.writeVarint(args.size());
+        for (size_t i = args.size(); i-- > 0;) {
+            push(args[i]);
+        }
+    }
+
+    void visitIfExpr(IfExpr &expr) override {
+        writeHeader(Tag::If, expr);
+        push(expr.getElse());
+        push(expr.getThen());
+        push(expr.getCond());
+    }
+
+    void visitForExpr(ForExpr &expr) override {
+        writeHeader(expr.getStep() ? Tag::ForWithStep : Tag::For, expr);
+        writer.writeSymbol(expr.getVarName());
+        push(expr.getBody());
+        if (expr.getStep()) {
+            push(expr.getStep());
+        }
+        push(expr.getEnd());
+        push(expr.getStart());
+    }
+
+    void visitVarExpr(VarExpr &expr) override {
+        writeHeader(Tag::Var, expr);
+        auto vars = expr.getVarNames();
+        writer.writeVarint(vars.size());
+        for (auto [name, init] : vars) {
+            writer.writeSymbol(name);
+            writer.out += static_cast<char>(init != nullptr);
+        }
+        push(expr.getBody());
+        for (size_t i = vars.size(); i-- > 0;) {
+            if (vars[i].second) {
+                push(vars[i].second);
+            }
+        }
+    }
+
+    void visitFcnPrototype(FcnPrototype& /*proto*/) override {
+        assert(false && "prototypes are written by ASTWriter::writePrototype");
+    }
+
+    void visitFcn(Fcn& /*fcn*/) override {
+        assert(false && "functions are written by ASTWriter::writeFcn");
+    }
+
+private:
+    void writeHeader(Tag tag, const Expr& expr) {
+        uint8_t byte = static_cast<uint8_t>(tag);
+        if (!expr.hasSourceLoc()) {
+            writer.out += static_cast<char>(byte);
+            return;
+        }
+        writer.out += static_cast<char>(byte | HAS_LOC);
+        writer.writeLoc(expr.getSourceLoc());
+    }
+
+    void push(Expr* child) {
+        assert(child && "parsed expressions have all their children");
+        writer.stack.push_back(child);
+    }
+
+    ASTWriter& writer;
+};
+
+void ASTWriter::writeFcn(Fcn& fcn) {
+    assert(fcn.getPrototype() && "codegen has taken the prototype already");
+    writePrototype(*fcn.getPrototype());
+
+    NodeEncoder encoder(*this);
+    stack.push_back(fcn.getBody());
+    while (!stack.empty()) {
+        Expr* expr = stack.back();
+        stack.pop_back();
+        expr->accept(encoder);
+    }
+}
+
+void ASTWriter::writePrototype(const FcnPrototype& proto) {
+    writeSymbol(proto.getName());
+    uint8_t flags = (proto.isUnaryOp() || proto.isBinaryOp()) ? IS_OPERATOR : 0;
+    if (proto.hasSourceLoc()) {
+        flags |= HAS_LOC;
+    }
+    out += static_cast<char>(flags);
+    if (flags & HAS_LOC) {
+        writeLoc(proto.getSourceLoc());
+    }
+    writeVarint(proto.getBinaryPrecedence());
+    writeVarint(proto.getArgs().size());
+    for (Symbol arg : proto.getArgs()) {
+        writeSymbol(arg);
+    }
+}
+
+void ASTWriter::writeVarint(uint64_t value) {
+    while (value >= 0x80) {
+        out += static_cast<char>(value | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+void ASTWriter::writeString(std::string_view str) {
+    writeVarint(str.size());
+    out += str;
+}
+
+void ASTWriter::writeSymbol(Symbol symbol) {
+    auto [it, inserted] = symbolIndex.try_emplace(symbol, static_cast<uint32_t>(symbolIndex.size()));
+    if (inserted) {
+        writeVarint(0);
+        writeString(symbol.str());
+    } else {
+        writeVarint(it->second + 1);
+    }
+}
+
+void ASTWriter::writeLoc(SourceOffset loc) {
+    writeVarint(zigzag(static_cast<int64_t>(loc) - base));
+}
+
+void ASTWriter::writeFixed64(uint64_t value) {
+    char bytes[sizeof(value)];
+    std::memcpy(bytes, &value, sizeof(value));
+    out.append(bytes, sizeof(bytes));
+}
+
+// A node read from the input, waiting for its children
+struct ASTReader::Frame {
+    Tag tag = Tag::Number;
+    bool hasLoc = false;
+    SourceOffset loc = 0;
+    char op = 0;
+    Symbol name;
+    uint64_t numChildren = 0;
+    size_t operandBase = 0; // Where its children start in `operands`
+    std::vector<std::pair<Symbol, bool>> vars; // Names of a VarExpr, with or without init
+};
+
+ASTReader::ASTReader(std::string_view in, SourceOffset base) : in(in), base(base) {}
+
+ASTReader::~ASTReader() = default;
+
+std::unique_ptr<Fcn> ASTReader::readFcn() {
+    auto proto = readPrototype();
+    if (!proto) {
+        return nullptr;
+    }
+    auto arena = std::make_unique<ASTArena>();
+    ExprUPtr body = readExpr(*arena);
+    if (!body) {
+        return nullptr;
+    }
+    return std::make_unique<Fcn>(std::move(proto), std::move(body), std::move(arena));
+}
+
+std::unique_ptr<FcnPrototype> ASTReader::readPrototype() {
+    Symbol name;
+    SourceOffset loc = 0;
+    uint64_t precedence, numArgs;
+    if (!readSymbol(name) || pos == in.size()) {
+        return nullptr;
+    }
+    uint8_t flags = static_cast<uint8_t>(in[pos++]);
+    if (((flags & HAS_LOC) && !readLoc(loc)) || !readVarint(precedence) || !readVarint(numArgs)) {
+        return nullptr;
+    }
+
+    std::vector<Symbol> args;
+    for (uint64_t i = 0; i < numArgs; ++i) {
+        Symbol arg;
+        if (!readSymbol(arg)) {
+            return nullptr;
+        }
+        args.push_back(arg);
+    }
+    auto proto = std::make_unique<FcnPrototype>(name, std::move(args), (flags & IS_OPERATOR) != 0,
+                                                 static_cast<unsigned>(precedence));
+    if (flags & HAS_LOC) {
+        proto->setSourceLoc(loc);
+    }
+    return proto;
+}
+
+ExprUPtr ASTReader::readExpr(ASTArena& arena) {
+    ExprUPtr root = readNodes(arena);
+    // What a failed read left behind goes while its arena is still alive
+    operands.clear();
+    frames.clear();
+    return root;
+}
+
+ExprUPtr ASTReader::readNodes(ASTArena& arena) {
+
+    while (true) {
+        if (pos == in.size()) {
+            return nullptr;
+        }
+        uint8_t byte = static_cast<uint8_t>(in[pos++]);
+        Frame frame;
+        frame.tag = static_cast<Tag>(byte & ~HAS_LOC);
+        frame.hasLoc = (byte & HAS_LOC) != 0;
+        if (frame.hasLoc && !readLoc(frame.loc)) {
+            return nullptr;
+        }
+
+        switch (frame.tag) {
+            case Tag::Number: {
+                uint64_t bits;
+                if (!readFixed64(bits)) {
+                    return nullptr;
+                }
+                operands.push_back(arena.create<NumberExpr>(std::bit_cast<double>(bits)));
+                if (frame.hasLoc) {
+                    operands.back()->setSourceLoc(frame.loc);
+                }
+                break;
+            }
+            case Tag::Variable: {
+                Symbol name;
+                if (!readSymbol(name)) {
+                    return nullptr;
+                }
+                operands.push_back(arena.create<VariableExpr>(name));
+                if (frame.hasLoc) {
+                    operands.back()->setSourceLoc(frame.loc);
+                }
+                break;
+            }
+            case Tag::Binary:
+            case Tag::Unary:
+                if (pos == in.size()) {
+                    return nullptr;
+                }
+                frame.op = in[pos++];
+                frame.numChildren = frame.tag == Tag::Binary ? 2 : 1;
+                break;
+            case Tag::Call:
+                if (!readSymbol(frame.name) || !readVarint(frame.numChildren)) {
+                    return nullptr;
+                }
+                break;
+            case Tag::If:
+                frame.numChildren = 3;
+                break;
+            case Tag::For:
+            case Tag::ForWithStep:
+                if (!readSymbol(frame.name)) {
+                    return nullptr;
+                }
+                frame.numChildren = frame.tag == Tag::For ? 3 : 4;
+                break;
+            case Tag::Var: {
+                uint64_t numVars;
+                if (!readVarint(numVars)) {
+                    return nullptr;
+                }
+                for (uint64_t i = 0; i < numVars; ++i) {
+                    Symbol name;
+                    if (!readSymbol(name) || pos == in.size()) {
+                        return nullptr;
+                    }
+                    bool hasInit = in[pos++] != 0;
+                    frame.vars.emplace_back(name, hasInit);
+                    frame.numChildren += hasInit;
+                }
+                frame.numChildren += 1; // Body
+                break;
+            }
+            default:
+                return nullptr;
+        }
+        if (frame.tag != Tag::Number && frame.tag != Tag::Variable) {
+            frame.operandBase = operands.size();
+            frames.push_back(std::move(frame));
+        }
+
+        // Builds every node whose children are all there now
+        while (!frames.empty() && operands.size() - frames.back().operandBase == frames.back().numChildren) {
+            Frame& done = frames.back();
+            auto children = operands.begin() + static_cast<ptrdiff_t>(done.operandBase);
+            ExprUPtr expr;
+            switch (done.tag) {
+                case Tag::Binary:
+                    expr = arena.create<BinaryExpr>(done.op, std::move(children[0]), std::move(children[1]));
+                    break;
+                case Tag::Unary:
+                    expr = arena.create<UnaryExpr>(done.op, std::move(children[0]));
+                    break;
+                case Tag::Call: {
+                    std::vector<ExprUPtr> args(std::make_move_iterator(children),
+                                               std::make_move_iterator(operands.end()));
+                    expr = arena.create<CallExpr>(done.name, std::move(args));
+                    break;
+                }
+                case Tag::If:
+                    expr = arena.create<IfExpr>(std::move(children[0]), std::move(children[1]),
+                                                std::move(children[2]));
+                    break;
+                case Tag::For:
+                    expr = arena.create<ForExpr>(done.name, std::move(children[0]), std::move(children[1]),
+                                                 nullptr, std::move(children[2]));
+                    break;
+                case Tag::ForWithStep:
+                    expr = arena.create<ForExpr>(done.name, std::move(children[0]), std::move(children[1]),
+                                                 std::move(children[2]), std::move(children[3]));
+                    break;
+                case Tag::Var: {
+                    VarNameVector vars;
+                    for (auto& [name, hasInit] : done.vars) {
+                        vars.emplace_back(name, hasInit ? std::move(*children++) : nullptr);
+                    }
+                    expr = arena.create<VarExpr>(std::move(vars), std::move(*children));
+                    break;
+                }
+                default:
+                    assert(false && "leaves never get a frame");
+            }
+            if (done.hasLoc) {
+                expr->setSourceLoc(done.loc);
+            }
+            operands.resize(done.operandBase);
+            operands.push_back(std::move(expr));
+            frames.pop_back();
+        }
+
+        if (frames.empty()) {
+            assert(operands.size() == 1);
+            return std::move(operands.back());
+        }
+    }
+}
+
+bool ASTReader::readVarint(uint64_t& value) {
+    value = 0;
+    for (int i = 0; i < MAX_VARINT_BYTES && pos < in.size(); ++i) {
+        uint8_t byte = static_cast<uint8_t>(in[pos++]);
+        value |= static_cast<uint64_t>(byte & 0x7f) << (7 * i);
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ASTReader::readString(std::string_view& str) {
+    uint64_t size;
+    if (!readVarint(size) || size > in.size() - pos) {
+        return false;
+    }
+    str = in.substr(pos, size);
+    pos += size;
+    return true;
+}
+
+bool ASTReader::readSymbol(Symbol& symbol) {
+    uint64_t index;
+    if (!readVarint(index)) {
+        return false;
+    }
+    if (index == 0) {
+        std::string_view str;
+        if (!readString(str)) {
+            return false;
+        }
+        symbol = Symbol(str);
+        symbols.push_back(symbol);
+        return true;
+    }
+    if (index > symbols.size()) {
+        return false;
+    }
+    symbol = symbols[index - 1];
+    return true;
+}
+
+bool ASTReader::readLoc(SourceOffset& loc) {
+    uint64_t value;
+    if (!readVarint(value)) {
+        return false;
+    }
+    loc = static_cast<SourceOffset>(base + unzigzag(value));
+    return true;
+}
+
+bool ASTReader::readFixed64(uint64_t& value) {
+    if (in.size() - pos < sizeof(value)) {
+        return false;
+    }
+    std::memcpy(&value, in.data() + pos, sizeof(value));
+    pos += sizeof(value);
+    return true;
+}
@@ -0,0 +1,207 @@
+#include "AST/ASTStats.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#include "AST/ASTArena.hpp"
+#include "AST/StaticVisitor.hpp"
+#include "debug/SourceManager.hpp"
+
+namespace {
+
+// Counts the nodes of a body without recursing: each visit records one
+// node and pushes its children one level deeper
+class NodeCounter final : public StaticVisitor<NodeCounter> {
+public:
+    explicit NodeCounter(ItemStats& stats) : stats(stats) {}
+
+    void count(Expr& root, size_t rootDepth) {
+        pending.push_back({&root, rootDepth});
+        while (!pending.empty()) {
+            auto [expr, exprDepth] = pending.back();
+            pending.pop_back();
+            depth = exprDepth;
+            stats.maxDepth = std::max(stats.maxDepth, depth);
+            ++stats.numNodes;
+            ++stats.nodesByType[expr->getType()];
+            visit(*expr);
+        }
+    }
+
+    void visitNumberExpr(NumberExpr &expr) {
+        addHeapBytes(expr);
+    }
+
+    void visitVariableExpr(VariableExpr &expr) {
+        addHeapBytes(expr);
+    }
+
+    void visitBinaryExpr(BinaryExpr &expr) {
+        addHeapBytes(expr);
+        push(expr.getLHS());
+        push(expr.getRHS());
+    }
+
+    void visitUnaryExpr(UnaryExpr &expr) {
+        addHeapBytes(expr);
+        push(expr.getOperand());
+    }
+
+    void visitCallExpr(CallExpr &expr) {
+        addHeapBytes(expr);
+        stats.childBytes += expr.getNumArgs() * sizeof(ExprUPtr);
+        for (Expr* arg : expr.getArgs()) {
+            push(arg);
+        }
+    }
+
+    void visitIfExpr(IfExpr &expr) {
+        addHeapBytes(expr);
+        push(expr.getCond());
+        push(expr.getThen());
+        push(expr.getElse());
+    }
+
+    void visitForExpr(ForExpr &expr) {
+        addHeapBytes(expr);
+        push(expr.getStart());
+        push(expr.getEnd());
+        push(expr.getStep());
+        push(expr.getBody());
+    }
+
+    void visitVarExpr(VarExpr &expr) {
+        addHeapBytes(expr);
+        auto vars = expr.getVarNames();
+        stats.childBytes += vars.size() * sizeof(VarNameVector::value_type);
+        for (auto [name, init] : vars) {
+            push(init);
+        }
+        push(expr.getBody());
+    }
+
+    void visitFcnPrototype(FcnPrototype& /*proto*/) {}
+    void visitFcn(Fcn& /*fcn*/) {}
+    void visitOther(ASTNode& /*node*/) {}
+
+private:
+    // Arena nodes are accounted for by their arena
+    template<typename T>
+    void addHeapBytes(const T& expr) {
+        if (!expr.isArenaAllocated()) {
+            stats.nodeBytes += sizeof(T);
+        }
+    }
+
+    void push(Expr* expr) {
+        if (expr) {
+            pending.push_back({expr, depth + 1});
+        }
+    }
+
+    ItemStats& stats;
+    std::vector<std::pair<Expr*, size_t>> pending;
+    size_t depth = 0; // Of the node being visited
+};
+
+// A prototype and the storage of its arguments
+void addPrototype(ItemStats& stats, const FcnPrototype& proto) {
+    ++stats.numNodes;
+    ++stats.nodesByType[proto.getType()];
+    stats.nodeBytes += sizeof(FcnPrototype);
+    stats.childBytes += proto.getArgs().size() * sizeof(Symbol);
+}
+
+void printItem(std::ostream& out, const ItemStats& stats) {
+    out << stats.numNodes << " nodes (";
+    bool first = true;
+    for (const auto& [type, count] : stats.nodesByType) {
+        out << (first ? "" : ", ") << type << " " << count;
+        first = false;
+    }
+    out << "), depth " << stats.maxDepth
+        << ", " << stats.nodeBytes << " node bytes"
+        << ", " << stats.childBytes << " child bytes"
+        << ", " << stats.stringBytes << " string bytes"
+        << ", parsed in " << std::chrono::duration_cast<std::chrono::microseconds>(stats.parseTime).count()
+        << " us\n";
+}
+
+} // namespace
+
+void ItemStats::add(const ItemStats& other) {
+    for (const auto& [type, count] : other.nodesByType) {
+        nodesByType[type] += count;
+    }
+    numNodes += other.numNodes;
+    nodeBytes += other.nodeBytes;
+    childBytes += other.childBytes;
+    stringBytes += other.stringBytes;
+    maxDepth = std::max(maxDepth, other.maxDepth);
+    parseTime += other.parseTime;
+}
+
+void ASTStats::beginItem() {
+    itemStart = std::chrono::steady_clock::now();
+    stringBytesAtStart = SymbolTable::get()->getStringBytes();
+}
+
+void ASTStats::endItem(Fcn& fcn) {
+    auto parseTime = std::chrono::steady_clock::now() - itemStart;
+    ItemStats stats = measure(fcn);
+    stats.parseTime = std::chrono::duration_cast<std::chrono::nanoseconds>(parseTime);
+    stats.stringBytes = SymbolTable::get()->getStringBytes() - stringBytesAtStart;
+    items.push_back(std::move(stats));
+}
+
+void ASTStats::endItem(const FcnPrototype& proto) {
+    auto parseTime = std::chrono::steady_clock::now() - itemStart;
+    ItemStats stats;
+    stats.name = proto.getName();
+    stats.loc = proto.getSourceLoc();
+    addPrototype(stats, proto);
+    stats.maxDepth = 1;
+    stats.parseTime = std::chrono::duration_cast<std::chrono::nanoseconds>(parseTime);
+    stats.stringBytes = SymbolTable::get()->getStringBytes() - stringBytesAtStart;
+    items.push_back(std::move(stats));
+}
+
+ItemStats ASTStats::getTotal() const {
+    ItemStats total;
+    for (const ItemStats& item : items) {
+        total.add(item);
+    }
+    return total;
+}
+
+ItemStats ASTStats::measure(Fcn& fcn) {
+    ItemStats stats;
+    stats.name = fcn.getName();
+    // The parser locates the prototype, not the function
+    stats.loc = fcn.getPrototype() ? fcn.getPrototype()->getSourceLoc() : fcn.getSourceLoc();
+    ++stats.numNodes;
+    ++stats.nodesByType[fcn.getType()];
+    stats.nodeBytes += sizeof(Fcn);
+    stats.maxDepth = 1;
+    if (fcn.getPrototype()) {
+        addPrototype(stats, *fcn.getPrototype());
+        stats.maxDepth = 2;
+    }
+    if (fcn.getArena()) {
+        stats.nodeBytes += fcn.getArena()->getBytesUsed();
+    }
+    if (fcn.getBody()) {
+        NodeCounter(stats).count(*fcn.getBody(), 2);
+    }
+    return stats;
+}
+
+void ASTStats::print(std::ostream& out, std::string_view filename, const SourceManager& sources) const {
+    for (const ItemStats& item : items) {
+        SourceLocation loc = sources.getLocation(item.loc);
+        out << filename << ":" << loc.Line << ":" << loc.Col << ": " << item.name.str() << ": ";
+        printItem(out, item);
+    }
+    out << filename << ": " << items.size() << " items: ";
+    printItem(out, getTotal());
+}
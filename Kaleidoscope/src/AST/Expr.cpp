@@ -1,7 +1,36 @@
 #include "AST/Expr.hpp"
+#include "AST/ASTPrinter.hpp"
 #include "AST/ASTVisitor.hpp"
 #include "AST/ValueVisitor.hpp"
 
+std::string Expr::printTree(const Expr& root) {
+    std::string out;
+    llvm::raw_string_ostream stream(out);
+    ASTPrinter(stream).print(root);
+    stream.flush();
+    return out;
+}
+
+void deleteExprTree(Expr* root) {
+    // Children are taken out before their parent is deleted, so no
+    // destructor has anything left to recurse into
+    std::vector<ExprUPtr> pending;
+    root->releaseChildren(pending);
+    delete root;
+    while (!pending.empty()) {
+        Expr* expr = pending.back().release();
+        pending.pop_back();
+        if (!expr) {
+            continue;
+        }
+        if (expr->isArenaAllocated()) {
+            continue; // Its arena destroys it
+        }
+        expr->releaseChildren(pending);
+        delete expr;
+    }
+}
+
 void NumberExpr::accept(ASTVisitor &visitor) {
     visitor.visitNumberExpr(*this);
 }
@@ -0,0 +1,206 @@
+#include "AST/ExprFolder.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <optional>
+
+namespace {
+
+// What the builtin operators compute, see CodegenVisitor::visitBinaryExpr
+std::optional<double> evaluate(char op, double lhs, double rhs) {
+    switch (op) {
+        case '+':
+            return lhs + rhs;
+        case '-':
+            return lhs - rhs;
+        case '*':
+            return lhs * rhs;
+        case '<':
+            // Unordered or less than
+            return lhs < rhs || std::isnan(lhs) || std::isnan(rhs) ? 1.0 : 0.0;
+        default:
+            return std::nullopt;
+    }
+}
+
+// Tells zeros apart by sign
+bool isNumber(const NumberExpr* expr, double value) {
+    return expr && expr->getValue() == value
+        && std::signbit(expr->getValue()) == std::signbit(value);
+}
+
+} // namespace
+
+void ExprFolder::fold(Fcn& fcn) {
+    if (fcn.getPrototype()) {
+        arguments = fcn.getPrototype()->getArgs();
+    }
+    ExprUPtr body = fcn.releaseBody();
+    if (body) {
+        fold(body);
+    }
+    fcn.setBody(std::move(body));
+    arguments.clear();
+}
+
+void ExprFolder::fold(ExprUPtr& root) {
+    expanded.clear();
+    pending.push_back({&root, false});
+    while (!pending.empty()) {
+        auto [slot, childrenPushed] = pending.back();
+        // A shared node seen before is folded already, only the slot
+        // pointing to it is left
+        if (!childrenPushed && expanded.insert(slot->get()).second) {
+            pending.back().second = true;
+            children.clear();
+            (*slot)->getChildSlots(children);
+            // The destination of = has to stay a variable
+            auto* binary = llvm::dyn_cast<BinaryExpr>(slot->get());
+            if (binary && binary->getOp() == '=') {
+                children.erase(children.begin());
+            }
+            for (ExprUPtr* child : children) {
+                if (*child) {
+                    pending.push_back({child, false});
+                }
+            }
+            continue;
+        }
+        pending.pop_back();
+        simplify(*slot);
+    }
+}
+
+void ExprFolder::simplify(ExprUPtr& slot) {
+    Expr* expr = slot.get();
+    if (auto* binary = llvm::dyn_cast<BinaryExpr>(expr)) {
+        auto* lhs = llvm::dyn_cast<NumberExpr>(binary->getLHS());
+        auto* rhs = llvm::dyn_cast<NumberExpr>(binary->getRHS());
+        if (lhs && rhs) {
+            if (auto value = evaluate(binary->getOp(), lhs->getValue(), rhs->getValue())) {
+                auto number = std::make_unique<NumberExpr>(*value);
+                number->setSourceLoc(binary->getSourceLoc());
+                slot = std::move(number);
+                ++numFolded;
+            }
+            return;
+        }
+
+        children.clear();
+        binary->getChildSlots(children);
+        ExprUPtr& lhsSlot = *children[0];
+        ExprUPtr& rhsSlot = *children[1];
+        switch (binary->getOp()) {
+            case '*':
+                if (isNumber(rhs, 1.0)) {
+                    replace(slot, lhsSlot);
+                } else if (isNumber(lhs, 1.0)) {
+                    replace(slot, rhsSlot);
+                }
+                break;
+            case '-':
+                if (isNumber(rhs, 0.0)) {
+                    replace(slot, lhsSlot);
+                }
+                break;
+            case '+':
+                if (isNumber(rhs, -0.0)) {
+                    replace(slot, lhsSlot);
+                } else if (isNumber(lhs, -0.0)) {
+                    replace(slot, rhsSlot);
+                }
+                break;
+            default:
+                break;
+        }
+        return;
+    }
+
+    if (auto* ifExpr = llvm::dyn_cast<IfExpr>(expr)) {
+        auto* cond = llvm::dyn_cast<NumberExpr>(ifExpr->getCond());
+        if (!cond) {
+            return;
+        }
+        // Codegen branches on fcmp one with 0
+        bool taken = cond->getValue() != 0.0 && !std::isnan(cond->getValue());
+        if (!compiles(taken ? ifExpr->getElse() : ifExpr->getThen())) {
+            return;
+        }
+        children.clear();
+        ifExpr->getChildSlots(children);
+        replace(slot, taken ? *children[1] : *children[2]);
+    }
+}
+
+bool ExprFolder::compiles(Expr* root) {
+    auto isArgument = [this](const Expr* expr) {
+        auto* variable = llvm::dyn_cast<VariableExpr>(expr);
+        return variable && std::find(arguments.begin(), arguments.end(), variable->getName()) != arguments.end();
+    };
+    auto callable = [this](Symbol callee, size_t numArgs) {
+        return isCallable && isCallable(callee, numArgs);
+    };
+
+    std::vector<Expr*> stack{root};
+    std::vector<ExprUPtr*> slots;
+    while (!stack.empty()) {
+        Expr* expr = stack.back();
+        stack.pop_back();
+        switch (expr->getKind()) {
+            case NodeKind::Number:
+            case NodeKind::If:
+                break;
+            case NodeKind::Variable:
+                if (!isArgument(expr)) {
+                    return false;
+                }
+                break;
+            case NodeKind::Binary: {
+                auto* binary = llvm::cast<BinaryExpr>(expr);
+                char op = binary->getOp();
+                if (op == '=') {
+                    if (!isArgument(binary->getLHS())) {
+                        return false;
+                    }
+                    stack.push_back(binary->getRHS());
+                    continue;
+                }
+                bool builtin = evaluate(op, 0, 0).has_value();
+                if (!builtin && !callable(std::string("binary") + op, 2)) {
+                    return false;
+                }
+                break;
+            }
+            case NodeKind::Unary:
+                if (!callable(std::string("unary") + llvm::cast<UnaryExpr>(expr)->getOp(), 1)) {
+                    return false;
+                }
+                break;
+            case NodeKind::Call: {
+                auto* call = llvm::cast<CallExpr>(expr);
+                if (!callable(call->getCalleeName(), call->getNumArgs())) {
+                    return false;
+                }
+                break;
+            }
+            default:
+                // Scopes of their own, not worth tracking here
+                return false;
+        }
+        slots.clear();
+        expr->getChildSlots(slots);
+        for (ExprUPtr* slot : slots) {
+            stack.push_back(slot->get());
+        }
+    }
+    return true;
+}
+
+void ExprFolder::replace(ExprUPtr& slot, ExprUPtr& child) {
+    // Arena nodes are not owned by their parents and may have several, so
+    // the old parent keeps pointing to them. Heap nodes have just the one.
+    ExprUPtr kept = child->isArenaAllocated() ? ExprUPtr(child.get()) : std::move(child);
+    slot = std::move(kept);
+    ++numFolded;
+}
@@ -0,0 +1,74 @@
+#include "AST/ExprInterner.hpp"
+
+#include <bit>
+
+namespace {
+
+size_t combine(size_t hash, uint64_t value) {
+    return hash ^ (value + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2));
+}
+
+// User defined operators call a function, which may have side effects
+bool isBuiltinArithmetic(char op) {
+    return op == '+' || op == '-' || op == '*' || op == '<';
+}
+
+} // namespace
+
+ExprUPtr ExprInterner::getNumber(ASTArena& arena, double value) {
+    // By bits, 0.0 and -0.0 are different numbers
+    Key key{0, Kind::Number};
+    key.value = std::bit_cast<uint64_t>(value);
+    key.hash = combine(combine(0, static_cast<uint64_t>(key.kind)), key.value);
+    if (Expr* expr = find(key)) {
+        return ExprUPtr(expr);
+    }
+    return record(key, arena.create<NumberExpr>(value));
+}
+
+ExprUPtr ExprInterner::getVariable(ASTArena& arena, Symbol name, SourceOffset loc) {
+    Key key{0, Kind::Variable};
+    key.value = name.getId();
+    key.hash = combine(combine(0, static_cast<uint64_t>(key.kind)), key.value);
+    if (Expr* expr = find(key)) {
+        return ExprUPtr(expr);
+    }
+    auto expr = arena.create<VariableExpr>(name);
+    expr->setSourceLoc(loc);
+    return record(key, std::move(expr));
+}
+
+ExprUPtr ExprInterner::getBinary(ASTArena& arena, char op, ExprUPtr lhs, ExprUPtr rhs, SourceOffset loc) {
+    size_t lhsHash = getStructuralHash(lhs.get());
+    size_t rhsHash = getStructuralHash(rhs.get());
+    if (!isBuiltinArithmetic(op) || !lhsHash || !rhsHash) {
+        auto expr = arena.create<BinaryExpr>(op, std::move(lhs), std::move(rhs));
+        expr->setSourceLoc(loc);
+        return expr;
+    }
+
+    Key key{0, Kind::Binary, op, 0, lhs.get(), rhs.get()};
+    key.hash = combine(combine(combine(combine(0, static_cast<uint64_t>(key.kind)), op), lhsHash), rhsHash);
+    if (Expr* expr = find(key)) {
+        return ExprUPtr(expr);
+    }
+    auto expr = arena.create<BinaryExpr>(op, std::move(lhs), std::move(rhs));
+    expr->setSourceLoc(loc);
+    return record(key, std::move(expr));
+}
+
+Expr* ExprInterner::find(const Key& key) {
+    auto it = nodes.find(key);
+    if (it == nodes.end()) {
+        return nullptr;
+    }
+    ++numShared;
+    return it->second;
+}
+
+ExprUPtr ExprInterner::record(const Key& key, ExprUPtr expr) {
+    // 0 means not interned
+    hashes[expr.get()] = key.hash ? key.hash : 1;
+    nodes.emplace(key, expr.get());
+    return expr;
+}
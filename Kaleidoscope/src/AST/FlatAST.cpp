@@ -0,0 +1,214 @@
+#include "AST/FlatAST.hpp"
+
+#include <cassert>
+#include <utility>
+
+#include "AST/ASTVisitor.hpp"
+
+namespace {
+
+// A node on the way down, and whether its children are pushed already
+using PendingNode = std::pair<Expr*, bool>;
+
+// Pushes the children of a node last first, so they are flattened in order
+class ChildPusher : public ASTVisitor {
+public:
+    explicit ChildPusher(std::vector<PendingNode>& stack) : stack(stack) {}
+
+    void visitNumberExpr(NumberExpr& /*expr*/) override {}
+    void visitVariableExpr(VariableExpr& /*expr*/) override {}
+
+    void visitBinaryExpr(BinaryExpr &expr) override {
+        push(expr.getRHS());
+        push(expr.getLHS());
+    }
+
+    void visitUnaryExpr(UnaryExpr &expr) override {
+        push(expr.getOperand());
+    }
+
+    void visitCallExpr(CallExpr &expr) override {
+        auto args = expr.getArgs();
+        for (size_t i = args.size(); i-- > 0;) {
+            push(args[i]);
+        }
+    }
+
+    void visitIfExpr(IfExpr &expr) override {
+        push(expr.getElse());
+        push(expr.getThen());
+        push(expr.getCond());
+    }
+
+    void visitForExpr(ForExpr &expr) override {
+        push(expr.getBody());
+        push(expr.getStep());
+        push(expr.getEnd());
+        push(expr.getStart());
+    }
+
+    void visitVarExpr(VarExpr &expr) override {
+        push(expr.getBody());
+        auto vars = expr.getVarNames();
+        for (size_t i = vars.size(); i-- > 0;) {
+            push(vars[i].second);
+        }
+    }
+
+    void visitFcnPrototype(FcnPrototype& /*proto*/) override {
+        assert(false && "only expressions are flattened");
+    }
+
+    void visitFcn(Fcn& /*fcn*/) override {
+        assert(false && "only expressions are flattened");
+    }
+
+private:
+    void push(Expr* child) {
+        if (child) {
+            stack.push_back({child, false});
+        }
+    }
+
+    std::vector<PendingNode>& stack;
+};
+
+} // namespace
+
+// Appends a node once its children are flattened, their ids are on top of
+// `ids` in order
+class FlatASTBuilder : public ASTVisitor {
+public:
+    using NodeId = FlatAST::NodeId;
+    using Kind = FlatAST::Kind;
+
+    FlatASTBuilder(FlatAST& ast, std::vector<NodeId>& ids) : ast(ast), ids(ids) {}
+
+    void visitNumberExpr(NumberExpr &expr) override {
+        FlatAST::Payload payload;
+        payload.number = expr.getValue();
+        add(Kind::Number, expr, payload, 0);
+    }
+
+    void visitVariableExpr(VariableExpr &expr) override {
+        FlatAST::Payload payload;
+        payload.symbol = expr.getName().getId();
+        add(Kind::Variable, expr, payload, 0);
+    }
+
+    void visitBinaryExpr(BinaryExpr &expr) override {
+        FlatAST::Payload payload;
+        payload.op = expr.getOp();
+        takeChildren(2);
+        add(Kind::Binary, expr, payload, 2);
+    }
+
+    void visitUnaryExpr(UnaryExpr &expr) override {
+        FlatAST::Payload payload;
+        payload.op = expr.getOp();
+        takeChildren(1);
+        add(Kind::Unary, expr, payload, 1);
+    }
+
+    void visitCallExpr(CallExpr &expr) override {
+        FlatAST::Payload payload;
+        payload.symbol = expr.getCalleeName().getId();
+        takeChildren(expr.getNumArgs());
+        add(Kind::Call, expr, payload, expr.getNumArgs());
+    }
+
+    void visitIfExpr(IfExpr &expr) override {
+        takeChildren(3);
+        add(Kind::If, expr, {}, 3);
+    }
+
+    void visitForExpr(ForExpr &expr) override {
+        FlatAST::Payload payload;
+        payload.symbol = expr.getVarName().getId();
+        if (expr.getStep()) {
+            takeChildren(4);
+        } else {
+            takeChildren(3);
+            ast.operands.insert(ast.operands.end() - 1, FlatAST::NONE);
+        }
+        add(Kind::For, expr, payload, 3 + (expr.getStep() != nullptr));
+    }
+
+    void visitVarExpr(VarExpr &expr) override {
+        FlatAST::Payload payload;
+        payload.varNames = static_cast<uint32_t>(ast.varNames.size());
+
+        auto vars = expr.getVarNames();
+        size_t numPresent = 1; // Body
+        for (auto [name, init] : vars) {
+            ast.varNames.push_back(name);
+            numPresent += init != nullptr;
+        }
+        size_t next = ids.size() - numPresent;
+        for (auto [name, init] : vars) {
+            ast.operands.push_back(init ? ids[next++] : FlatAST::NONE);
+        }
+        ast.operands.push_back(ids[next]);
+        add(Kind::Var, expr, payload, numPresent);
+    }
+
+    void visitFcnPrototype(FcnPrototype& /*proto*/) override {
+        assert(false && "only expressions are flattened");
+    }
+
+    void visitFcn(Fcn& /*fcn*/) override {
+        assert(false && "only expressions are flattened");
+    }
+
+private:
+    // Copies the ids of the last `count` children into the operands
+    void takeChildren(size_t count) {
+        ast.operands.insert(ast.operands.end(), ids.end() - static_cast<ptrdiff_t>(count), ids.end());
+    }
+
+    // Replaces the ids of the node's `numChildren` children with its own
+    void add(Kind kind, const Expr& expr, FlatAST::Payload payload, size_t numChildren) {
+        ids.resize(ids.size() - numChildren);
+        ids.push_back(ast.addNode(kind, expr.getSourceLoc(), payload));
+    }
+
+    FlatAST& ast;
+    std::vector<NodeId>& ids;
+};
+
+FlatAST::NodeId FlatAST::append(Expr& root) {
+    std::vector<PendingNode> stack{{&root, false}};
+    std::vector<NodeId> ids;
+    ChildPusher pusher(stack);
+    FlatASTBuilder builder(*this, ids);
+    while (!stack.empty()) {
+        auto [expr, expanded] = stack.back();
+        if (expanded) {
+            stack.pop_back();
+            expr->accept(builder);
+        } else {
+            stack.back().second = true;
+            expr->accept(pusher);
+        }
+    }
+    assert(ids.size() == 1);
+    return ids.back();
+}
+
+void FlatAST::clear() {
+    kinds.clear();
+    locs.clear();
+    payloads.clear();
+    operandBegin.assign(1, 0);
+    operands.clear();
+    varNames.clear();
+}
+
+FlatAST::NodeId FlatAST::addNode(Kind kind, SourceOffset loc, Payload payload) {
+    // The operands were appended already
+    kinds.push_back(kind);
+    locs.push_back(loc);
+    payloads.push_back(payload);
+    operandBegin.push_back(static_cast<uint32_t>(operands.size()));
+    return static_cast<NodeId>(kinds.size() - 1);
+}
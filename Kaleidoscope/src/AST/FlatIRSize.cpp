@@ -0,0 +1,89 @@
+#include "AST/FlatIRSize.hpp"
+
+FlatIRSize::FlatIRSize(const FlatAST& ast) : ast(ast) {
+    sizes.reserve(ast.size());
+    constants.reserve(ast.size());
+    ast.walk(*this);
+}
+
+void FlatIRSize::visitNumber(FlatAST::NodeId /*id*/) {
+    add(0, true);
+}
+
+void FlatIRSize::visitVariable(FlatAST::NodeId /*id*/) {
+    add(1, false); // load
+}
+
+void FlatIRSize::visitBinary(FlatAST::NodeId id) {
+    auto operands = ast.getOperands(id);
+    FlatAST::NodeId lhs = operands[0];
+    FlatAST::NodeId rhs = operands[1];
+
+    // The destination is not loaded, only the value is stored
+    if (ast.getOp(id) == '=') {
+        add(sizes[rhs] + 1, constants[rhs]);
+        return;
+    }
+
+    uint32_t size = sizes[lhs] + sizes[rhs];
+    bool constant = constants[lhs] && constants[rhs];
+    switch (ast.getOp(id)) {
+        case '+':
+        case '-':
+        case '*':
+            add(size + (constant ? 0 : 1), constant);
+            return;
+        case '<':
+            add(size + (constant ? 0 : 2), constant); // fcmp, uitofp
+            return;
+        default:
+            add(size + 1, false); // call to the operator
+            return;
+    }
+}
+
+void FlatIRSize::visitUnary(FlatAST::NodeId id) {
+    add(sizes[ast.getOperands(id)[0]] + 1, false); // call to the operator
+}
+
+void FlatIRSize::visitCall(FlatAST::NodeId id) {
+    uint32_t size = 1;
+    for (FlatAST::NodeId arg : ast.getOperands(id)) {
+        size += sizes[arg];
+    }
+    add(size, false);
+}
+
+void FlatIRSize::visitIf(FlatAST::NodeId id) {
+    auto operands = ast.getOperands(id);
+    FlatAST::NodeId cond = operands[0];
+
+    // fcmp, br, br, br, phi
+    uint32_t size = sizes[cond] + (constants[cond] ? 0 : 1) + 1;
+    size += sizes[operands[1]] + 1;
+    size += sizes[operands[2]] + 1;
+    add(size + 1, false);
+}
+
+void FlatIRSize::visitFor(FlatAST::NodeId id) {
+    auto operands = ast.getOperands(id);
+    FlatAST::NodeId end = operands[1];
+
+    // alloca, store, br into the loop, then load, fadd, store, fcmp, br
+    // after the body
+    uint32_t size = 1 + sizes[operands[0]] + 2;
+    size += sizes[operands[3]] + sizeOf(operands[2]) + sizes[end];
+    size += 3 + (constants[end] ? 0 : 1) + 1;
+    add(size, true); // Always 0.0
+}
+
+void FlatIRSize::visitVar(FlatAST::NodeId id) {
+    auto operands = ast.getOperands(id);
+    FlatAST::NodeId body = operands.back();
+
+    uint32_t size = sizes[body];
+    for (FlatAST::NodeId init : operands.first(operands.size() - 1)) {
+        size += sizeOf(init) + 1; // alloca
+    }
+    add(size, constants[body]);
+}
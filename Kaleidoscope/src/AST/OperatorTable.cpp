@@ -0,0 +1,28 @@
+#include "AST/OperatorTable.hpp"
+
+#include <initializer_list>
+
+OperatorTable::OperatorTable() {
+    setBinaryOperator('=', 2, Associativity::Right);
+    setBinaryOperator('<', 10);
+    setBinaryOperator('+', 20);
+    setBinaryOperator('-', 20);
+    setBinaryOperator('*', 40);
+}
+
+const OperatorTable& OperatorTable::builtins() {
+    static const OperatorTable table;
+    return table;
+}
+
+uint64_t OperatorTable::getFingerprint() const {
+    // FNV-1a, the table is small and this runs once per top-level item
+    uint64_t hash = 0xcbf29ce484222325;
+    for (const Entry& entry : entries) {
+        for (uint8_t byte : {static_cast<uint8_t>(entry.precedence), static_cast<uint8_t>(entry.associativity),
+                             static_cast<uint8_t>(entry.unary)}) {
+            hash = (hash ^ byte) * 0x100000001b3;
+        }
+    }
+    return hash;
+}
@@ -1,9 +0,0 @@
-#include "AST/Precedence.hpp"
-
-std::unordered_map<char, int> BIN_OP_PRECEDENCE = {
-    {'=', 2},
-    {'<', 10},
-    {'+', 20},
-    {'-', 20},
-    {'*', 40}
-};
\ No newline at end of file
@@ -4,12 +4,12 @@
 
 std::unique_ptr<PrototypeRegistry> PrototypeRegistry::instance = nullptr;
 
-void PrototypeRegistry::addFcnPrototype(const std::string& name, std::unique_ptr<FcnPrototype> fcnProto) {
+void PrototypeRegistry::addFcnPrototype(Symbol name, std::unique_ptr<FcnPrototype> fcnProto) {
     get()->fcnPrototypes[name] = std::move(fcnProto);
 }
 
-llvm::Function* PrototypeRegistry::getFunction(const std::string& name, CodegenVisitor& visitor) {
-    if (auto *fcn = get()->module->getFunction(name)) {
+llvm::Function* PrototypeRegistry::getFunction(Symbol name, CodegenVisitor& visitor) {
+    if (auto *fcn = get()->module->getFunction(name.str())) {
         return fcn;
     }
 
@@ -19,7 +19,7 @@ llvm::Function* PrototypeRegistry::getFunction(const std::string& name, CodegenV
     return nullptr;
 }
 
-FcnPrototype* PrototypeRegistry::getFcnPrototype(const std::string& name) {
+FcnPrototype* PrototypeRegistry::getFcnPrototype(Symbol name) {
     auto fcnProtoIt = fcnPrototypes.find(name);
     if (fcnProtoIt != fcnPrototypes.end()) {
         return fcnProtoIt->second.get();
@@ -0,0 +1,35 @@
+#include "AST/Symbol.hpp"
+
+#include <mutex>
+
+std::unique_ptr<SymbolTable> SymbolTable::instance = nullptr;
+
+SymbolTable::SymbolTable() {
+    // Reserve id 0 for the empty string
+    strings.push_back(std::string_view());
+}
+
+Symbol SymbolTable::intern(std::string_view str) {
+    if (str.empty()) {
+        return Symbol();
+    }
+
+    llvm::StringRef key(str.data(), str.size());
+    {
+        // Almost every identifier has been seen before
+        std::shared_lock lock(mutex);
+        auto it = ids.find(key);
+        if (it != ids.end()) {
+            return Symbol(it->second);
+        }
+    }
+
+    std::unique_lock lock(mutex);
+    auto [it, inserted] = ids.try_emplace(key, static_cast<uint32_t>(strings.size()));
+    if (inserted) {
+        // StringMap entries never move, so the key can back the view
+        strings.push_back(std::string_view(it->getKeyData(), it->getKeyLength()));
+        stringBytes += str.size();
+    }
+    return Symbol(it->second);
+}
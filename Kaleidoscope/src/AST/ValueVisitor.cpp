@@ -3,7 +3,7 @@
 
 #include "AST/Expr.hpp"
 #include "AST/Fcn.hpp"
-#include "AST/Precedence.hpp"
+#include "AST/OperatorTable.hpp"
 #include "AST/PrototypeRegistry.hpp"
 #include "AST/ValueVisitor.hpp"
 #include "debug/DebugInfo.hpp"
@@ -17,20 +17,20 @@ llvm::Value* CodegenVisitor::visitNumberExpr(NumberExpr &expr) {
 llvm::Value* CodegenVisitor::visitVariableExpr(VariableExpr &expr) {
     llvm::AllocaInst* allocaInst = namedValues[expr.getName()];
     if (!allocaInst) {
-        return logError("Variable '" + expr.getName() + "' is unknown");
+        return logError("Variable '" + std::string(expr.getName().str()) + "' is unknown");
     }
     return builder->CreateLoad(allocaInst->getAllocatedType(), allocaInst,
-                                expr.getName());
+                                expr.getName().str());
 }
 
 llvm::Value* CodegenVisitor::visitBinaryExpr(BinaryExpr &expr) {
     // Assignments are a special case since the LHS ins't an expression
     if (expr.getOp() == '=') {
-        VariableExpr* lhse = dynamic_cast<VariableExpr*>(expr.getLHS());
+        auto* lhse = llvm::dyn_cast<VariableExpr>(expr.getLHS());
         if (!lhse) {
             return logError("Destination of '=' must be a variable");
         }
-        auto val = expr.getRHS()->accept(*this);
+        auto val = visit(*expr.getRHS());
         if (!val) {
             return nullptr;
         }
@@ -44,8 +44,8 @@ llvm::Value* CodegenVisitor::visitBinaryExpr(BinaryExpr &expr) {
         return val;
     }
     // Handle code generation for BinaryExpr
-    auto lhs = expr.getLHS()->accept(*this);
-    auto rhs = expr.getRHS()->accept(*this);
+    auto lhs = visit(*expr.getLHS());
+    auto rhs = visit(*expr.getRHS());
     if (!lhs || !rhs) { // base case of recursion
         return nullptr;
     }
@@ -77,13 +77,18 @@ llvm::Value* CodegenVisitor::visitBinaryExpr(BinaryExpr &expr) {
 }
 
 llvm::Value* CodegenVisitor::visitUnaryExpr(UnaryExpr &expr) {
-    llvm::Value* operand = expr.getOperand()->accept(*this);
+    llvm::Value* operand = visit(*expr.getOperand());
     if (!operand) {
         return nullptr;
     }
 
-    llvm::Function* f = PrototypeRegistry::getFunction(std::string("unary") + expr.getOp(), *this);
-    assert(f && "unary operator not found!");
+    llvm::Function* f = nullptr;
+    if (operators.isUnaryOperator(expr.getOp())) {
+        f = PrototypeRegistry::getFunction(std::string("unary") + expr.getOp(), *this);
+    }
+    if (!f) {
+        return logError(std::string("Unknown unary operator: ") + expr.getOp());
+    }
 
     return builder->CreateCall(f, operand, "unop");
 }
@@ -91,16 +96,18 @@ llvm::Value* CodegenVisitor::visitUnaryExpr(UnaryExpr &expr) {
 llvm::Value* CodegenVisitor::visitCallExpr(CallExpr &expr) {
     llvm::Function* callee = PrototypeRegistry::getFunction(expr.getCalleeName(), *this);
     if (!callee) {
-        return logError("Unknown function called: " + expr.getCalleeName());
+        return logError("Unknown function called: " + std::string(expr.getCalleeName().str()));
     }
 
     if (callee->arg_size() != expr.getNumArgs()) {
-        return logError("Incorrect number of arguments passed to function: " + expr.getCalleeName());
+        return logError("Incorrect number of arguments passed to function: " 
+                            + std::string(expr.getCalleeName().str()));
     }
 
     std::vector<llvm::Value*> args;
-    for (const auto &arg : expr.getArgs()) {
-        args.push_back(arg->accept(*this));
+    args.reserve(expr.getNumArgs());
+    for (Expr* arg : expr.getArgs()) {
+        args.push_back(visit(*arg));
         if (!args.back()) {
             return nullptr;
         }
@@ -110,7 +117,7 @@ llvm::Value* CodegenVisitor::visitCallExpr(CallExpr &expr) {
 }
 
 llvm::Value* CodegenVisitor::visitIfExpr(IfExpr &expr) {
-    llvm::Value* condValue = expr.getCond()->accept(*this);
+    llvm::Value* condValue = visit(*expr.getCond());
     if (!condValue) {
         return nullptr;
     }
@@ -128,7 +135,7 @@ llvm::Value* CodegenVisitor::visitIfExpr(IfExpr &expr) {
     builder->CreateCondBr(condValue, thenBB, elseBB);
 
     builder->SetInsertPoint(thenBB);
-    llvm::Value* thenValue = expr.getThen()->accept(*this);
+    llvm::Value* thenValue = visit(*expr.getThen());
     if (!thenValue) {
         return nullptr;
     }
@@ -140,7 +147,7 @@ llvm::Value* CodegenVisitor::visitIfExpr(IfExpr &expr) {
     // Add the else block to the function
     function->insert(function->end(), elseBB);
     builder->SetInsertPoint(elseBB);
-    llvm::Value* elseValue = expr.getElse()->accept(*this);
+    llvm::Value* elseValue = visit(*expr.getElse());
     if (!elseValue) {
         return nullptr;
     }
@@ -164,10 +171,10 @@ llvm::Value* CodegenVisitor::visitForExpr(ForExpr &expr) {
 
     // Create an alloca for the variable in the entry block
     llvm::AllocaInst* allocaInst = createEntryBlockAlloca(function,
-                                    expr.getVarName());
+                                    expr.getVarName().str());
 
     // Emit the start code, variable is not in scope
-    llvm::Value* startVal = expr.getStart()->accept(*this);
+    llvm::Value* startVal = visit(*expr.getStart());
     if (!startVal) {
         return nullptr;
     }
@@ -188,14 +195,14 @@ llvm::Value* CodegenVisitor::visitForExpr(ForExpr &expr) {
     setNamedValue(expr.getVarName(), allocaInst);
 
     // Emit the body, ignoring the computed value but not allowing an error
-    if (!expr.getBody()->accept(*this)) {
+    if (!visit(*expr.getBody())) {
         return nullptr;
     }
 
     // Emit the step value, with 1.0 as the default
     llvm::Value* stepVal = nullptr;
     if (expr.getStep()) {
-        stepVal = expr.getStep()->accept(*this);
+        stepVal = visit(*expr.getStep());
         if (!stepVal) {
             return nullptr;
         }
@@ -204,7 +211,7 @@ llvm::Value* CodegenVisitor::visitForExpr(ForExpr &expr) {
     }
 
     // Compute the end condition
-    llvm::Value* endCond = expr.getEnd()->accept(*this);
+    llvm::Value* endCond = visit(*expr.getEnd());
     if (!endCond) {
         return nullptr;
     }
@@ -212,7 +219,7 @@ llvm::Value* CodegenVisitor::visitForExpr(ForExpr &expr) {
     // Reload, increment, and restore the alloca. This handles the case where the body
     // of the loop mutates the variable.
     llvm::Value* curVar = builder->CreateLoad(allocaInst->getAllocatedType(),
-                                allocaInst, expr.getVarName());
+                                allocaInst, expr.getVarName().str());
     llvm::Value* nextVar = builder->CreateFAdd(curVar, stepVal, "nextvar");
     builder->CreateStore(nextVar, allocaInst);
     
@@ -245,12 +252,18 @@ llvm::Value* CodegenVisitor::visitFcnPrototype(FcnPrototype &proto) {
     // Create a function prototype in LLVM IR
     std::vector<llvm::Type*> argTypes(proto.getArgs().size(), llvm::Type::getDoubleTy(*context));
     llvm::FunctionType* fType = llvm::FunctionType::get(llvm::Type::getDoubleTy(*context), argTypes, false);
-    llvm::Function* function = llvm::Function::Create(fType, llvm::Function::ExternalLinkage, proto.getName(), module);
+    llvm::Function* function = llvm::Function::Create(fType, llvm::Function::ExternalLinkage, 
+                                                        proto.getName().str(), module);
     
     // Set argument names
     unsigned idx = 0;
     for (auto &arg : function->args()) {
-        arg.setName(proto.getArgs()[idx++]);
+        arg.setName(proto.getArgs()[idx++].str());
+    }
+
+    // Declaring one is enough to use it, like any other function
+    if (proto.isUnaryOp()) {
+        operators.setUnaryOperator(proto.getOperatorName());
     }
     
     return function;
@@ -259,6 +272,14 @@ llvm::Value* CodegenVisitor::visitFcnPrototype(FcnPrototype &proto) {
 llvm::Value* CodegenVisitor::visitFcn(Fcn &fcn) {
     auto protoName = fcn.getName();
     auto &p = *fcn.getPrototype();
+
+    // Put back if the body fails, a failed redefinition of an operator
+    // leaves the previous one in place
+    char opName = p.isUnaryOp() || p.isBinaryOp() ? p.getOperatorName() : 0;
+    int previousPrec = operators.getPrecedence(opName);
+    bool rightAssoc = operators.isRightAssociative(opName);
+    bool wasUnary = operators.isUnaryOperator(opName);
+
     PrototypeRegistry::addFcnPrototype(protoName, std::move(fcn.releasePrototype()));
     llvm::Function* function = PrototypeRegistry::getFunction(protoName, *this);
 
@@ -267,7 +288,7 @@ llvm::Value* CodegenVisitor::visitFcn(Fcn &fcn) {
     }
 
     if (p.isBinaryOp()) {
-        BIN_OP_PRECEDENCE[p.getOperatorName()] = p.getBinaryPrecedence();
+        operators.setBinaryOperator(opName, p.getBinaryPrecedence());
     }
 
     // Create a new basic block for the function body
@@ -284,10 +305,10 @@ llvm::Value* CodegenVisitor::visitFcn(Fcn &fcn) {
                                             KSDbgInfo.TheCU->getDirectory());
     
         llvm::DIScope* FContext = unit;
-        lineNo = p.getLine();
+        lineNo = KSDbgInfo.getLocation(&p).Line;
         scopeLine = lineNo;
         sp = DBuilder->createFunction(
-            FContext, p.getName(), llvm::StringRef(), unit, lineNo, 
+            FContext, p.getName().str(), llvm::StringRef(), unit, lineNo, 
             createFunctionType(function->arg_size()), scopeLine,
                 llvm::DINode::FlagPrototyped, llvm::DISubprogram::SPFlagDefinition);
         function->setSubprogram(sp);
@@ -323,14 +344,14 @@ llvm::Value* CodegenVisitor::visitFcn(Fcn &fcn) {
         builder->CreateStore(&arg, argAllocaInst);
 
         // Map the argument names to their corresponding LLVM values
-        setNamedValue(arg.getName().str(), argAllocaInst);
+        setNamedValue(p.getArgs()[arg.getArgNo()], argAllocaInst);
     }
 
     if (DBuilder) {
         KSDbgInfo.emitLocation(builder, fcn.getBody());
     }
 
-    if (auto retVal = fcn.getBody()->accept(*this)) {
+    if (auto retVal = visit(*fcn.getBody())) {
         // If the function body returns a value, create a return instruction
         builder->CreateRet(retVal);
 
@@ -351,7 +372,14 @@ llvm::Value* CodegenVisitor::visitFcn(Fcn &fcn) {
 
     function->eraseFromParent(); // If the body is invalid, remove the function
     if (p.isBinaryOp()) {
-        BIN_OP_PRECEDENCE.erase(p.getOperatorName());
+        if (previousPrec < 0) {
+            operators.removeBinaryOperator(opName);
+        } else {
+            operators.setBinaryOperator(opName, previousPrec,
+                rightAssoc ? Associativity::Right : Associativity::Left);
+        }
+    } else if (p.isUnaryOp()) {
+        operators.setUnaryOperator(opName, wasUnary);
     }
 
     if (DBuilder) {
@@ -364,13 +392,15 @@ llvm::Value* CodegenVisitor::visitFcn(Fcn &fcn) {
 }
 
 llvm::Value* CodegenVisitor::visitVarExpr(VarExpr &expr) {
+    auto vars = expr.getVarNames();
     std::vector<llvm::AllocaInst*> oldBindings;
+    oldBindings.reserve(vars.size());
 
     llvm::Function* function = builder->GetInsertBlock()->getParent();
 
     // Register all vars and emit their initializer
-    for (const auto& var : expr.getVarNames()) {
-        const std::string& varName = var.first;
+    for (const auto& var : vars) {
+        Symbol varName = var.first;
         Expr* init = var.second;
 
         // Emit the initalizer before adding the variable to scope to
@@ -380,7 +410,7 @@ llvm::Value* CodegenVisitor::visitVarExpr(VarExpr &expr) {
         //  var a = a in ... # refers to outer 'a'
         llvm::Value* initVal;
         if (init) {
-            initVal = init->accept(*this);
+            initVal = visit(*init);
             if (!initVal) {
                 return nullptr;
             }
@@ -390,15 +420,16 @@ llvm::Value* CodegenVisitor::visitVarExpr(VarExpr &expr) {
                                             llvm::APFloat(0.0));
         }
 
-        llvm::AllocaInst* allocaInst = createEntryBlockAlloca(function, varName);
+        llvm::AllocaInst* allocaInst = createEntryBlockAlloca(function, varName.str());
 
         oldBindings.push_back(namedValues[varName]);
         setNamedValue(varName, allocaInst);
     }
 
-    llvm::Value* bodyVal = expr.getBody()->accept(*this);
-    for (int i = 0; i < expr.getVarNames().size(); ++i) {
-        setNamedValue(expr.getVarNames()[i].first, oldBindings[i]);
+    llvm::Value* bodyVal = visit(*expr.getBody());
+    // Last one first, a name bound twice gets its outer binding back
+    for (size_t i = oldBindings.size(); i-- > 0;) {
+        setNamedValue(vars[i].first, oldBindings[i]);
     }
 
     return bodyVal;
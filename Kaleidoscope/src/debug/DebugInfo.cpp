@@ -14,12 +14,20 @@ void DebugInfo::emitLocation(llvm::IRBuilder<>* builder, Expr* expr) {
         scope = TheCU;
     } else {
         scope = LexicalBlocks.back();
+        SourceLocation loc = getLocation(expr);
         builder->SetCurrentDebugLocation(
-            llvm::DILocation::get(scope->getContext(), expr->getLine(),
-            expr->getCol(), scope));
+            llvm::DILocation::get(scope->getContext(), loc.Line,
+            loc.Col, scope));
     }
 }
 
+SourceLocation DebugInfo::getLocation(const ASTNode* node) const {
+    if (!Sources) {
+        return SourceLocation();
+    }
+    return Sources->getLocation(node->getSourceLoc());
+}
+
 llvm::DIType *DebugInfo::getDoubleTy() {
     if (DblTy)
         return DblTy;
@@ -0,0 +1,30 @@
+#include "debug/SourceManager.hpp"
+
+#include <algorithm>
+
+#include "frontend/Scanner.hpp"
+
+void SourceManager::buildLineIndex() const {
+    if (!lineStarts.empty()) {
+        return;
+    }
+
+    const char* begin = source.data();
+    const char* end = begin + source.size();
+    lineStarts.push_back(0);
+    for (const char* p = lang::scan::findEndOfLine(begin, end); p != end; 
+            p = lang::scan::findEndOfLine(p, end)) {
+        if (*p++ == '\r' && p != end && *p == '\n') {
+            ++p;
+        }
+        lineStarts.push_back(static_cast<SourceOffset>(p - begin));
+    }
+}
+
+SourceLocation SourceManager::getLocation(SourceOffset offset) const {
+    buildLineIndex();
+    offset = std::min<SourceOffset>(offset, source.size());
+    auto it = std::upper_bound(lineStarts.begin(), lineStarts.end(), offset);
+    size_t line = it - lineStarts.begin();
+    return {static_cast<int>(line), static_cast<int>(offset - *(it - 1)) + 1};
+}
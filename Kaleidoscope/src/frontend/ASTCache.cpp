@@ -0,0 +1,190 @@
+#include "frontend/ASTCache.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include "frontend/Keywords.hpp"
+#include "frontend/Scanner.hpp"
+
+namespace lang {
+
+namespace {
+
+// Bump the version whenever the layout of an entry or a node changes
+constexpr std::string_view FILE_MAGIC = "kaleidoscope-ast-cache 2\n";
+
+// Eight bytes per step, sources are hashed in full on every run
+uint64_t hashText(std::string_view text, uint64_t seed) {
+    constexpr uint64_t MUL = 0x9e3779b97f4a7c15;
+    uint64_t hash = seed ^ (text.size() * MUL);
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= text.size(); i += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, text.data() + i, sizeof(word));
+        hash = (hash ^ word) * MUL;
+        hash ^= hash >> 29;
+    }
+    uint64_t tail = 0;
+    if (i < text.size()) {
+        std::memcpy(&tail, text.data() + i, text.size() - i);
+    }
+    hash = (hash ^ tail) * MUL;
+    return hash ^ (hash >> 32);
+}
+
+} // namespace
+
+ASTCache::ASTCache(std::string path) : path(std::move(path)) {
+    std::ifstream file(this->path, std::ios::binary);
+    std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (!std::string_view(contents).starts_with(FILE_MAGIC)) {
+        return;
+    }
+
+    ASTReader reader(std::string_view(contents).substr(FILE_MAGIC.size()), 0);
+    while (!reader.atEnd()) {
+        uint64_t key;
+        std::string_view text, data;
+        if (!reader.readFixed64(key) || !reader.readString(text) || !reader.readString(data)) {
+            entries.clear();
+            return;
+        }
+        Entry& entry = entries[key];
+        entry.text = text;
+        entry.data = data;
+    }
+}
+
+std::vector<std::string_view> ASTCache::splitChunks(std::string_view source) {
+    std::vector<std::string_view> chunks;
+    const char* end = source.data() + source.size();
+    const char* chunkStart = source.data();
+    for (const char* p = chunkStart; p != end;) {
+        p = scan::findEndOfLine(p, end);
+        if (p != end) {
+            ++p;
+        }
+        if (p != end && startsTopLevelItem(std::string_view(p, end - p))) {
+            chunks.emplace_back(chunkStart, p - chunkStart);
+            chunkStart = p;
+        }
+    }
+    if (chunkStart != end) {
+        chunks.emplace_back(chunkStart, end - chunkStart);
+    }
+    return chunks;
+}
+
+uint64_t ASTCache::getKey(std::string_view chunk, const OperatorTable& operators) {
+    return hashText(chunk, operators.getFingerprint());
+}
+
+const std::string* ASTCache::lookup(uint64_t key, std::string_view chunk) {
+    auto it = entries.find(key);
+    if (it == entries.end() || it->second.text != chunk) {
+        return nullptr;
+    }
+    it->second.used = true;
+    return &it->second.data;
+}
+
+void ASTCache::store(uint64_t key, std::string_view chunk, std::string entry) {
+    entries[key] = {std::string(chunk), std::move(entry), true};
+}
+
+bool ASTCache::save() const {
+    std::string contents(FILE_MAGIC);
+    ASTWriter writer(contents, 0);
+    for (const auto& [key, entry] : entries) {
+        if (entry.used) {
+            writer.writeFixed64(key);
+            writer.writeString(entry.text);
+            writer.writeString(entry.data);
+        }
+    }
+
+    // A crash halfway leaves the old file, never a truncated one
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!file.write(contents.data(), static_cast<std::streamsize>(contents.size()))) {
+            return false;
+        }
+    }
+    return std::rename(tmpPath.c_str(), path.c_str()) == 0;
+}
+
+void CacheEntryWriter::addItem(CachedItemKind kind, SourceOffset end, Fcn* fcn, const FcnPrototype* proto) {
+    writer.writeVarint(static_cast<uint64_t>(kind));
+    writer.writeLoc(end);
+    if (fcn) {
+        writer.writeFcn(*fcn);
+    } else if (proto) {
+        writer.writePrototype(*proto);
+    }
+}
+
+void CacheEntryWriter::addOperators(const OperatorTable& operators) {
+    writer.writeFixed64(operators.getFingerprint());
+}
+
+std::string CacheEntryWriter::finish(const std::vector<Diagnostic>& diagnostics) {
+    // Diagnostics first, a reader that stops halfway still needs them
+    std::string entry;
+    ASTWriter head(entry, base);
+    head.writeVarint(diagnostics.size());
+    for (const Diagnostic& diag : diagnostics) {
+        head.writeLoc(diag.loc);
+        head.writeString(diag.message);
+    }
+    entry += items;
+    return entry;
+}
+
+bool CacheEntryReader::readDiagnostics(std::vector<Diagnostic>& diagnostics) {
+    uint64_t count;
+    if (!reader.readVarint(count)) {
+        return false;
+    }
+    for (uint64_t i = 0; i < count; ++i) {
+        Diagnostic diag;
+        std::string_view message;
+        if (!reader.readLoc(diag.loc) || !reader.readString(message)) {
+            return false;
+        }
+        diag.message = message;
+        diagnostics.push_back(std::move(diag));
+    }
+    return true;
+}
+
+bool CacheEntryReader::readItem(Item& item) {
+    uint64_t kind;
+    if (!reader.readVarint(kind) || kind > static_cast<uint64_t>(CachedItemKind::Error)
+            || !reader.readLoc(item.end)) {
+        return false;
+    }
+    item.kind = static_cast<CachedItemKind>(kind);
+    item.fcn.reset();
+    item.proto.reset();
+    switch (item.kind) {
+        case CachedItemKind::Definition:
+        case CachedItemKind::Expression:
+            item.fcn = reader.readFcn();
+            return item.fcn != nullptr;
+        case CachedItemKind::Extern:
+            item.proto = reader.readPrototype();
+            return item.proto != nullptr;
+        case CachedItemKind::Error:
+            return true;
+    }
+    return false;
+}
+
+bool CacheEntryReader::readOperators(uint64_t& fingerprint) {
+    return reader.readFixed64(fingerprint);
+}
+
+} // namespace lang
@@ -0,0 +1,19 @@
+#include "frontend/Diagnostic.hpp"
+
+#include "debug/SourceManager.hpp"
+
+namespace lang {
+
+void printDiagnostics(std::ostream& out, std::string_view filename, const SourceManager& sources,
+                      const std::vector<Diagnostic>& diagnostics) {
+    for (const Diagnostic& diag : diagnostics) {
+        SourceLocation loc = sources.getLocation(diag.loc);
+        out << filename << ":" << loc.Line << ":" << loc.Col << ": error: " << diag.message << "\n";
+    }
+}
+
+void printDiagnostic(std::ostream& out, std::string_view name, const Diagnostic& diag) {
+    out << name << ":" << diag.loc << ": error: " << diag.message << "\n";
+}
+
+} // namespace lang
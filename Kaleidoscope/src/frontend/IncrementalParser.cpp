@@ -0,0 +1,223 @@
+#include "frontend/IncrementalParser.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+
+#include "AST/NodeWalker.hpp"
+#include "frontend/Parser.hpp"
+
+namespace lang {
+
+namespace {
+
+// Same dispatch as Driver::MainLoop. `lexerTaken` counts the lexer
+// diagnostics earlier items took.
+IncrementalParser::Item parseItem(Lexer& lexer, Parser& parser, size_t& lexerTaken) {
+    using ItemKind = IncrementalParser::ItemKind;
+
+    IncrementalParser::Item item;
+    size_t parserTaken = parser.getDiagnostics().size();
+    item.begin = lexer.getCurrentOffset();
+    switch (lexer.getCurrentToken()) {
+        case tok_def:
+            item.kind = ItemKind::Definition;
+            item.fcn = parser.parseDefinition();
+            if (item.fcn) {
+                FcnPrototype* proto = item.fcn->getPrototype();
+                item.name = proto->getName();
+
+                NodeWalker collectCallees([&item](ASTNode& node) {
+                    if (auto* call = llvm::dyn_cast<CallExpr>(&node)) {
+                        item.callees.push_back(call->getCalleeName());
+                    }
+                });
+                item.fcn->getBody()->accept(collectCallees);
+            }
+            break;
+        case tok_extern:
+            item.kind = ItemKind::Extern;
+            item.proto = parser.parseExtern();
+            if (item.proto) {
+                item.name = item.proto->getName();
+            }
+            break;
+        default:
+            item.kind = ItemKind::Expression;
+            item.fcn = parser.parseTopLevelExpr();
+            break;
+    }
+
+    if (!item.fcn && !item.proto) {
+        item.kind = ItemKind::Error;
+        parser.synchronize();
+    }
+    item.end = lexer.getCurrentOffset();
+    item.readEnd = lexer.getReadOffset();
+
+    // The lexer is a token ahead, an error in that token is the next item's
+    const std::vector<Diagnostic>& lexerDiagnostics = lexer.getDiagnostics();
+    for (; lexerTaken < lexerDiagnostics.size() && lexerDiagnostics[lexerTaken].loc < item.end; ++lexerTaken) {
+        item.diagnostics.push_back(lexerDiagnostics[lexerTaken]);
+    }
+    item.diagnostics.insert(item.diagnostics.end(), parser.getDiagnostics().begin() + parserTaken,
+                            parser.getDiagnostics().end());
+    std::stable_sort(item.diagnostics.begin(), item.diagnostics.end(),
+                     [](const Diagnostic& a, const Diagnostic& b) { return a.loc < b.loc; });
+    return item;
+}
+
+// Registers the operator `item` defines like codegen does, a binary one
+// when a definition is compiled and a unary one when it is declared
+bool registerOperator(const IncrementalParser::Item& item, OperatorTable& table) {
+    using ItemKind = IncrementalParser::ItemKind;
+
+    const FcnPrototype* proto = item.kind == ItemKind::Definition ? item.fcn->getPrototype() 
+                              : item.kind == ItemKind::Extern ? item.proto.get() : nullptr;
+    if (!proto) {
+        return false;
+    }
+    if (proto->isBinaryOp() && item.kind == ItemKind::Definition) {
+        table.setBinaryOperator(proto->getOperatorName(), proto->getBinaryPrecedence());
+        return true;
+    }
+    if (proto->isUnaryOp()) {
+        table.setUnaryOperator(proto->getOperatorName());
+        return true;
+    }
+    return false;
+}
+
+} // namespace
+
+std::vector<IncrementalParser::Item*> IncrementalParser::update(std::string newSource) {
+    if (newSource == source) {
+        return {};
+    }
+
+    // The edit replaced old [prefix, oldSize - suffix) with new [prefix, newEditEnd)
+    size_t oldSize = source.size();
+    size_t newSize = newSource.size();
+    size_t prefix = std::mismatch(source.begin(), source.begin() + std::min(oldSize, newSize),
+                                  newSource.begin()).first - source.begin();
+    size_t suffix = 0;
+    while (suffix < std::min(oldSize, newSize) - prefix 
+            && source[oldSize - 1 - suffix] == newSource[newSize - 1 - suffix]) {
+        ++suffix;
+    }
+    size_t newEditEnd = newSize - suffix;
+    int64_t delta = static_cast<int64_t>(newSize) - static_cast<int64_t>(oldSize);
+
+    std::vector<Item> oldItems = std::move(items);
+    items.clear();
+
+    // Keep items for which everything the lexer read lies before the edit.
+    // That includes the token the parser stopped at, an edit right after
+    // it can turn e.g. a `def` that ended an error item into an identifier.
+    size_t next = 0;
+    while (next < oldItems.size() && oldItems[next].readEnd <= prefix) {
+        items.push_back(std::move(oldItems[next++]));
+    }
+    size_t firstReparsed = items.size();
+    SourceOffset restart = items.empty() ? 0 : items.back().end;
+
+    // Operators defined further down, or in items that are gone, must not
+    // be seen, so start from what the kept items define
+    std::shared_ptr<const OperatorTable> snapshot = initialOperators;
+    OperatorTable table = *snapshot;
+    if (!items.empty()) {
+        snapshot = items.back().operators;
+        table = *snapshot;
+        if (registerOperator(items.back(), table)) {
+            snapshot = std::make_shared<const OperatorTable>(table);
+        }
+    }
+
+    source = std::move(newSource);
+    Lexer lexer(std::string_view(source).substr(restart), restart);
+    lexer.advance();
+    Parser parser(lexer, table);
+    size_t lexerTaken = 0;
+
+    while (true) {
+        while (lexer.getCurrentToken() == tok_semicolon) {
+            lexer.advance();
+        }
+        if (lexer.getCurrentToken() == tok_eof) {
+            break;
+        }
+
+        // Lexing from a token start only depends on the text after it. Past
+        // the edit that text is unchanged, so if an old item started at the
+        // same place with the same operators, it and everything after it
+        // would parse the same again.
+        SourceOffset begin = lexer.getCurrentOffset();
+        if (begin >= newEditEnd) {
+            int64_t oldBegin = begin - delta;
+            while (next < oldItems.size() && oldItems[next].begin < oldBegin) {
+                ++next; // Dropped
+            }
+            if (next < oldItems.size() && oldItems[next].begin == oldBegin && *oldItems[next].operators == table) {
+                break;
+            }
+        }
+
+        Item item = parseItem(lexer, parser, lexerTaken);
+        item.operators = snapshot;
+        item.definesOperator = registerOperator(item, table);
+        if (item.definesOperator) {
+            snapshot = std::make_shared<const OperatorTable>(table);
+        }
+        items.push_back(std::move(item));
+    }
+
+    // Back in sync, keep the rest of the old items
+    size_t reparsedEnd = items.size();
+    if (lexer.getCurrentToken() != tok_eof) {
+        NodeWalker shifter([delta](ASTNode& node) {
+            if (node.hasSourceLoc()) {
+                node.setSourceLoc(static_cast<SourceOffset>(node.getSourceLoc() + delta));
+            }
+        });
+        for (; next < oldItems.size(); ++next) {
+            Item& item = oldItems[next];
+            item.begin += delta;
+            item.end += delta;
+            item.readEnd += delta;
+            if (item.fcn) {
+                item.fcn->accept(shifter);
+            }
+            if (item.proto) {
+                item.proto->accept(shifter);
+            }
+            for (Diagnostic& diag : item.diagnostics) {
+                diag.loc += delta;
+            }
+            items.push_back(std::move(item));
+        }
+    }
+
+    // Kept items past the edit leave the table as they found it
+    if (reparsedEnd < items.size()) {
+        table = *items.back().operators;
+        registerOperator(items.back(), table);
+    }
+    operators = table;
+
+    std::vector<Item*> reparsed;
+    for (size_t i = firstReparsed; i < reparsedEnd; ++i) {
+        reparsed.push_back(&items[i]);
+    }
+    return reparsed;
+}
+
+std::vector<Diagnostic> IncrementalParser::getDiagnostics() const {
+    std::vector<Diagnostic> result;
+    for (const Item& item : items) {
+        result.insert(result.end(), item.diagnostics.begin(), item.diagnostics.end());
+    }
+    return result;
+}
+
+} // namespace lang
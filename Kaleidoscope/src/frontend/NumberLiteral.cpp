@@ -0,0 +1,84 @@
+#include "frontend/NumberLiteral.hpp"
+
+#include <charconv>
+#include <system_error>
+
+namespace lang {
+
+const char* parseNumberLiteral(std::string_view text, double& value) {
+    if (text.size() > MAX_NUMBER_LENGTH) {
+        return "numeric literal is too long";
+    }
+
+    bool hex = text.size() >= 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X');
+    bool sawDot = false;
+    bool sawExponent = false;
+    bool mantissaDigits = false;
+    bool exponentDigits = false;
+
+    // Digits of the part currently being scanned, the exponent is always decimal
+    auto isDigit = [&](char c) {
+        return (hex && !sawExponent) ? std::isxdigit((unsigned char)c)
+                                     : std::isdigit((unsigned char)c);
+    };
+    auto isExponentMarker = [&](char c) {
+        return hex ? (c == 'p' || c == 'P') : (c == 'e' || c == 'E');
+    };
+
+    // Separators and the hex prefix are stripped before from_chars
+    char digits[MAX_NUMBER_LENGTH];
+    size_t length = 0;
+
+    for (size_t i = hex ? 2 : 0; i < text.size(); ++i) {
+        char c = text[i];
+        if (c == '_') {
+            if (i == 0 || i + 1 == text.size() || !isDigit(text[i - 1]) || !isDigit(text[i + 1])) {
+                return "digit separator must be between two digits";
+            }
+            continue;
+        }
+
+        if (isDigit(c)) {
+            (sawExponent ? exponentDigits : mantissaDigits) = true;
+        } else if (c == '.' && !sawExponent) {
+            if (sawDot) {
+                return "multiple decimal points in numeric literal";
+            }
+            sawDot = true;
+        } else if (isExponentMarker(c) && !sawExponent) {
+            if (!mantissaDigits) {
+                return "expected digits before the exponent";
+            }
+            sawExponent = true;
+            if (i + 1 < text.size() && (text[i + 1] == '+' || text[i + 1] == '-')) {
+                digits[length++] = c;
+                c = text[++i];
+            }
+        } else {
+            return "invalid character in numeric literal";
+        }
+        digits[length++] = c;
+    }
+
+    if (!mantissaDigits) {
+        return "expected digits in numeric literal";
+    }
+    if (sawExponent && !exponentDigits) {
+        return "expected digits in exponent";
+    }
+    if (hex && sawDot && !sawExponent) {
+        return "hexadecimal floating literal requires an exponent";
+    }
+
+    auto format = hex ? std::chars_format::hex : std::chars_format::general;
+    auto [end, ec] = std::from_chars(digits, digits + length, value, format);
+    if (ec == std::errc::result_out_of_range) {
+        return "numeric literal is out of range";
+    }
+    if (ec != std::errc() || end != digits + length) {
+        return "invalid numeric literal";
+    }
+    return nullptr;
+}
+
+} // namespace lang
@@ -0,0 +1,151 @@
+#include "frontend/ParallelParser.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <future>
+#include <iterator>
+#include <optional>
+
+#include "frontend/Lexer.hpp"
+#include "frontend/Parser.hpp"
+
+namespace lang {
+
+namespace {
+
+// Precedence parsePrototype() gives a `def binary` without a number
+constexpr int DEFAULT_BINARY_PRECEDENCE = 30;
+
+// Segments handed to one thread at a time, so a long run of tiny items
+// does not cost a future each
+constexpr size_t SEGMENTS_PER_TASK = 64;
+
+} // namespace
+
+ParallelParser::ParallelParser(const TokenStream& tokens, const OperatorTable& operators)
+    : tokens(tokens) {
+    tables.push_back(operators);
+
+    size_t last = tokens.size() - 1; // tok_eof
+    for (size_t i = 0; i < last; ++i) {
+        Token tok = tokens.getKind(i);
+        if (segments.empty() || tok == tok_def || tok == tok_extern) {
+            segments.push_back({i, last, tables.size() - 1, false});
+            if (segments.size() > 1) {
+                segments[segments.size() - 2].end = i;
+            }
+        }
+
+        // Mirrors parsePrototype(), later items see the operator even if
+        // the rest of the definition turns out to be malformed
+        if (tok != tok_def || i + 2 >= last || tokens.getKind(i + 1) != tok_binary) {
+            continue;
+        }
+        int op = tokens.getKind(i + 2);
+        if (!isascii(op) || std::isalnum(op)) {
+            continue;
+        }
+        int precedence = DEFAULT_BINARY_PRECEDENCE;
+        if (tokens.getKind(i + 3) == tok_number) {
+            double value = tokens.getNumVal(i + 3);
+            if (value < 1 || value > 100) {
+                continue;
+            }
+            precedence = static_cast<int>(value);
+        }
+        OperatorTable table = tables.back();
+        table.setBinaryOperator(static_cast<char>(op), precedence);
+        tables.push_back(table);
+        segments.back().definesOperator = true;
+    }
+}
+
+std::vector<ParallelParser::Item> ParallelParser::parse(unsigned jobs) {
+    size_t tasks = std::clamp<size_t>(segments.size() / SEGMENTS_PER_TASK, 1, std::max(jobs, 1u));
+
+    std::vector<std::vector<Item>> results(tasks);
+    std::vector<std::vector<Diagnostic>> taskDiagnostics(tasks);
+    auto parseRange = [this, tasks, &results, &taskDiagnostics](size_t task) {
+        size_t first = segments.size() * task / tasks;
+        size_t last = segments.size() * (task + 1) / tasks;
+        for (size_t i = first; i < last; ++i) {
+            parseSegment(segments[i], results[task], taskDiagnostics[task]);
+        }
+    };
+
+    if (tasks == 1) {
+        parseRange(0);
+        diagnostics = std::move(taskDiagnostics[0]);
+        return std::move(results[0]);
+    }
+
+    // Interning is thread-safe, lazily creating the table is not
+    SymbolTable::get();
+
+    std::vector<std::future<void>> futures;
+    for (size_t task = 0; task < tasks; ++task) {
+        futures.push_back(std::async(std::launch::async, parseRange, task));
+    }
+
+    std::vector<Item> items;
+    diagnostics.clear();
+    for (size_t task = 0; task < tasks; ++task) {
+        futures[task].get();
+        std::move(results[task].begin(), results[task].end(), std::back_inserter(items));
+        std::move(taskDiagnostics[task].begin(), taskDiagnostics[task].end(), std::back_inserter(diagnostics));
+    }
+    return items;
+}
+
+// Same dispatch as Driver::MainLoop
+void ParallelParser::parseSegment(const Segment& segment, std::vector<Item>& items, 
+                                  std::vector<Diagnostic>& taskDiagnostics) const {
+    // The body of a `def binary` does not see its own operator yet, the
+    // items after it in the segment do
+    std::optional<OperatorTable> operators;
+    bool inDefinition = segment.definesOperator;
+    if (inDefinition) {
+        operators = tables[segment.operators];
+    }
+    Lexer lexer(tokens, segment.begin, segment.end);
+    Parser parser(lexer, operators ? *operators : tables[segment.operators]);
+    lexer.advance();
+
+    while (lexer.getCurrentToken() != tok_eof) {
+        if (lexer.getCurrentToken() == tok_semicolon) {
+            lexer.advance();
+            continue;
+        }
+
+        Item item;
+        item.begin = lexer.getCurrentOffset();
+        switch (lexer.getCurrentToken()) {
+            case tok_def:
+                item.kind = ItemKind::Definition;
+                item.fcn = parser.parseDefinition();
+                break;
+            case tok_extern:
+                item.kind = ItemKind::Extern;
+                item.proto = parser.parseExtern();
+                break;
+            default:
+                item.kind = ItemKind::Expression;
+                item.fcn = parser.parseTopLevelExpr();
+                break;
+        }
+
+        if (!item.fcn && !item.proto) {
+            item.kind = ItemKind::Error;
+            parser.synchronize();
+        }
+        items.push_back(std::move(item));
+
+        if (inDefinition) {
+            *operators = tables[segment.operators + 1];
+            inDefinition = false;
+        }
+    }
+    taskDiagnostics.insert(taskDiagnostics.end(), parser.getDiagnostics().begin(), parser.getDiagnostics().end());
+}
+
+} // namespace lang
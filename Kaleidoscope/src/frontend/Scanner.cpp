@@ -0,0 +1,219 @@
+#include "frontend/Scanner.hpp"
+
+#include <initializer_list>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define LANG_SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+namespace lang {
+namespace scan {
+
+namespace {
+
+enum class CharClass {
+    Whitespace,
+    LineBreak,
+    Identifier,
+};
+
+template<CharClass C>
+inline bool inClass(unsigned char c) {
+    if constexpr (C == CharClass::Whitespace) {
+        return c == ' ' || (unsigned char)(c - '\t') <= '\r' - '\t';
+    } else if constexpr (C == CharClass::LineBreak) {
+        return c == '\n' || c == '\r';
+    } else {
+        return (unsigned char)(c - '0') <= 9 || (unsigned char)((c | 0x20) - 'a') <= 25;
+    }
+}
+
+// Returns the first character that is (Skip = false) or isn't (Skip = true) in C
+template<CharClass C, bool Skip>
+const char* findScalar(const char* p, const char* end) {
+    while (p != end && inClass<C>(*p) == Skip) {
+        ++p;
+    }
+    return p;
+}
+
+#ifdef LANG_SCAN_X86
+
+// Unsigned "lo <= x <= hi" per byte, SSE2 has no unsigned compare so
+// shift the range down to zero and check min(x - lo, hi - lo) == x - lo
+inline __m128i inRange16(__m128i x, char lo, char hi) {
+    __m128i shifted = _mm_sub_epi8(x, _mm_set1_epi8(lo));
+    __m128i clamped = _mm_min_epu8(shifted, _mm_set1_epi8(hi - lo));
+    return _mm_cmpeq_epi8(shifted, clamped);
+}
+
+template<CharClass C>
+inline unsigned classMask16(const char* p) {
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    __m128i m;
+    if constexpr (C == CharClass::Whitespace) {
+        m = _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8(' ')), inRange16(x, '\t', '\r'));
+    } else if constexpr (C == CharClass::LineBreak) {
+        m = _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8('\n')), 
+                            _mm_cmpeq_epi8(x, _mm_set1_epi8('\r')));
+    } else {
+        __m128i lower = _mm_or_si128(x, _mm_set1_epi8(0x20));
+        m = _mm_or_si128(inRange16(x, '0', '9'), inRange16(lower, 'a', 'z'));
+    }
+    return static_cast<unsigned>(_mm_movemask_epi8(m));
+}
+
+template<CharClass C, bool Skip>
+const char* findSSE2(const char* p, const char* end) {
+    for (; end - p >= 16; p += 16) {
+        unsigned mask = classMask16<C>(p);
+        if (Skip) {
+            mask = ~mask & 0xFFFF;
+        }
+        if (mask) {
+            return p + __builtin_ctz(mask);
+        }
+    }
+    return findScalar<C, Skip>(p, end);
+}
+
+__attribute__((target("avx2")))
+inline __m256i inRange32(__m256i x, char lo, char hi) {
+    __m256i shifted = _mm256_sub_epi8(x, _mm256_set1_epi8(lo));
+    __m256i clamped = _mm256_min_epu8(shifted, _mm256_set1_epi8(hi - lo));
+    return _mm256_cmpeq_epi8(shifted, clamped);
+}
+
+template<CharClass C>
+__attribute__((target("avx2")))
+inline unsigned classMask32(const char* p) {
+    __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    __m256i m;
+    if constexpr (C == CharClass::Whitespace) {
+        m = _mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8(' ')), inRange32(x, '\t', '\r'));
+    } else if constexpr (C == CharClass::LineBreak) {
+        m = _mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8('\n')), 
+                            _mm256_cmpeq_epi8(x, _mm256_set1_epi8('\r')));
+    } else {
+        __m256i lower = _mm256_or_si256(x, _mm256_set1_epi8(0x20));
+        m = _mm256_or_si256(inRange32(x, '0', '9'), inRange32(lower, 'a', 'z'));
+    }
+    return static_cast<unsigned>(_mm256_movemask_epi8(m));
+}
+
+template<CharClass C, bool Skip>
+__attribute__((target("avx2")))
+const char* findAVX2(const char* p, const char* end) {
+    for (; end - p >= 32; p += 32) {
+        unsigned mask = classMask32<C>(p);
+        if (Skip) {
+            mask = ~mask;
+        }
+        if (mask) {
+            return p + __builtin_ctz(mask);
+        }
+    }
+    return findSSE2<C, Skip>(p, end);
+}
+
+#endif // LANG_SCAN_X86
+
+struct ScanTable {
+    Impl impl;
+    const char* (*skipWhitespace)(const char*, const char*);
+    const char* (*findEndOfLine)(const char*, const char*);
+    const char* (*skipIdentifier)(const char*, const char*);
+};
+
+const ScanTable SCALAR_TABLE = {
+    Impl::Scalar,
+    findScalar<CharClass::Whitespace, true>,
+    findScalar<CharClass::LineBreak, false>,
+    findScalar<CharClass::Identifier, true>,
+};
+
+#ifdef LANG_SCAN_X86
+const ScanTable SSE2_TABLE = {
+    Impl::SSE2,
+    findSSE2<CharClass::Whitespace, true>,
+    findSSE2<CharClass::LineBreak, false>,
+    findSSE2<CharClass::Identifier, true>,
+};
+
+const ScanTable AVX2_TABLE = {
+    Impl::AVX2,
+    findAVX2<CharClass::Whitespace, true>,
+    findAVX2<CharClass::LineBreak, false>,
+    findAVX2<CharClass::Identifier, true>,
+};
+#endif
+
+const ScanTable* tableFor(Impl impl) {
+    switch (impl) {
+        case Impl::Scalar:
+            return &SCALAR_TABLE;
+#ifdef LANG_SCAN_X86
+        case Impl::SSE2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("sse2") ? &SSE2_TABLE : nullptr;
+        case Impl::AVX2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2") ? &AVX2_TABLE : nullptr;
+#endif
+        default:
+            return nullptr;
+    }
+}
+
+const ScanTable* chooseTable() {
+    for (Impl impl : {Impl::AVX2, Impl::SSE2}) {
+        if (auto table = tableFor(impl)) {
+            return table;
+        }
+    }
+    return &SCALAR_TABLE;
+}
+
+const ScanTable* activeTable = chooseTable();
+
+} // namespace
+
+const char* skipWhitespace(const char* p, const char* end) {
+    return activeTable->skipWhitespace(p, end);
+}
+
+const char* findEndOfLine(const char* p, const char* end) {
+    return activeTable->findEndOfLine(p, end);
+}
+
+const char* skipIdentifier(const char* p, const char* end) {
+    return activeTable->skipIdentifier(p, end);
+}
+
+Impl getImpl() {
+    return activeTable->impl;
+}
+
+bool setImpl(Impl impl) {
+    if (auto table = tableFor(impl)) {
+        activeTable = table;
+        return true;
+    }
+    return false;
+}
+
+const char* getImplName(Impl impl) {
+    switch (impl) {
+        case Impl::Scalar:
+            return "scalar";
+        case Impl::SSE2:
+            return "sse2";
+        case Impl::AVX2:
+            return "avx2";
+    }
+    return "unknown";
+}
+
+} // namespace scan
+} // namespace lang
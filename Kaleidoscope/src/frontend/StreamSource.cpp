@@ -0,0 +1,98 @@
+#include "frontend/StreamSource.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iterator>
+#include <unistd.h>
+
+namespace lang {
+
+StreamSource::StreamSource(int fd, size_t chunkSize) 
+    : fd(fd), chunkSize(std::max<size_t>(chunkSize, 1)) {}
+
+bool StreamSource::fill(Chunk& chunk) {
+    if (chunk.filled == chunk.capacity) {
+        // A single line filled the whole chunk, make room for the rest of it
+        size_t capacity = chunk.capacity * 2;
+        auto data = std::make_unique<char[]>(capacity);
+        std::memcpy(data.get(), chunk.data.get(), chunk.filled);
+        chunk.data = std::move(data);
+        chunk.capacity = capacity;
+    }
+
+    while (true) {
+        ssize_t n = ::read(fd, chunk.data.get() + chunk.filled, chunk.capacity - chunk.filled);
+        if (n > 0) {
+            chunk.filled += n;
+            return true;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        // End of input, read errors are treated the same way
+        atEof = true;
+        return false;
+    }
+}
+
+std::string_view StreamSource::nextChunk() {
+    if (atEof && (inUse.empty() || inUse.back().filled == inUse.back().size)) {
+        return {};
+    }
+
+    Chunk chunk;
+    if (!freeList.empty()) {
+        chunk = std::move(freeList.back());
+        freeList.pop_back();
+    } else {
+        chunk.data = std::make_unique<char[]>(chunkSize);
+        chunk.capacity = chunkSize;
+    }
+    chunk.size = chunk.filled = 0;
+
+    // Start with whatever the previous chunk read past its last line break
+    if (!inUse.empty()) {
+        Chunk& prev = inUse.back();
+        size_t carry = prev.filled - prev.size;
+        if (carry > chunk.capacity) {
+            chunk.data = std::make_unique<char[]>(carry);
+            chunk.capacity = carry;
+        }
+        std::memcpy(chunk.data.get(), prev.data.get() + prev.size, carry);
+        chunk.filled = carry;
+        prev.filled = prev.size;
+    }
+
+    // Keep reading until there is a complete line to hand out
+    size_t scanned = 0;
+    const char* lastBreak = nullptr;
+    while (true) {
+        for (size_t i = chunk.filled; i > scanned; --i) {
+            char c = chunk.data[i - 1];
+            if (c == '\n' || c == '\r') {
+                lastBreak = chunk.data.get() + i - 1;
+                break;
+            }
+        }
+        scanned = chunk.filled;
+        if (lastBreak || atEof || !fill(chunk)) {
+            break;
+        }
+    }
+
+    chunk.size = lastBreak ? lastBreak - chunk.data.get() + 1 : chunk.filled;
+    std::string_view view(chunk.data.get(), chunk.size);
+    inUse.push_back(std::move(chunk));
+    return view;
+}
+
+void StreamSource::releaseConsumed() {
+    if (inUse.size() <= 1) {
+        return;
+    }
+    std::move(inUse.begin(), inUse.end() - 1, std::back_inserter(freeList));
+    inUse.erase(inUse.begin(), inUse.end() - 1);
+}
+
+} // namespace lang
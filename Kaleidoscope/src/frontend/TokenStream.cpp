@@ -0,0 +1,114 @@
+#include "frontend/TokenStream.hpp"
+
+#include <algorithm>
+#include <future>
+
+#include "frontend/Keywords.hpp"
+#include "frontend/Lexer.hpp"
+#include "frontend/Scanner.hpp"
+
+namespace lang {
+
+namespace {
+
+// How many lines past the split target to look for a def or extern
+constexpr int SPLIT_SEARCH_LINES = 64;
+
+const char* nextLine(const char* p, const char* end) {
+    p = scan::findEndOfLine(p, end);
+    return p == end ? end : p + 1;
+}
+
+// Tokens never span a line break, so any line start is a safe split
+const char* findSplit(const char* target, const char* end) {
+    const char* lineStart = nextLine(target, end);
+    const char* p = lineStart;
+    for (int i = 0; i < SPLIT_SEARCH_LINES && p != end; ++i, p = nextLine(p, end)) {
+        if (startsTopLevelItem(std::string_view(p, end - p))) {
+            return p;
+        }
+    }
+    return lineStart;
+}
+
+} // namespace
+
+TokenStream::TokenStream(Lexer& lexer) {
+    while (true) {
+        Token tok = lexer.advance();
+
+        Payload payload{};
+        if (tok == tok_identifier) {
+            payload.symbol = lexer.getIdentifier().getId();
+        } else if (tok == tok_number) {
+            payload.number = lexer.getNumVal();
+        }
+
+        kinds.push_back(static_cast<int16_t>(tok));
+        offsets.push_back(lexer.getCurrentOffset());
+        payloads.push_back(payload);
+
+        if (tok == tok_eof) {
+            break;
+        }
+    }
+    diagnostics = lexer.getDiagnostics();
+}
+
+TokenStream TokenStream::lexParallel(std::string_view source, unsigned jobs, size_t minChunk) {
+    size_t pieces = std::clamp<size_t>(source.size() / std::max<size_t>(minChunk, 1), 
+                                       1, std::max(jobs, 1u));
+
+    const char* begin = source.data();
+    const char* end = begin + source.size();
+    std::vector<std::string_view> chunks;
+    const char* start = begin;
+    for (size_t i = 1; i < pieces; ++i) {
+        const char* split = findSplit(std::max(start, begin + source.size() * i / pieces), end);
+        if (split == end) {
+            break;
+        }
+        chunks.emplace_back(start, split - start);
+        start = split;
+    }
+    chunks.emplace_back(start, end - start);
+
+    if (chunks.size() == 1) {
+        Lexer lexer(source);
+        return TokenStream(lexer);
+    }
+
+    // Interning is thread-safe, lazily creating the table is not
+    SymbolTable::get();
+
+    std::vector<std::future<TokenStream>> futures;
+    for (std::string_view chunk : chunks) {
+        futures.push_back(std::async(std::launch::async, [chunk] {
+            Lexer lexer(chunk);
+            return TokenStream(lexer);
+        }));
+    }
+
+    TokenStream result;
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        result.append(futures[i].get(), static_cast<SourceOffset>(chunks[i].data() - begin), 
+                      i + 1 == chunks.size());
+    }
+    return result;
+}
+
+void TokenStream::append(const TokenStream& piece, SourceOffset offsetBase, bool last) {
+    size_t count = last ? piece.size() : piece.size() - 1;
+    for (size_t i = 0; i < count; ++i) {
+        kinds.push_back(piece.kinds[i]);
+        offsets.push_back(piece.offsets[i] + offsetBase);
+        payloads.push_back(piece.payloads[i]);
+    }
+
+    for (Diagnostic diag : piece.diagnostics) {
+        diag.loc += offsetBase;
+        diagnostics.push_back(std::move(diag));
+    }
+}
+
+} // namespace lang
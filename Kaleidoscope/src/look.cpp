@@ -1,8 +1,10 @@
-#include <filesystem>
-#include <fstream>  
-
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/TargetSelect.h"
 
+#include <thread>
+#include <unistd.h>
+
+#include "debug/SourceManager.hpp"
 #include "frontend/Driver.hpp"
 
 //===----------------------------------------------------------------------===//
@@ -14,28 +16,143 @@ int main(int argc, char* argv[]) {
     InitializeNativeTargetAsmPrinter();
     InitializeNativeTargetAsmParser();
     
-    bool compileFile = argc >= 2;
-    std::unique_ptr<std::ifstream> fileStream;
-    std::istream* stream = &std::cin;
-    std::filesystem::path filepath;
-    bool interactive = true;
-    if (compileFile) {
-        const char* filename = argv[1];
-        std::cout << "You passed in: " << filename << "\n";
-
-        fileStream = std::make_unique<std::ifstream>(filename);
-        filepath = filename;
-        if (!fileStream) {
-            std::cerr << "Error opening file: " << filename << "\n";
-            return 1;
+    // look [--prelex | --parallel | --lazy | --incremental | --ast-cache <cache>] [--stats] [file]
+    // --prelex lexes the whole file, in parallel, before parsing starts
+    // --parallel also parses all of it, in parallel, before compiling
+    // --lazy prelexes too, and only compiles the definitions that are called
+    // --incremental reads successive versions of a source from stdin, each
+    //   terminated by a form feed, and only compiles what changed
+    // --ast-cache keeps the parsed file in <cache>, and only parses what
+    //   is not in there from an earlier run
+    // --stats prints the size and shape of every item parsed one after the
+    //   other as it is lexed, so it needs a file and rejects the other modes
+    bool prelex = false;
+    bool parallel = false;
+    bool lazy = false;
+    bool incremental = false;
+    const char* astCache = nullptr;
+    bool printStats = false;
+    const char* filename = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::string_view(argv[i]) == "--prelex") {
+            prelex = true;
+        } else if (std::string_view(argv[i]) == "--parallel") {
+            prelex = parallel = true;
+        } else if (std::string_view(argv[i]) == "--lazy") {
+            prelex = lazy = true;
+        } else if (std::string_view(argv[i]) == "--incremental") {
+            incremental = true;
+        } else if (std::string_view(argv[i]) == "--ast-cache" && i + 1 < argc) {
+            astCache = argv[++i];
+        } else if (std::string_view(argv[i]) == "--stats") {
+            printStats = true;
+        } else {
+            filename = argv[i];
         }
-        stream = fileStream.get();
-        interactive = false;
     }
 
-    Driver driver("cool stuff", *stream, interactive);
+    // Those lex up front, parse in parallel, lazily, from a cache or from
+    // stdin, and their totals would be wrong
+    if (printStats && (prelex || incremental || astCache || !filename)) {
+        std::cerr << "--stats needs a file, and does not work with --prelex, --parallel, "
+                     "--lazy, --incremental or --ast-cache\n";
+        return 1;
+    }
+
+    if (incremental) {
+        Driver driver("cool stuff", false);
+        driver.initilizeModuleAndManagers();
+        std::string source;
+        std::vector<Diagnostic> diagnostics;
+        while (std::getline(std::cin, source, '\f')) {
+            driver.update(std::move(source));
+            diagnostics = driver.getDiagnostics();
+            SourceManager sources(driver.getIncrementalSource());
+            printDiagnostics(std::cerr, "<stdin>", sources, diagnostics);
+        }
+        // Whether the last version is free of errors
+        return diagnostics.empty() ? 0 : 1;
+    }
+
+    bool compileFile = filename != nullptr;
+    if (!compileFile && isatty(STDIN_FILENO)) {
+        // Interactive stdin is the only user of the stream backend. Errors
+        // are shown after the item they are in.
+        Driver driver("cool stuff", std::cin, true);
+        driver.initilizeModuleAndManagers();
+        size_t numErrors = 0;
+        driver.setDiagnosticHandler([&numErrors](const Diagnostic& diag) {
+            printDiagnostic(std::cerr, "<stdin>", diag);
+            ++numErrors;
+        });
+        driver.MainLoop();
+        return numErrors == 0 ? 0 : 1;
+    }
+
+    if (!compileFile) {
+        // Piped stdin can be arbitrarily long, lex it in bounded memory and
+        // report errors as they come instead of keeping them
+        StreamSource source(STDIN_FILENO);
+        Driver driver("cool stuff", source, true);
+        driver.initilizeModuleAndManagers();
+        size_t numErrors = 0;
+        driver.setDiagnosticHandler([&numErrors](const Diagnostic& diag) {
+            printDiagnostic(std::cerr, "<stdin>", diag);
+            ++numErrors;
+        });
+        driver.MainLoop();
+        return numErrors == 0 ? 0 : 1;
+    }
+
+    std::cout << "You passed in: " << filename << "\n";
+
+    // Memory maps the file when it is large enough to be worth it
+    auto fileBuffer = MemoryBuffer::getFile(filename);
+    if (!fileBuffer) {
+        std::cerr << "Error opening file: " << filename << "\n";
+        return 1;
+    }
+
+    SourceManager sources(std::move(*fileBuffer));
+    if (astCache) {
+        ASTCache cache(astCache);
+        Driver driver("cool stuff", false);
+        driver.initilizeModuleAndManagers();
+        driver.CachedMainLoop(sources.getSource(), cache);
+        if (!cache.save()) {
+            std::cerr << "Error writing AST cache: " << astCache << "\n";
+        }
+        std::vector<Diagnostic> diagnostics = driver.getDiagnostics();
+        printDiagnostics(std::cerr, filename, sources, diagnostics);
+        return diagnostics.empty() ? 0 : 1;
+    }
+
+    if (prelex) {
+        unsigned jobs = std::thread::hardware_concurrency();
+        auto tokens = TokenStream::lexParallel(sources.getSource(), jobs);
+        Driver driver("cool stuff", tokens, false);
+        driver.initilizeModuleAndManagers();
+        driver.setLazyDefinitions(lazy);
+        if (parallel) {
+            driver.ParallelMainLoop(jobs);
+        } else {
+            driver.MainLoop();
+        }
+        std::vector<Diagnostic> diagnostics = driver.getDiagnostics();
+        printDiagnostics(std::cerr, filename, sources, diagnostics);
+        return diagnostics.empty() ? 0 : 1;
+    }
+
+    ASTStats stats;
+    Driver driver("cool stuff", sources.getSource(), false);
     driver.initilizeModuleAndManagers();
+    driver.setStats(printStats ? &stats : nullptr);
     driver.MainLoop();
 
-    return 0;
+    std::vector<Diagnostic> diagnostics = driver.getDiagnostics();
+    printDiagnostics(std::cerr, filename, sources, diagnostics);
+    if (printStats) {
+        stats.print(std::cerr, filename, sources);
+    }
+    return diagnostics.empty() ? 0 : 1;
 }
@@ -1,43 +1,65 @@
 
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/TargetSelect.h"
 
 #include "debug/DebugInfo.hpp"
+#include "debug/SourceManager.hpp"
 #include "frontend/Driver.hpp"
 
-#include <fstream>
-
 
 //===----------------------------------------------------------------------===//
 // Main driver code.
 //===----------------------------------------------------------------------===//
 
 int main(int argc, char* argv[]) {
-    if (argc < 2) {
-        std::cerr << "Usage: " << argv[0] << " <filename>\n";
+    // reflect [--stats] <filename>
+    // --stats prints the size and shape of every parsed item
+    bool printStats = false;
+    const char* filename = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::string_view(argv[i]) == "--stats") {
+            printStats = true;
+        } else {
+            filename = argv[i];
+        }
+    }
+    if (!filename) {
+        std::cerr << "Usage: " << argv[0] << " [--stats] <filename>\n";
         return 1;
     }
 
-    const char* filename = argv[1];
     std::cout << "You passed in: " << filename << "\n";
 
     InitializeNativeTarget();
     InitializeNativeTargetAsmPrinter();
     InitializeNativeTargetAsmParser();
 
-    std::ifstream inputFile(filename);
-    if (!inputFile) {
+    // Memory maps the file when it is large enough to be worth it
+    auto fileBuffer = MemoryBuffer::getFile(filename);
+    if (!fileBuffer) {
         std::cerr << "Error opening file: " << filename << "\n";
         return 1;
     }
 
-    Driver driver("cool stuff", inputFile, false, false);
+    SourceManager sources(std::move(*fileBuffer));
+    Driver driver("cool stuff", sources.getSource(), false, false);
     driver.initializeModule();
     DBuilder = std::make_unique<DIBuilder>(*driver.getModule());
     KSDbgInfo.TheCU = DBuilder->createCompileUnit(dwarf::DW_LANG_C,
         DBuilder->createFile(filename, "."), 
         "reflect", false, "", 0);
+    KSDbgInfo.Sources = &sources;
+    ASTStats stats;
+    driver.setStats(printStats ? &stats : nullptr);
     driver.MainLoop();
 
+    // Every error at once, so one bad input costs a single run
+    std::vector<Diagnostic> diagnostics = driver.getDiagnostics();
+    printDiagnostics(std::cerr, filename, sources, diagnostics);
+    if (printStats) {
+        stats.print(std::cerr, filename, sources);
+    }
+
     // Print out all of the generated code.
     std::error_code EC;
     llvm::raw_fd_ostream file("output.ll", EC, llvm::sys::fs::OF_None);
@@ -48,5 +70,5 @@ int main(int argc, char* argv[]) {
     } else {
         driver.getModule()->print(file, nullptr);
     }
-    return 0;
+    return diagnostics.empty() ? 0 : 1;
 }
\ No newline at end of file
@@ -0,0 +1,107 @@
+#include "gtest/gtest.h"
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "AST/ASTArena.hpp"
+#include "AST/Fcn.hpp"
+#include "frontend/Parser.hpp"
+
+using namespace lang;
+
+namespace {
+
+// Records its destruction and whether its child was still alive then
+class TrackedExpr : public NumberExpr {
+    std::vector<int>& destroyed;
+    int id;
+    ExprUPtr child;
+
+public:
+    TrackedExpr(std::vector<int>& destroyed, int id, ExprUPtr child = nullptr)
+        : NumberExpr(id), destroyed(destroyed), id(id), child(std::move(child)) {}
+
+    ~TrackedExpr() override {
+        destroyed.push_back(id);
+    }
+};
+
+} // namespace
+
+TEST(ASTArenaTest, NodesAreMarkedAsArenaAllocated) {
+    ASTArena arena;
+    auto num = arena.create<NumberExpr>(1.0);
+    EXPECT_TRUE(num->isArenaAllocated());
+    EXPECT_EQ(num->getValue(), 1.0);
+
+    auto heap = std::make_unique<NumberExpr>(2.0);
+    EXPECT_FALSE(heap->isArenaAllocated());
+    EXPECT_EQ(arena.getNumNodes(), 1u);
+}
+
+TEST(ASTArenaTest, ArenaDestroysParentsBeforeChildren) {
+    std::vector<int> destroyed;
+    {
+        ASTArena arena;
+        ExprUPtr leaf = arena.create<TrackedExpr>(destroyed, 1);
+        ExprUPtr mid = arena.create<TrackedExpr>(destroyed, 2, std::move(leaf));
+        ExprUPtr root = arena.create<TrackedExpr>(destroyed, 3, std::move(mid));
+
+        // Dropping the owning pointer leaves the node to the arena
+        root.reset();
+        EXPECT_TRUE(destroyed.empty());
+    }
+    EXPECT_EQ(destroyed, (std::vector<int>{3, 2, 1}));
+}
+
+TEST(ASTArenaTest, HeapChildOfArenaNodeIsDeleted) {
+    std::vector<int> destroyed;
+    {
+        ASTArena arena;
+        auto root = arena.create<TrackedExpr>(destroyed, 1, std::make_unique<TrackedExpr>(destroyed, 2));
+    }
+    EXPECT_EQ(destroyed, (std::vector<int>{1, 2}));
+}
+
+TEST(ASTArenaTest, GrowsPastTheInlineSlab) {
+    ASTArena arena;
+    std::vector<ExprUPtr> nodes;
+    for (int i = 0; i < 10000; ++i) {
+        nodes.push_back(arena.create<NumberExpr>(i));
+    }
+    EXPECT_EQ(arena.getNumNodes(), 10000u);
+    EXPECT_GE(arena.getBytesUsed(), 10000 * sizeof(NumberExpr));
+    for (int i = 0; i < 10000; ++i) {
+        ASSERT_EQ(static_cast<NumberExpr*>(nodes[i].get())->getValue(), i);
+    }
+}
+
+TEST(ASTArenaTest, DeepTreeIsDestroyedWithoutRecursion) {
+    ASTArena arena;
+    ExprUPtr expr = arena.create<NumberExpr>(1.0);
+    for (int i = 0; i < 1000000; ++i) {
+        expr = arena.create<UnaryExpr>('!', std::move(expr));
+    }
+    EXPECT_EQ(arena.getNumNodes(), 1000001u);
+}
+
+TEST(ASTArenaTest, ParsedBodiesLiveInTheFcnArena) {
+    std::istringstream input("def f(x) x * (x + 1);");
+    Lexer lexer(input);
+    Parser parser(lexer);
+    lexer.advance();
+
+    auto fcn = parser.parseDefinition();
+    ASSERT_NE(fcn, nullptr);
+    ASSERT_NE(fcn->getArena(), nullptr);
+    EXPECT_EQ(fcn->getArena()->getNumNodes(), 5u);
+    EXPECT_TRUE(fcn->getBody()->isArenaAllocated());
+    EXPECT_EQ(fcn->getBody()->toString(), "(x * (x + 1))");
+}
+
+TEST(ASTArenaTest, HandBuiltFcnHasNoArena) {
+    auto proto = std::make_unique<FcnPrototype>("f", std::vector<Symbol>());
+    Fcn fcn(std::move(proto), std::make_unique<NumberExpr>(1.0));
+    EXPECT_EQ(fcn.getArena(), nullptr);
+    EXPECT_FALSE(fcn.getBody()->isArenaAllocated());
+}
@@ -0,0 +1,88 @@
+#include "gtest/gtest.h"
+
+#include <string>
+
+#include "llvm/Support/raw_ostream.h"
+
+#include "AST/ASTPrinter.hpp"
+#include "frontend/Parser.hpp"
+
+using namespace lang;
+
+namespace {
+
+std::unique_ptr<Fcn> parse(std::string_view source) {
+    Lexer lexer(source);
+    lexer.advance();
+    Parser parser(lexer);
+    return parser.parseTopLevelExpr();
+}
+
+std::string printToString(const Expr& expr, unsigned indentWidth = 0, size_t maxBytes = 0) {
+    std::string out;
+    llvm::raw_string_ostream stream(out);
+    ASTPrinter printer(stream);
+    printer.setIndentWidth(indentWidth);
+    printer.setMaxBytes(maxBytes);
+    printer.print(expr);
+    stream.flush();
+    return out;
+}
+
+} // namespace
+
+TEST(ASTPrinterTest, MatchesToString) {
+    auto fcn = parse("var a = 1, b in for i = 0, i < a, 2 in if f(a, b) then -a else (a + b) * 3");
+    ASSERT_NE(fcn, nullptr);
+    EXPECT_EQ(printToString(*fcn->getBody()), fcn->getBody()->toString());
+    EXPECT_EQ(fcn->getBody()->toString(),
+        "var a = 1, b in\n"
+        "for 0, (i < a), 2\n"
+        "\tif f(a, b) then\n"
+        "\t-a\n"
+        "else\n"
+        "\t((a + b) * 3)");
+}
+
+TEST(ASTPrinterTest, IndentsNestedBlocks) {
+    auto fcn = parse("if x then if y then 1 else 2 else for i = 0, i < 3 in var z = i in z");
+    ASSERT_NE(fcn, nullptr);
+    EXPECT_EQ(printToString(*fcn->getBody(), 2),
+        "if x then\n"
+        "  if y then\n"
+        "    1\n"
+        "  else\n"
+        "    2\n"
+        "else\n"
+        "  for 0, (i < 3)\n"
+        "    var z = i in\n"
+        "    z");
+}
+
+TEST(ASTPrinterTest, CutsOutputAtTheCap) {
+    auto fcn = parse("f(123456, 789)");
+    ASSERT_NE(fcn, nullptr);
+    EXPECT_EQ(printToString(*fcn->getBody(), 0, 5), "f(123...");
+    EXPECT_EQ(printToString(*fcn->getBody(), 0, 14), "f(123456, 789)");
+
+    std::string out;
+    llvm::raw_string_ostream stream(out);
+    ASTPrinter printer(stream);
+    printer.setMaxBytes(16);
+    printer.print(*fcn->getBody());
+    EXPECT_FALSE(printer.isTruncated());
+    printer.print(*fcn->getBody());
+    EXPECT_TRUE(printer.isTruncated());
+    EXPECT_EQ(stream.str(), "f(123456, 789)f(...");
+}
+
+TEST(ASTPrinterTest, PrintsDeepTreesWithoutRecursion) {
+    std::string source = "1";
+    for (int i = 0; i < 200000; ++i) {
+        source += "+1";
+    }
+    auto fcn = parse(source);
+    ASSERT_NE(fcn, nullptr);
+    std::string out = printToString(*fcn->getBody(), 4, 100);
+    EXPECT_EQ(out, std::string(100, '(') + "...");
+}
@@ -0,0 +1,152 @@
+#include "gtest/gtest.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "AST/ASTSerializer.hpp"
+#include "AST/NodeWalker.hpp"
+#include "frontend/Parser.hpp"
+
+using namespace lang;
+
+namespace {
+
+// Every node's location, parents first, -1 for nodes without one
+std::vector<int64_t> collectLocations(Fcn& fcn) {
+    std::vector<int64_t> locs;
+    NodeWalker walker([&locs](ASTNode& node) {
+        locs.push_back(node.hasSourceLoc() ? static_cast<int64_t>(node.getSourceLoc()) : -1);
+    });
+    fcn.accept(walker);
+    return locs;
+}
+
+class ASTSerializerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        operators.setBinaryOperator('|', 5);
+    }
+
+    std::vector<std::unique_ptr<Fcn>> parseDefinitions(std::string_view source) {
+        Lexer lexer(source);
+        Parser parser(lexer, operators);
+        lexer.advance();
+        std::vector<std::unique_ptr<Fcn>> fcns;
+        while (lexer.getCurrentToken() == tok_def) {
+            fcns.push_back(parser.parseDefinition());
+            EXPECT_NE(fcns.back(), nullptr);
+            if (lexer.getCurrentToken() == tok_semicolon) {
+                lexer.advance();
+            }
+        }
+        return fcns;
+    }
+
+    OperatorTable operators;
+};
+
+} // namespace
+
+TEST_F(ASTSerializerTest, RoundTripsEveryExpressionKind) {
+    auto fcns = parseDefinitions(
+        "def binary| 5 (a b) if a then 1 else b;\n"
+        "def f(x) var y = x * 2, z in (for i = 1, i < y, 0.5 in f(i) | !x) + z;\n"
+        "def g() for i = 0, i < 3 in g();\n");
+    ASSERT_EQ(fcns.size(), 3u);
+
+    // The items moved 100 bytes further down their file
+    std::string data;
+    ASTWriter writer(data, 10);
+    for (auto& fcn : fcns) {
+        writer.writeFcn(*fcn);
+    }
+    ASTReader reader(data, 110);
+    for (auto& fcn : fcns) {
+        auto copy = reader.readFcn();
+        ASSERT_NE(copy, nullptr);
+        EXPECT_EQ(copy->getName(), fcn->getName());
+        EXPECT_EQ(copy->getPrototype()->getArgs(), fcn->getPrototype()->getArgs());
+        EXPECT_EQ(copy->getPrototype()->isBinaryOp(), fcn->getPrototype()->isBinaryOp());
+        EXPECT_EQ(copy->getPrototype()->getBinaryPrecedence(), fcn->getPrototype()->getBinaryPrecedence());
+        EXPECT_EQ(copy->getBody()->toString(), fcn->getBody()->toString());
+
+        std::vector<int64_t> expected = collectLocations(*fcn);
+        for (int64_t& loc : expected) {
+            loc = loc < 0 ? loc : loc + 100;
+        }
+        EXPECT_EQ(collectLocations(*copy), expected);
+    }
+    EXPECT_TRUE(reader.atEnd());
+}
+
+TEST_F(ASTSerializerTest, MovesLocationsAtOffsetZero) {
+    // As for a prototype at the very start of a file. The number has no
+    // location at all.
+    auto fcns = parseDefinitions("def f() 1;");
+    ASSERT_EQ(fcns.size(), 1u);
+    fcns[0]->getPrototype()->setSourceLoc(0);
+
+    std::string data;
+    ASTWriter(data, 0).writeFcn(*fcns[0]);
+    auto copy = ASTReader(data, 20).readFcn();
+    ASSERT_NE(copy, nullptr);
+    EXPECT_EQ(copy->getPrototype()->getSourceLoc(), 20u);
+    EXPECT_FALSE(copy->getBody()->hasSourceLoc());
+}
+
+TEST_F(ASTSerializerTest, ReadsBodiesIntoAnArena) {
+    auto fcns = parseDefinitions("def f(x) x + f(x - 1, 2);");
+    std::string data;
+    ASTWriter(data, 0).writeFcn(*fcns[0]);
+
+    auto copy = ASTReader(data, 0).readFcn();
+    ASSERT_NE(copy, nullptr);
+    ASSERT_NE(copy->getArena(), nullptr);
+    EXPECT_EQ(copy->getArena()->getNumNodes(), fcns[0]->getArena()->getNumNodes());
+}
+
+TEST_F(ASTSerializerTest, RoundTripsExternsAndNumbers) {
+    FcnPrototype proto("sin", std::vector<Symbol>{"angle"});
+    proto.setSourceLoc(7);
+    std::string data;
+    ASTWriter writer(data, 0);
+    writer.writePrototype(proto);
+    writer.writeFixed64(0x123456789abcdef0);
+
+    ASTReader reader(data, 0);
+    auto copy = reader.readPrototype();
+    ASSERT_NE(copy, nullptr);
+    EXPECT_EQ(copy->getName(), Symbol("sin"));
+    EXPECT_EQ(copy->getArgs(), std::vector<Symbol>{"angle"});
+    EXPECT_FALSE(copy->isUnaryOp());
+    EXPECT_EQ(copy->getSourceLoc(), 7u);
+    uint64_t value;
+    ASSERT_TRUE(reader.readFixed64(value));
+    EXPECT_EQ(value, 0x123456789abcdef0u);
+}
+
+TEST_F(ASTSerializerTest, RejectsTruncatedInput) {
+    auto fcns = parseDefinitions("def f(x) var y = 1 in if x < y then f(x + 1) else 2.5;");
+    std::string data;
+    ASTWriter(data, 0).writeFcn(*fcns[0]);
+
+    for (size_t size = 0; size < data.size(); ++size) {
+        EXPECT_EQ(ASTReader(std::string_view(data).substr(0, size), 0).readFcn(), nullptr) << size;
+    }
+    EXPECT_NE(ASTReader(data, 0).readFcn(), nullptr);
+}
+
+TEST_F(ASTSerializerTest, RoundTripsDeepTreesWithoutRecursion) {
+    std::string source = "def f() 1";
+    for (int i = 0; i < 200000; ++i) {
+        source += "+1";
+    }
+    auto fcns = parseDefinitions(source);
+    std::string data;
+    ASTWriter(data, 0).writeFcn(*fcns[0]);
+
+    auto copy = ASTReader(data, 0).readFcn();
+    ASSERT_NE(copy, nullptr);
+    EXPECT_EQ(copy->getArena()->getNumNodes(), 400001u);
+}
@@ -0,0 +1,97 @@
+#include "gtest/gtest.h"
+
+#include <sstream>
+#include <string>
+
+#include "AST/ASTStats.hpp"
+#include "debug/SourceManager.hpp"
+#include "frontend/Parser.hpp"
+
+using namespace lang;
+
+TEST(ASTStatsTest, MeasuresOneDefinition) {
+    Lexer lexer(std::string_view("def f(x y) var z = x in g(x, y + z, 1)"));
+    lexer.advance();
+    Parser parser(lexer);
+    auto fcn = parser.parseDefinition();
+    ASSERT_NE(fcn, nullptr);
+
+    ItemStats stats = ASTStats::measure(*fcn);
+    EXPECT_EQ(stats.name, Symbol("f"));
+    EXPECT_EQ(stats.loc, 4u);
+    std::map<std::string, size_t> expected = {
+        {"Binary", 1}, {"Call", 1}, {"Function", 1}, {"FunctionPrototype", 1},
+        {"Number", 1}, {"Var", 1}, {"Variable", 4},
+    };
+    EXPECT_EQ(stats.nodesByType, expected);
+    EXPECT_EQ(stats.numNodes, 10u);
+    // Function, Var, Call, Binary, Variable
+    EXPECT_EQ(stats.maxDepth, 5u);
+    EXPECT_EQ(stats.nodeBytes, sizeof(Fcn) + sizeof(FcnPrototype) + fcn->getArena()->getBytesUsed());
+    EXPECT_EQ(stats.childBytes, 2 * sizeof(Symbol) + 3 * sizeof(ExprUPtr) + sizeof(VarNameVector::value_type));
+}
+
+TEST(ASTStatsTest, CountsHeapNodesAndExterns) {
+    auto body = std::make_unique<BinaryExpr>('+', std::make_unique<NumberExpr>(1),
+                                             std::make_unique<NumberExpr>(2));
+    Fcn fcn(std::make_unique<FcnPrototype>("main", std::vector<Symbol>()), std::move(body));
+    ItemStats stats = ASTStats::measure(fcn);
+    EXPECT_EQ(stats.numNodes, 5u);
+    EXPECT_EQ(stats.nodeBytes, sizeof(Fcn) + sizeof(FcnPrototype) + sizeof(BinaryExpr) + 2 * sizeof(NumberExpr));
+
+    ASTStats collector;
+    collector.beginItem();
+    collector.endItem(FcnPrototype("ASTStatsTest_never_seen_before", std::vector<Symbol>()));
+    ASSERT_EQ(collector.getItems().size(), 1u);
+    const ItemStats& item = collector.getItems()[0];
+    EXPECT_EQ(item.numNodes, 1u);
+    EXPECT_EQ(item.maxDepth, 1u);
+    EXPECT_EQ(item.stringBytes, std::string_view("ASTStatsTest_never_seen_before").size());
+}
+
+TEST(ASTStatsTest, SumsItemsAndPrintsThem) {
+    std::string_view source = "def f(x) x;\n1 + 2;";
+    Lexer lexer(source);
+    lexer.advance();
+    Parser parser(lexer);
+    ASTStats collector;
+
+    collector.beginItem();
+    auto def = parser.parseDefinition();
+    ASSERT_NE(def, nullptr);
+    collector.endItem(*def);
+    lexer.advance();
+    collector.beginItem();
+    auto expr = parser.parseTopLevelExpr();
+    ASSERT_NE(expr, nullptr);
+    collector.endItem(*expr);
+
+    ItemStats total = collector.getTotal();
+    EXPECT_EQ(total.numNodes, 8u);
+    EXPECT_EQ(total.nodesByType["Function"], 2u);
+    EXPECT_EQ(total.maxDepth, 3u);
+    EXPECT_EQ(total.parseTime, collector.getItems()[0].parseTime + collector.getItems()[1].parseTime);
+
+    std::ostringstream out;
+    collector.print(out, "a.ks", SourceManager(source));
+    std::string printed = out.str();
+    EXPECT_EQ(printed.find("a.ks:1:5: f: 3 nodes (Function 1, FunctionPrototype 1, Variable 1), depth 2, "), 0u)
+        << printed;
+    EXPECT_NE(printed.find("\na.ks:2:1: main: 5 nodes"), std::string::npos) << printed;
+    EXPECT_NE(printed.find("\na.ks: 2 items: 8 nodes"), std::string::npos) << printed;
+}
+
+TEST(ASTStatsTest, MeasuresDeepTreesWithoutRecursion) {
+    std::string source = "1";
+    for (int i = 0; i < 200000; ++i) {
+        source += "+1";
+    }
+    Lexer lexer(source);
+    lexer.advance();
+    Parser parser(lexer);
+    auto fcn = parser.parseTopLevelExpr();
+    ASSERT_NE(fcn, nullptr);
+    ItemStats stats = ASTStats::measure(*fcn);
+    EXPECT_EQ(stats.numNodes, 400003u);
+    EXPECT_EQ(stats.maxDepth, 200002u);
+}
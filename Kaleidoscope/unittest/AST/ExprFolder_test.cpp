@@ -0,0 +1,145 @@
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <string>
+
+#include "AST/ExprFolder.hpp"
+#include "frontend/Parser.hpp"
+
+using namespace lang;
+
+namespace {
+
+class ExprFolderTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        operators.setBinaryOperator('|', 5);
+    }
+
+    // The body of `source`, a definition or a top-level expression, after
+    // folding
+    std::string fold(std::string_view source, bool hashConsing = false) {
+        Lexer lexer(source);
+        lexer.advance();
+        Parser parser(lexer, operators);
+        parser.setHashConsing(hashConsing);
+        fcn = lexer.getCurrentToken() == tok_def ? parser.parseDefinition() : parser.parseTopLevelExpr();
+        EXPECT_NE(fcn, nullptr);
+        if (!fcn) {
+            return "";
+        }
+        folder.fold(*fcn);
+        return fcn->getBody()->toString();
+    }
+
+    double foldToNumber(std::string_view source) {
+        fold(source);
+        auto* number = llvm::dyn_cast<NumberExpr>(fcn->getBody());
+        EXPECT_NE(number, nullptr) << fcn->getBody()->toString();
+        return number ? number->getValue() : 0;
+    }
+
+    OperatorTable operators;
+    // f and g take one argument each, nothing else is defined
+    ExprFolder folder{[](Symbol callee, size_t numArgs) {
+        return (callee == Symbol("f") || callee == Symbol("g")) && numArgs == 1;
+    }};
+    std::unique_ptr<Fcn> fcn;
+};
+
+} // namespace
+
+TEST_F(ExprFolderTest, FoldsBuiltinArithmetic) {
+    EXPECT_EQ(fold("2 * 3.5 + x * 1.0"), "(7 + x)");
+    EXPECT_EQ(foldToNumber("(1 + 2) * (10 - 4) - 0.5"), 17.5);
+    EXPECT_EQ(foldToNumber("1 < 2"), 1.0);
+    EXPECT_EQ(foldToNumber("2 < 1"), 0.0);
+    EXPECT_EQ(fcn->getBody()->getSourceLoc(), 2u);
+    EXPECT_EQ(fold("f(1 + 1, var y = 2 * 2 in y - 0)"), "f(2, var y = 4 in\ny)");
+}
+
+TEST_F(ExprFolderTest, MatchesIEEEArithmetic) {
+    double inf = std::numeric_limits<double>::infinity();
+    EXPECT_TRUE(std::isnan(foldToNumber("1e308 * 10 - 1e308 * 10")));
+    EXPECT_EQ(foldToNumber("1e308 * 10"), inf);
+    EXPECT_TRUE(std::signbit(foldToNumber("0 * (0 - 1)")));
+    // Unordered comparisons are true, as with fcmp ult
+    EXPECT_EQ(foldToNumber("(1e308 * 10 - 1e308 * 10) < 1"), 1.0);
+    EXPECT_EQ(foldToNumber("1 < (1e308 * 10 - 1e308 * 10)"), 1.0);
+}
+
+TEST_F(ExprFolderTest, AppliesOnlySafeIdentities) {
+    EXPECT_EQ(fold("x * 1"), "x");
+    EXPECT_EQ(fold("1 * x"), "x");
+    EXPECT_EQ(fold("x - 0"), "x");
+    EXPECT_EQ(fold("x + (0 * (0 - 1))"), "x");
+    // -0 + 0 is +0, NaN * 0 is NaN
+    EXPECT_EQ(fold("x + 0"), "(x + 0)");
+    EXPECT_EQ(fold("0 + x"), "(0 + x)");
+    EXPECT_EQ(fold("x * 0"), "(x * 0)");
+    // -0 - -0 is +0
+    EXPECT_EQ(fold("x - (0 * (0 - 1))"), "(x - -0)");
+    EXPECT_EQ(fold("0 - x"), "(0 - x)");
+}
+
+TEST_F(ExprFolderTest, LeavesUserOperatorsAlone) {
+    EXPECT_EQ(fold("1 | 2"), "(1 | 2)");
+    EXPECT_EQ(fold("!(1 + 2)"), "!3");
+    EXPECT_EQ(folder.getNumFolded(), 1u);
+}
+
+TEST_F(ExprFolderTest, TakesConstantBranches) {
+    EXPECT_EQ(fold("if 1 < 2 then f(1) else g(2)"), "f(1)");
+    EXPECT_EQ(fold("if 0 then f(1) else g(2)"), "g(2)");
+    EXPECT_EQ(fold("if (1e308 * 10 - 1e308 * 10) then f(1) else g(2)"), "g(2)");
+    EXPECT_EQ(fold("if x then 1 + 1 else 2"), "if x then\n\t2\nelse\n\t2");
+    EXPECT_EQ(fold("def h(a) if 1 then 2 else a = a * 3 < 4 + if 0 then 5 else a"), "2");
+}
+
+TEST_F(ExprFolderTest, KeepsBranchesThatMayNotCompile) {
+    // Dropping them would hide the error codegen reports
+    EXPECT_EQ(fold("if 1 then 2 else undefinedVar"), "if 1 then\n\t2\nelse\n\tundefinedVar");
+    EXPECT_EQ(fold("def h(a) if 0 then b else a"), "if 0 then\n\tb\nelse\n\ta");
+    EXPECT_EQ(fold("def h(a) if 1 then a else f(1, 2)"), "if 1 then\n\ta\nelse\n\tf(1, 2)");
+    EXPECT_EQ(fold("def h(a) if 1 then a else k(1)"), "if 1 then\n\ta\nelse\n\tk(1)");
+    EXPECT_EQ(fold("def h(a) if 1 then a else !a"), "if 1 then\n\ta\nelse\n\t!a");
+    EXPECT_EQ(fold("def h(a) if 1 then a else 1 | 2"), "if 1 then\n\ta\nelse\n\t(1 | 2)");
+    EXPECT_EQ(fold("def h(a) if 1 then a else (a * 1) = 2"), "if 1 then\n\ta\nelse\n\t((a * 1) = 2)");
+    EXPECT_EQ(folder.getNumFolded(), 0u);
+
+    // The taken branch is compiled either way
+    EXPECT_EQ(fold("if 1 then undefinedVar else 2"), "undefinedVar");
+}
+
+TEST_F(ExprFolderTest, KeepsAssignmentDestination) {
+    // Codegen rejects anything but a variable there
+    EXPECT_EQ(fold("def h(x) x * 1 = 5"), "((x * 1) = 5)");
+    EXPECT_EQ(fold("def h(x) x = 2 * 3"), "(x = 6)");
+    EXPECT_EQ(fold("def h(x) (1 + 2) = x"), "((1 + 2) = x)");
+}
+
+TEST_F(ExprFolderTest, FoldsHeapTrees) {
+    ExprUPtr root = std::make_unique<IfExpr>(
+        std::make_unique<NumberExpr>(1),
+        std::make_unique<BinaryExpr>('*', std::make_unique<VariableExpr>("x"), std::make_unique<NumberExpr>(1)),
+        std::make_unique<NumberExpr>(2));
+    folder.fold(root);
+    EXPECT_EQ(root->toString(), "x");
+    EXPECT_FALSE(root->isArenaAllocated());
+}
+
+TEST_F(ExprFolderTest, KeepsSharedNodesIntact) {
+    // (x * 1) is one node with two parents
+    EXPECT_EQ(fold("(x * 1) + (x * 1) * 2", true), "(x + (x * 2))");
+    EXPECT_EQ(fold("((2 + 3) < y) * ((2 + 3) < y)", true), "((5 < y) * (5 < y))");
+}
+
+TEST_F(ExprFolderTest, FoldsDeepTreesWithoutRecursion) {
+    std::string source = "1";
+    for (int i = 0; i < 200000; ++i) {
+        source += "+1";
+    }
+    EXPECT_EQ(foldToNumber(source), 200001.0);
+}
@@ -0,0 +1,78 @@
+#include "gtest/gtest.h"
+
+#include "AST/ExprInterner.hpp"
+
+TEST(ExprInternerTest, SharesEqualLeaves) {
+    ASTArena arena;
+    ExprInterner interner;
+    ExprUPtr one = interner.getNumber(arena, 1);
+    EXPECT_EQ(interner.getNumber(arena, 1).get(), one.get());
+    EXPECT_NE(interner.getNumber(arena, 2).get(), one.get());
+
+    ExprUPtr x = interner.getVariable(arena, "x", 10);
+    EXPECT_EQ(interner.getVariable(arena, "x", 20).get(), x.get());
+    EXPECT_EQ(x->getSourceLoc(), 10u); // The first occurrence
+    EXPECT_NE(interner.getVariable(arena, "y", 30).get(), x.get());
+
+    EXPECT_EQ(arena.getNumNodes(), 4u);
+    EXPECT_EQ(interner.getNumShared(), 2u);
+}
+
+TEST(ExprInternerTest, ZeroAndNegativeZeroAreDifferent) {
+    ASTArena arena;
+    ExprInterner interner;
+    ExprUPtr zero = interner.getNumber(arena, 0.0);
+    EXPECT_NE(interner.getNumber(arena, -0.0).get(), zero.get());
+}
+
+TEST(ExprInternerTest, SharesBuiltinArithmeticOverInternedOperands) {
+    ASTArena arena;
+    ExprInterner interner;
+    auto square = [&](const char* name) {
+        return interner.getBinary(arena, '*', interner.getVariable(arena, name, 0),
+                                  interner.getVariable(arena, name, 0), 0);
+    };
+    ExprUPtr sum = interner.getBinary(arena, '+', square("x"), square("y"), 0);
+    ExprUPtr again = interner.getBinary(arena, '+', square("x"), square("y"), 0);
+    EXPECT_EQ(again.get(), sum.get());
+    EXPECT_EQ(arena.getNumNodes(), 5u); // x, x*x, y, y*y, +
+
+    ExprUPtr swapped = interner.getBinary(arena, '+', square("y"), square("x"), 0);
+    EXPECT_NE(swapped.get(), sum.get());
+    EXPECT_NE(interner.getStructuralHash(swapped.get()), interner.getStructuralHash(sum.get()));
+}
+
+TEST(ExprInternerTest, KeepsSideEffectsApart) {
+    ASTArena arena;
+    ExprInterner interner;
+    auto assign = [&]() {
+        return interner.getBinary(arena, '=', interner.getVariable(arena, "x", 0),
+                                  interner.getNumber(arena, 1), 0);
+    };
+    ExprUPtr first = assign();
+    EXPECT_NE(assign().get(), first.get());
+    EXPECT_EQ(interner.getStructuralHash(first.get()), 0u);
+
+    // Operators over a node that is not interned are not either
+    auto userOp = [&]() {
+        return interner.getBinary(arena, '|', interner.getNumber(arena, 1), interner.getNumber(arena, 2), 0);
+    };
+    ExprUPtr op = userOp();
+    EXPECT_NE(userOp().get(), op.get());
+    ExprUPtr sum = interner.getBinary(arena, '+', std::move(op), interner.getNumber(arena, 1), 0);
+    EXPECT_EQ(interner.getStructuralHash(sum.get()), 0u);
+}
+
+TEST(ExprInternerTest, EqualTreesHashEqualAcrossItems) {
+    ExprInterner interner;
+    size_t hashes[2];
+    for (size_t& hash : hashes) {
+        ASTArena arena;
+        interner.clear();
+        ExprUPtr expr = interner.getBinary(arena, '<', interner.getVariable(arena, "x", 0),
+                                           interner.getNumber(arena, 3), 0);
+        hash = interner.getStructuralHash(expr.get());
+        EXPECT_NE(hash, 0u);
+    }
+    EXPECT_EQ(hashes[0], hashes[1]);
+}
@@ -215,19 +215,19 @@ TEST_F(MockedValueVisitorTest, VisitUnaryExpr) {
 }
 // CallExpr tests
 TEST(CallExprTest, GetTypeReturnsCall) {
-    std::vector<std::unique_ptr<Expr>> args;
+    std::vector<ExprUPtr> args;
     CallExpr expr("foo", std::move(args));
     EXPECT_EQ(expr.getType(), "Call");
 }
 
 TEST(CallExprTest, ToStringNoArgs) {
-    std::vector<std::unique_ptr<Expr>> args;
+    std::vector<ExprUPtr> args;
     CallExpr expr("bar", std::move(args));
     EXPECT_EQ(expr.toString(), "bar()");
 }
 
 TEST(CallExprTest, ToStringWithArgs) {
-    std::vector<std::unique_ptr<Expr>> args;
+    std::vector<ExprUPtr> args;
     args.push_back(std::make_unique<NumberExpr>(1.0));
     args.push_back(std::make_unique<VariableExpr>("y"));
     CallExpr expr("baz", std::move(args));
@@ -235,7 +235,7 @@ TEST(CallExprTest, ToStringWithArgs) {
 }
 
 TEST(CallExprTest, ToStringWithNestedExprs) {
-    std::vector<std::unique_ptr<Expr>> args;
+    std::vector<ExprUPtr> args;
     auto lhs = std::make_unique<NumberExpr>(2.0);
     auto rhs = std::make_unique<NumberExpr>(3.0);
     args.push_back(std::make_unique<BinaryExpr>('+', std::move(lhs), std::move(rhs)));
@@ -244,13 +244,13 @@ TEST(CallExprTest, ToStringWithNestedExprs) {
 }
 
 TEST(CallExprTest, GetCalleeNameReturnsCorrectName) {
-    std::vector<std::unique_ptr<Expr>> args;
+    std::vector<ExprUPtr> args;
     CallExpr expr("calculate", std::move(args));
     EXPECT_EQ(expr.getCalleeName(), "calculate");
 }
 
 TEST(CallExprTest, GetArgsReturnsCorrectArgs) {
-    std::vector<std::unique_ptr<Expr>> args;
+    std::vector<ExprUPtr> args;
     args.push_back(std::make_unique<NumberExpr>(10.0));
     args.push_back(std::make_unique<VariableExpr>("x"));
     CallExpr expr("process", std::move(args));
@@ -262,7 +262,7 @@ TEST(CallExprTest, GetArgsReturnsCorrectArgs) {
 }
 
 TEST(CallExprTest, GetNumArgsReturnsCorrectCount) {
-    std::vector<std::unique_ptr<Expr>> args;
+    std::vector<ExprUPtr> args;
     args.push_back(std::make_unique<NumberExpr>(1.0));
     args.push_back(std::make_unique<VariableExpr>("y"));
     CallExpr expr("func", std::move(args));
@@ -271,7 +271,7 @@ TEST(CallExprTest, GetNumArgsReturnsCorrectCount) {
 
 TEST(CallExprTest, AcceptASTVisitor) {
     MockASTVisitor mockVisitor;
-    std::vector<std::unique_ptr<Expr>> args;
+    std::vector<ExprUPtr> args;
     args.push_back(std::make_unique<NumberExpr>(1.0));
     CallExpr expr("foo", std::move(args));
 
@@ -283,7 +283,7 @@ TEST(CallExprTest, AcceptASTVisitor) {
 
 TEST_F(MockedValueVisitorTest, VisitCallExpr) {
     MockValueVisitor mockVisitor;
-    std::vector<std::unique_ptr<Expr>> args;
+    std::vector<ExprUPtr> args;
     args.push_back(std::make_unique<NumberExpr>(1.0));
     CallExpr expr("foo", std::move(args));
 
@@ -369,7 +369,7 @@ protected:
         end = End.get();
         auto Step = std::make_unique<NumberExpr>(1);
         step = Step.get();
-        std::vector<std::unique_ptr<Expr>> args;
+        std::vector<ExprUPtr> args;
         args.push_back(std::make_unique<NumberExpr>(1.0));
         auto Body = std::make_unique<CallExpr>("foo", std::move(args));
         body = Body.get();
@@ -525,3 +525,30 @@ TEST_F(MockedValueVisitorTest, VisitVarExpr) {
     llvm::Value* result = expr.accept(mockVisitor);
     EXPECT_EQ(result, value);
 }
+
+TEST(ExprTreeTest, ForWithoutStepToString) {
+    ForExpr expr("i", std::make_unique<NumberExpr>(1), std::make_unique<NumberExpr>(5),
+                    nullptr, std::make_unique<VariableExpr>("i"));
+    EXPECT_EQ(expr.toString(), "for 1, 5\n\ti");
+}
+
+TEST(ExprTreeTest, ToStringPrintsMockedChildren) {
+    auto mock = std::make_unique<MockExpr>();
+    EXPECT_CALL(*mock, toString()).WillOnce(testing::Return("m"));
+    UnaryExpr expr('!', std::move(mock));
+    EXPECT_EQ(expr.toString(), "!m");
+}
+
+TEST(ExprTreeTest, DeepHeapTreeIsPrintedAndDeleted) {
+    const int depth = 1000000;
+    ExprUPtr expr = std::make_unique<NumberExpr>(1);
+    for (int i = 0; i < depth; ++i) {
+        expr = std::make_unique<BinaryExpr>('+', std::move(expr), std::make_unique<VariableExpr>("x"));
+    }
+
+    std::string printed = expr->toString();
+    EXPECT_EQ(printed.size(), depth * 6 + 1u);
+    EXPECT_EQ(printed.substr(depth - 3, 8), "(((1 + x");
+
+    expr.reset();
+}
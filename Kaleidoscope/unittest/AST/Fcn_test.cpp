@@ -17,17 +17,18 @@ TEST(FcnPrototypeTest, ConstructorAndGetType) {
 TEST(FcnPrototypeTest, GetArgsReturnsReference) {
     std::vector<std::string> args = {"arg1", "arg2"};
     FcnPrototype proto("testFunc", args);
-    const std::vector<std::string>& argsRef = proto.getArgs();
+    const std::vector<Symbol>& argsRef = proto.getArgs();
     EXPECT_EQ(argsRef.size(), 2);
     EXPECT_EQ(argsRef[0], "arg1");
     EXPECT_EQ(argsRef[1], "arg2");
 }
 
-TEST(FcnPrototypeTest, GetNameReturnsReference) {
+TEST(FcnPrototypeTest, GetNameReturnsSymbol) {
     std::vector<std::string> args = {};
     FcnPrototype proto("foo", args);
-    const std::string& nameRef = proto.getName();
-    EXPECT_EQ(nameRef, "foo");
+    Symbol name = proto.getName();
+    EXPECT_EQ(name, "foo");
+    EXPECT_EQ(name.str(), "foo");
 }
 
 TEST(FcnPrototypeTest, AcceptASTVisitor) {
@@ -149,7 +150,7 @@ TEST(FcnTest, GetBodyReturnsCorrectBody) {
 
 TEST(FcnTest, ConstructorWithNullPrototypeAndBody) {
     std::unique_ptr<FcnPrototype> proto = nullptr;
-    std::unique_ptr<Expr> body = nullptr;
+    ExprUPtr body = nullptr;
     Fcn fcn(std::move(proto), std::move(body));
     
     EXPECT_EQ(fcn.getName(), "");
@@ -0,0 +1,149 @@
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+#include "AST/FlatAST.hpp"
+#include "AST/NodeWalker.hpp"
+#include "frontend/Parser.hpp"
+
+using namespace lang;
+
+namespace {
+
+using Kind = FlatAST::Kind;
+
+std::unique_ptr<Fcn> parse(std::string_view source, bool hashConsing = false) {
+    Lexer lexer(source);
+    lexer.advance();
+    Parser parser(lexer);
+    parser.setHashConsing(hashConsing);
+    return parser.parseTopLevelExpr();
+}
+
+// Bottom-up pass, each node's size is known by the time its parent is seen
+struct SubtreeSizes {
+    const FlatAST& ast;
+    std::vector<size_t> sizes{};
+
+    void visitNumber(FlatAST::NodeId id) { add(id); }
+    void visitVariable(FlatAST::NodeId id) { add(id); }
+    void visitBinary(FlatAST::NodeId id) { add(id); }
+    void visitUnary(FlatAST::NodeId id) { add(id); }
+    void visitCall(FlatAST::NodeId id) { add(id); }
+    void visitIf(FlatAST::NodeId id) { add(id); }
+    void visitFor(FlatAST::NodeId id) { add(id); }
+    void visitVar(FlatAST::NodeId id) { add(id); }
+
+    void add(FlatAST::NodeId id) {
+        size_t size = 1;
+        for (FlatAST::NodeId operand : ast.getOperands(id)) {
+            size += operand == FlatAST::NONE ? 0 : sizes[operand];
+        }
+        sizes.push_back(size);
+    }
+};
+
+} // namespace
+
+TEST(FlatASTTest, FlattensEveryKind) {
+    auto fcn = parse("var a = 1, b in for i = 0, i < b in if a < b then g(i, -a) else b");
+    ASSERT_NE(fcn, nullptr);
+    FlatAST ast;
+    FlatAST::NodeId root = ast.append(*fcn->getBody());
+    EXPECT_EQ(root, ast.size() - 1);
+
+    ASSERT_EQ(ast.getKind(root), Kind::Var);
+    std::vector<Symbol> names(ast.getVarNames(root).begin(), ast.getVarNames(root).end());
+    EXPECT_EQ(names, (std::vector<Symbol>{"a", "b"}));
+    auto varOperands = ast.getOperands(root);
+    ASSERT_EQ(varOperands.size(), 3u);
+    EXPECT_EQ(ast.getKind(varOperands[0]), Kind::Number);
+    EXPECT_EQ(ast.getNumber(varOperands[0]), 1);
+    EXPECT_EQ(varOperands[1], FlatAST::NONE);
+
+    FlatAST::NodeId loop = varOperands[2];
+    ASSERT_EQ(ast.getKind(loop), Kind::For);
+    EXPECT_EQ(ast.getName(loop), Symbol("i"));
+    auto loopOperands = ast.getOperands(loop);
+    ASSERT_EQ(loopOperands.size(), 4u);
+    EXPECT_EQ(ast.getKind(loopOperands[1]), Kind::Binary);
+    EXPECT_EQ(ast.getOp(loopOperands[1]), '<');
+    EXPECT_EQ(loopOperands[2], FlatAST::NONE);
+
+    FlatAST::NodeId branch = loopOperands[3];
+    ASSERT_EQ(ast.getKind(branch), Kind::If);
+    EXPECT_EQ(ast.getLoc(branch), 36u); // The if keyword
+    FlatAST::NodeId call = ast.getOperands(branch)[1];
+    ASSERT_EQ(ast.getKind(call), Kind::Call);
+    EXPECT_EQ(ast.getName(call), Symbol("g"));
+    ASSERT_EQ(ast.getOperands(call).size(), 2u);
+    FlatAST::NodeId negate = ast.getOperands(call)[1];
+    EXPECT_EQ(ast.getKind(negate), Kind::Unary);
+    EXPECT_EQ(ast.getOp(negate), '-');
+    EXPECT_EQ(ast.getKind(ast.getOperands(negate)[0]), Kind::Variable);
+}
+
+TEST(FlatASTTest, StoresChildrenBeforeParents) {
+    auto fcn = parse("if f(x, y * 2) < 3 then (for i = 1, i < 10, 2 in g(i)) else -x + y");
+    ASSERT_NE(fcn, nullptr);
+    FlatAST ast;
+    ast.append(*fcn->getBody());
+
+    size_t numNodes = 0;
+    NodeWalker count([&numNodes](ASTNode&) {
+        ++numNodes;
+    });
+    fcn->getBody()->accept(count);
+    ASSERT_EQ(ast.size(), numNodes);
+
+    for (FlatAST::NodeId id = 0; id < ast.size(); ++id) {
+        for (FlatAST::NodeId operand : ast.getOperands(id)) {
+            EXPECT_LT(operand, id);
+        }
+    }
+
+    SubtreeSizes sizes{ast};
+    ast.walk(sizes);
+    EXPECT_EQ(sizes.sizes.back(), numNodes);
+}
+
+TEST(FlatASTTest, AppendsItemsAfterEachOther) {
+    auto first = parse("a + 1");
+    auto second = parse("b * 2");
+    FlatAST ast;
+    FlatAST::NodeId firstRoot = ast.append(*first->getBody());
+    FlatAST::NodeId secondRoot = ast.append(*second->getBody());
+    EXPECT_EQ(firstRoot, 2u);
+    EXPECT_EQ(secondRoot, 5u);
+    EXPECT_EQ(ast.getName(ast.getOperands(secondRoot)[0]), Symbol("b"));
+
+    ast.clear();
+    EXPECT_EQ(ast.size(), 0u);
+    EXPECT_EQ(ast.append(*second->getBody()), 2u);
+}
+
+TEST(FlatASTTest, CopiesSharedSubtrees) {
+    auto fcn = parse("(x * x) + (x * x)", true);
+    ASSERT_NE(fcn, nullptr);
+    ASSERT_EQ(fcn->getArena()->getNumNodes(), 3u);
+    FlatAST ast;
+    ast.append(*fcn->getBody());
+    EXPECT_EQ(ast.size(), 7u);
+}
+
+TEST(FlatASTTest, FlattensDeepTreesWithoutRecursion) {
+    std::string source = "x";
+    for (int i = 0; i < 200000; ++i) {
+        source += " + 1";
+    }
+    auto fcn = parse(source);
+    ASSERT_NE(fcn, nullptr);
+    FlatAST ast;
+    FlatAST::NodeId root = ast.append(*fcn->getBody());
+    EXPECT_EQ(ast.size(), 400001u);
+
+    SubtreeSizes sizes{ast};
+    ast.walk(sizes);
+    EXPECT_EQ(sizes.sizes[root], 400001u);
+}
@@ -0,0 +1,120 @@
+#include "gtest/gtest.h"
+
+#include <string>
+
+#include "AST/FlatIRSize.hpp"
+#include "AST/PrototypeRegistry.hpp"
+#include "AST/ValueVisitor.hpp"
+#include "frontend/Parser.hpp"
+
+using namespace lang;
+
+// Every estimate is checked against what CodegenVisitor actually emits
+class FlatIRSizeTest : public ::testing::Test {
+protected:
+    llvm::LLVMContext context;
+    std::unique_ptr<llvm::Module> module;
+    std::unique_ptr<llvm::IRBuilder<>> builder;
+    std::unique_ptr<CodegenVisitor> visitor;
+    OperatorTable operators;
+
+    void SetUp() override {
+        module = std::make_unique<llvm::Module>("test_module", context);
+        PrototypeRegistry::get()->setModule(module.get());
+        builder = std::make_unique<llvm::IRBuilder<>>(context);
+        visitor = std::make_unique<CodegenVisitor>(&context, module.get(), builder.get(), operators);
+        visitor->setFPM(nullptr);
+        visitor->setFAM(nullptr);
+    }
+
+    void TearDown() override {
+        PrototypeRegistry::reset();
+    }
+
+    // Compiles every item of `source`, expecting each function to have as
+    // many instructions as estimated. Returns the number of functions.
+    size_t expectSizesMatch(std::string_view source) {
+        Lexer lexer(source);
+        lexer.advance();
+        Parser parser(lexer, operators);
+        size_t numFcns = 0;
+        while (lexer.getCurrentToken() != tok_eof) {
+            if (lexer.getCurrentToken() == tok_semicolon) {
+                lexer.advance();
+            } else if (lexer.getCurrentToken() == tok_extern) {
+                auto proto = parser.parseExtern();
+                EXPECT_NE(proto, nullptr);
+                if (!proto) {
+                    return numFcns;
+                }
+                proto->accept(*visitor);
+                Symbol name = proto->getName();
+                PrototypeRegistry::addFcnPrototype(name, std::move(proto));
+            } else {
+                auto fcn = lexer.getCurrentToken() == tok_def ? parser.parseDefinition()
+                                                              : parser.parseTopLevelExpr();
+                EXPECT_NE(fcn, nullptr);
+                if (!fcn) {
+                    return numFcns;
+                }
+                // Flattened first, codegen takes the prototype
+                FlatAST flat;
+                FlatAST::NodeId body = flat.append(*fcn->getBody());
+                size_t estimate = FlatIRSize(flat).getFunctionSize(body, fcn->getPrototype()->getArgs().size());
+                std::string text = fcn->getBody()->toString();
+
+                auto* function = llvm::dyn_cast_or_null<llvm::Function>(visitor->visit(*fcn));
+                EXPECT_NE(function, nullptr) << text;
+                if (!function) {
+                    return numFcns;
+                }
+                EXPECT_EQ(estimate, function->getInstructionCount()) << text;
+                if (function->getName() == "main") {
+                    function->eraseFromParent();
+                }
+                ++numFcns;
+            }
+        }
+        return numFcns;
+    }
+};
+
+TEST_F(FlatIRSizeTest, Arithmetic) {
+    EXPECT_EQ(expectSizesMatch(
+        "def f(a b) a + b * 2 - a < b;\n"
+        "1 + 2 * 3;\n"
+        "def g(x) x < 1 + 2;\n"), 3u);
+}
+
+TEST_F(FlatIRSizeTest, CallsAndOperators) {
+    EXPECT_EQ(expectSizesMatch(
+        "extern sin(x);\n"
+        "def binary| 5 (a b) if a then 1 else b;\n"
+        "def unary!(v) if v then 0 else 1;\n"
+        "def f(x y) sin(x) | !y | 1 | 2;\n"
+        "f(1, 2);\n"), 4u);
+}
+
+TEST_F(FlatIRSizeTest, ControlFlow) {
+    EXPECT_EQ(expectSizesMatch(
+        "extern putchard(c);\n"
+        "def f(n) if n < 1 then 0 else if 1 then n else 2;\n"
+        "def g(n) for i = 0, i < n, 2 in putchard(i);\n"
+        "def h(n) for i = 1, 0 in n;\n"
+        "def k(n) var a = n, b, c = 1 + 2 in a = b = c * n;\n"
+        "def m(n) var a = 1 in a + (for i = 0, i < n in a = a * 2);\n"), 5u);
+}
+
+TEST_F(FlatIRSizeTest, ConstantsFold) {
+    FlatAST flat;
+    Lexer lexer("(1 + 2) * (3 < 4) + (for i = 0, 1 in 0)");
+    lexer.advance();
+    Parser parser(lexer, operators);
+    auto fcn = parser.parseTopLevelExpr();
+    ASSERT_NE(fcn, nullptr);
+    FlatAST::NodeId root = flat.append(*fcn->getBody());
+    FlatIRSize sizes(flat);
+    EXPECT_TRUE(sizes.isConstant(root));
+    // All that is left is the loop, with its end condition folded
+    EXPECT_EQ(sizes.getSize(root), 7u);
+}
@@ -11,10 +11,13 @@ TEST(NodeTest, GetTypeInterface) {
 
 TEST(NodeTest, GetSetSourceLoc) {
     MockASTNode node;
-    EXPECT_EQ(node.getLine(), 0);
-    EXPECT_EQ(node.getCol(), 0);
+    EXPECT_EQ(node.getSourceLoc(), 0);
+    EXPECT_FALSE(node.hasSourceLoc());
 
-    node.setSourceLoc(SourceLocation(1, 10));
-    EXPECT_EQ(node.getLine(), 1);
-    EXPECT_EQ(node.getCol(), 10);
+    node.setSourceLoc(42);
+    EXPECT_EQ(node.getSourceLoc(), 42);
+    EXPECT_TRUE(node.hasSourceLoc());
+
+    node.setSourceLoc(0);
+    EXPECT_TRUE(node.hasSourceLoc());
 }
\ No newline at end of file
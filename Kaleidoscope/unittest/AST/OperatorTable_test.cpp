@@ -0,0 +1,87 @@
+#include "gtest/gtest.h"
+#include "AST/OperatorTable.hpp"
+#include "frontend/Token.hpp"
+
+TEST(OperatorTableTest, StartsWithBuiltins) {
+    OperatorTable table;
+    EXPECT_EQ(table.getPrecedence('='), 2);
+    EXPECT_EQ(table.getPrecedence('<'), 10);
+    EXPECT_EQ(table.getPrecedence('+'), 20);
+    EXPECT_EQ(table.getPrecedence('-'), 20);
+    EXPECT_EQ(table.getPrecedence('*'), 40);
+    EXPECT_TRUE(table.isRightAssociative('='));
+    EXPECT_FALSE(table.isRightAssociative('+'));
+}
+
+TEST(OperatorTableTest, NonOperatorsHaveNoPrecedence) {
+    OperatorTable table;
+    EXPECT_EQ(table.getPrecedence('|'), -1);
+    EXPECT_EQ(table.getPrecedence('('), -1);
+    EXPECT_EQ(table.getPrecedence(0xE9), -1);
+    EXPECT_EQ(table.getPrecedence(lang::tok_identifier), -1);
+    EXPECT_EQ(table.getPrecedence(lang::tok_eof), -1);
+    EXPECT_FALSE(table.isUnaryOperator(lang::tok_eof));
+}
+
+TEST(OperatorTableTest, SetAndRemoveBinaryOperator) {
+    OperatorTable table;
+    table.setBinaryOperator('|', 5);
+    EXPECT_EQ(table.getPrecedence('|'), 5);
+    EXPECT_FALSE(table.isRightAssociative('|'));
+
+    table.setBinaryOperator('^', 60, Associativity::Right);
+    EXPECT_TRUE(table.isRightAssociative('^'));
+
+    table.removeBinaryOperator('^');
+    EXPECT_EQ(table.getPrecedence('^'), -1);
+    EXPECT_FALSE(table.isRightAssociative('^'));
+}
+
+TEST(OperatorTableTest, UnaryOperatorsAreSeparate) {
+    OperatorTable table;
+    EXPECT_FALSE(table.isUnaryOperator('-'));
+    table.setUnaryOperator('-');
+    EXPECT_TRUE(table.isUnaryOperator('-'));
+    EXPECT_EQ(table.getPrecedence('-'), 20);
+
+    table.setUnaryOperator('-', false);
+    EXPECT_FALSE(table.isUnaryOperator('-'));
+}
+
+TEST(OperatorTableTest, SessionsAreIndependent) {
+    OperatorTable first;
+    OperatorTable second;
+    first.setBinaryOperator('|', 5);
+    EXPECT_EQ(second.getPrecedence('|'), -1);
+    EXPECT_EQ(OperatorTable::builtins().getPrecedence('|'), -1);
+}
+
+TEST(OperatorTableTest, FingerprintFollowsEveryChange) {
+    OperatorTable table;
+    uint64_t builtins = table.getFingerprint();
+    EXPECT_EQ(OperatorTable::builtins().getFingerprint(), builtins);
+
+    table.setBinaryOperator('|', 5);
+    uint64_t withBinary = table.getFingerprint();
+    EXPECT_NE(withBinary, builtins);
+
+    table.setUnaryOperator('!');
+    EXPECT_NE(table.getFingerprint(), withBinary);
+
+    table.setUnaryOperator('!', false);
+    table.removeBinaryOperator('|');
+    EXPECT_EQ(table.getFingerprint(), builtins);
+}
+
+TEST(OperatorTableTest, EqualityComparesEveryEntry) {
+    OperatorTable table;
+    EXPECT_EQ(table, OperatorTable::builtins());
+
+    table.setBinaryOperator('|', 5);
+    EXPECT_NE(table, OperatorTable::builtins());
+    table.removeBinaryOperator('|');
+    EXPECT_EQ(table, OperatorTable::builtins());
+
+    table.setBinaryOperator('+', 20, Associativity::Right);
+    EXPECT_NE(table, OperatorTable::builtins());
+}
@@ -37,13 +37,14 @@ protected:
 
     std::unique_ptr<llvm::LLVMContext> context;
     std::unique_ptr<llvm::Module> module;
+    OperatorTable operators;
 };
 
 TEST_F(PrototypeRegistryTest, GetFunctionReturnsExistingModuleFunction) {
     llvm::FunctionType* fType = llvm::FunctionType::get(llvm::Type::getDoubleTy(*context), false);
     llvm::Function* function = llvm::Function::Create(fType, llvm::Function::ExternalLinkage, "existingFunc", module.get());
 
-    CodegenVisitor visitor(context.get(), module.get(), nullptr);
+    CodegenVisitor visitor(context.get(), module.get(), nullptr, operators);
     llvm::Function* result = PrototypeRegistry::getFunction("existingFunc", visitor);
     EXPECT_EQ(result, function);
 }
@@ -56,13 +57,13 @@ TEST_F(PrototypeRegistryTest, GetFunctionReturnsFunctionFromPrototype) {
     mockProto->setMockedFunction(mockedFunction);
     PrototypeRegistry::addFcnPrototype("mockFunc", std::move(mockProto));
 
-    CodegenVisitor visitor(context.get(), module.get(), nullptr);
+    CodegenVisitor visitor(context.get(), module.get(), nullptr, operators);
     llvm::Function* result = PrototypeRegistry::getFunction("mockFunc", visitor);
     EXPECT_EQ(result, mockedFunction);
 }
 
 TEST_F(PrototypeRegistryTest, GetFunctionReturnsNullOnUnknownName) {
-    CodegenVisitor visitor(context.get(), module.get(), nullptr);
+    CodegenVisitor visitor(context.get(), module.get(), nullptr, operators);
     llvm::Function* result = PrototypeRegistry::getFunction("unknownFunc", visitor);
     EXPECT_EQ(result, nullptr);
 }
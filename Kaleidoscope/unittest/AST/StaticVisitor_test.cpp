@@ -0,0 +1,150 @@
+#include "gtest/gtest.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "AST/StaticVisitor.hpp"
+#include "frontend/Parser.hpp"
+#include "mocks/AST/MockExpr.hpp"
+#include "mocks/AST/MockValueVisitor.hpp"
+
+using namespace lang;
+
+namespace {
+
+// Records the type of every node it is dispatched, parents first
+class TypeRecorder final : public StaticVisitor<TypeRecorder> {
+public:
+    std::vector<std::string> types;
+
+    void visitNumberExpr(NumberExpr& expr) { types.push_back(expr.getType()); }
+    void visitVariableExpr(VariableExpr& expr) { types.push_back(expr.getType()); }
+
+    void visitBinaryExpr(BinaryExpr& expr) {
+        types.push_back(expr.getType());
+        visit(*expr.getLHS());
+        visit(*expr.getRHS());
+    }
+
+    void visitUnaryExpr(UnaryExpr& expr) {
+        types.push_back(expr.getType());
+        visit(*expr.getOperand());
+    }
+
+    void visitCallExpr(CallExpr& expr) {
+        types.push_back(expr.getType());
+        for (Expr* arg : expr.getArgs()) {
+            visit(*arg);
+        }
+    }
+
+    void visitIfExpr(IfExpr& expr) {
+        types.push_back(expr.getType());
+        visit(*expr.getCond());
+        visit(*expr.getThen());
+        visit(*expr.getElse());
+    }
+
+    void visitForExpr(ForExpr& expr) {
+        types.push_back(expr.getType());
+        visit(*expr.getStart());
+        visit(*expr.getEnd());
+        if (expr.getStep()) {
+            visit(*expr.getStep());
+        }
+        visit(*expr.getBody());
+    }
+
+    void visitVarExpr(VarExpr& expr) {
+        types.push_back(expr.getType());
+        for (auto [name, init] : expr.getVarNames()) {
+            if (init) {
+                visit(*init);
+            }
+        }
+        visit(*expr.getBody());
+    }
+
+    void visitFcnPrototype(FcnPrototype& proto) { types.push_back(proto.getType()); }
+
+    void visitFcn(Fcn& fcn) {
+        types.push_back(fcn.getType());
+        visit(*fcn.getPrototype());
+        visit(*fcn.getBody());
+    }
+
+    void visitOther(ASTNode&) { types.push_back("Other"); }
+};
+
+// Hands the nodes only accept() knows to `fallback`
+class ForwardingVisitor final : public StaticVisitor<ForwardingVisitor, llvm::Value*> {
+public:
+    explicit ForwardingVisitor(ValueVisitor& fallback) : fallback(fallback) {}
+
+    llvm::Value* visitNumberExpr(NumberExpr&) { return nullptr; }
+    llvm::Value* visitVariableExpr(VariableExpr&) { return nullptr; }
+    llvm::Value* visitBinaryExpr(BinaryExpr&) { return nullptr; }
+    llvm::Value* visitUnaryExpr(UnaryExpr&) { return nullptr; }
+    llvm::Value* visitCallExpr(CallExpr&) { return nullptr; }
+    llvm::Value* visitIfExpr(IfExpr&) { return nullptr; }
+    llvm::Value* visitForExpr(ForExpr&) { return nullptr; }
+    llvm::Value* visitVarExpr(VarExpr&) { return nullptr; }
+    llvm::Value* visitFcnPrototype(FcnPrototype&) { return nullptr; }
+    llvm::Value* visitFcn(Fcn&) { return nullptr; }
+
+    llvm::Value* visitOther(ASTNode& node) {
+        return node.accept(fallback);
+    }
+
+private:
+    ValueVisitor& fallback;
+};
+
+} // namespace
+
+TEST(StaticVisitorTest, NodesKnowTheirKind) {
+    EXPECT_EQ(NumberExpr(1).getKind(), NodeKind::Number);
+    EXPECT_EQ(VariableExpr("x").getKind(), NodeKind::Variable);
+    EXPECT_EQ(FcnPrototype("f", std::vector<Symbol>{}).getKind(), NodeKind::FcnPrototype);
+    EXPECT_EQ(MockExpr().getKind(), NodeKind::Other);
+
+    VariableExpr var("x");
+    Expr* expr = &var;
+    EXPECT_TRUE(llvm::isa<VariableExpr>(expr));
+    EXPECT_FALSE(llvm::isa<NumberExpr>(expr));
+    EXPECT_EQ(llvm::dyn_cast<VariableExpr>(expr), &var);
+}
+
+TEST(StaticVisitorTest, DispatchesEveryKind) {
+    OperatorTable operators;
+    Lexer lexer(std::string_view(
+        "def f(x) var y = 1, z in if x < y then -g(x) else for i = 0, i < z in y = i;"));
+    Parser parser(lexer, operators);
+    lexer.advance();
+    auto fcn = parser.parseDefinition();
+    ASSERT_NE(fcn, nullptr);
+
+    TypeRecorder recorder;
+    recorder.visit(*fcn);
+    std::vector<std::string> expected = {
+        "Function", "FunctionPrototype", "Var", "Number", "If-Then-Else", "Binary", "Variable", "Variable",
+        "Unary", "Call", "Variable", "ForLoop", "Number", "Binary", "Variable", "Variable",
+        "Binary", "Variable", "Variable",
+    };
+    EXPECT_EQ(recorder.types, expected);
+}
+
+TEST(StaticVisitorTest, OtherNodesGoThroughAccept) {
+    MockExpr mock;
+    MockValueVisitor fallback;
+    EXPECT_CALL(mock, accept(testing::An<ValueVisitor&>()))
+        .WillOnce(testing::Return(nullptr));
+    ForwardingVisitor visitor(fallback);
+    EXPECT_EQ(visitor.visit(mock), nullptr);
+
+    TypeRecorder recorder;
+    BinaryExpr expr('+', std::make_unique<NumberExpr>(1), std::make_unique<MockExpr>());
+    recorder.visit(expr);
+    EXPECT_EQ(recorder.types, (std::vector<std::string>{"Binary", "Number", "Other"}));
+}
@@ -0,0 +1,83 @@
+#include "gtest/gtest.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AST/Symbol.hpp"
+
+TEST(SymbolTest, DefaultIsEmpty) {
+    Symbol sym;
+    EXPECT_TRUE(sym.empty());
+    EXPECT_EQ(sym.getId(), 0u);
+    EXPECT_EQ(sym.str(), "");
+    EXPECT_EQ(sym, Symbol(""));
+}
+
+TEST(SymbolTest, EqualStringsInternToSameId) {
+    std::string name = "someIdentifier";
+    Symbol a(name);
+    Symbol b("someIdentifier");
+    Symbol c(std::string_view("someIdentifierX").substr(0, name.size()));
+    EXPECT_EQ(a.getId(), b.getId());
+    EXPECT_EQ(a, c);
+    EXPECT_FALSE(a.empty());
+}
+
+TEST(SymbolTest, DifferentStringsInternToDifferentIds) {
+    Symbol a("alpha");
+    Symbol b("beta");
+    EXPECT_NE(a, b);
+    EXPECT_EQ(a.str(), "alpha");
+    EXPECT_EQ(b.str(), "beta");
+}
+
+TEST(SymbolTest, StringOutlivesSource) {
+    Symbol sym;
+    {
+        std::string temp = "temporaryName";
+        sym = Symbol(temp);
+        temp = "overwritten";
+    }
+    EXPECT_EQ(sym.str(), "temporaryName");
+}
+
+TEST(SymbolTest, InternDoesNotGrowForKnownStrings) {
+    Symbol("gamma");
+    size_t size = SymbolTable::get()->size();
+    Symbol("gamma");
+    EXPECT_EQ(SymbolTable::get()->size(), size);
+}
+
+TEST(SymbolTest, HashesById) {
+    Symbol sym("delta");
+    EXPECT_EQ(std::hash<Symbol>()(sym), std::hash<uint32_t>()(sym.getId()));
+}
+
+TEST(SymbolTest, ConcurrentInterningAgrees) {
+    constexpr int THREADS = 8;
+    constexpr int NAMES = 500;
+
+    std::vector<std::vector<Symbol>> results(THREADS);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([t, &results] {
+            for (int i = 0; i < NAMES; ++i) {
+                // Each thread walks the names in a different order
+                int n = (i * 7 + t * 31) % NAMES;
+                results[t].push_back(Symbol("concurrent" + std::to_string(n)));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (int t = 0; t < THREADS; ++t) {
+        for (int i = 0; i < NAMES; ++i) {
+            int n = (i * 7 + t * 31) % NAMES;
+            EXPECT_EQ(results[t][i], Symbol("concurrent" + std::to_string(n)));
+            EXPECT_EQ(results[t][i].str(), "concurrent" + std::to_string(n));
+        }
+    }
+}
@@ -4,7 +4,7 @@
 
 #include "AST/Expr.hpp"
 #include "AST/Fcn.hpp"
-#include "AST/Precedence.hpp"
+#include "AST/OperatorTable.hpp"
 #include "AST/PrototypeRegistry.hpp"
 #include "AST/ValueVisitor.hpp"
 #include "debug/DebugInfo.hpp"
@@ -18,13 +18,14 @@ protected:
     std::unique_ptr<Module> module;
     std::unique_ptr<IRBuilder<>> builder;
     std::unique_ptr<CodegenVisitor> visitor;
+    OperatorTable operators;
 
     void SetUp() override {
         module = std::make_unique<Module>("test_module", context);
         PrototypeRegistry::get()->setModule(module.get());
         builder = std::make_unique<IRBuilder<>>(context);
 
-        visitor = std::make_unique<CodegenVisitor>(&context, module.get(), builder.get());
+        visitor = std::make_unique<CodegenVisitor>(&context, module.get(), builder.get(), operators);
 
         // Setup a basic basic block
         auto funcType = FunctionType::get(Type::getVoidTy(context), 
@@ -161,13 +162,14 @@ TEST_F(CodegenVisitorTest, VisitCustomBinaryExpr) {
 // For unary operators, there are no predefined ops
 TEST_F(CodegenVisitorTest, VisitUnaryExprNonOp) {
     UnaryExpr expr = UnaryExpr('`', std::make_unique<NumberExpr>(7));
-    EXPECT_DEATH(visitor->visitUnaryExpr(expr), "unary operator not found");
+    EXPECT_EQ(visitor->visitUnaryExpr(expr), nullptr);
 }
 
 TEST_F(CodegenVisitorTest, VisitCustomUnaryOperator) {
     std::vector<std::string> args = {"x"};
     auto proto = std::make_unique<FcnPrototype>("unary`", args, true);
     PrototypeRegistry::addFcnPrototype("unary`", std::move(proto));
+    operators.setUnaryOperator('`');
 
     UnaryExpr expr = UnaryExpr('`', std::make_unique<NumberExpr>(7));
     Value* val = visitor->visitUnaryExpr(expr);
@@ -179,6 +181,7 @@ TEST_F(CodegenVisitorTest, VisitCustomUnaryOperatorBadBody) {
     std::vector<std::string> args = {"x"};
     auto proto = std::make_unique<FcnPrototype>("unary`", args, true);
     PrototypeRegistry::addFcnPrototype("unary`", std::move(proto));
+    operators.setUnaryOperator('`');
 
     UnaryExpr expr = UnaryExpr('`', std::make_unique<VariableExpr>("a"));
     Value* val = visitor->visitUnaryExpr(expr);
@@ -187,7 +190,7 @@ TEST_F(CodegenVisitorTest, VisitCustomUnaryOperatorBadBody) {
 
 TEST_F(CodegenVisitorTest, VisitCallExpr) {
     addPrototypeToRegistry();
-    std::vector<std::unique_ptr<Expr>> callArgs;
+    std::vector<ExprUPtr> callArgs;
     callArgs.push_back(std::make_unique<NumberExpr>(5.0));
     callArgs.push_back(std::make_unique<NumberExpr>(7.0));
     CallExpr callExpr("foo", std::move(callArgs));
@@ -198,7 +201,7 @@ TEST_F(CodegenVisitorTest, VisitCallExpr) {
 }
 
 TEST_F(CodegenVisitorTest, VisitCallExprProtoNotRegistered) {
-    std::vector<std::unique_ptr<Expr>> callArgs;
+    std::vector<ExprUPtr> callArgs;
     callArgs.push_back(std::make_unique<NumberExpr>(5.0));
     callArgs.push_back(std::make_unique<NumberExpr>(7.0));
     CallExpr callExpr("foo", std::move(callArgs));
@@ -208,7 +211,7 @@ TEST_F(CodegenVisitorTest, VisitCallExprProtoNotRegistered) {
 }
 
 TEST_F(CodegenVisitorTest, VisitCallExprWrongNumberArgs) {
-    std::vector<std::unique_ptr<Expr>> callArgs;
+    std::vector<ExprUPtr> callArgs;
     callArgs.push_back(std::make_unique<NumberExpr>(7.0));
     CallExpr callExpr("foo", std::move(callArgs));
 
@@ -217,7 +220,7 @@ TEST_F(CodegenVisitorTest, VisitCallExprWrongNumberArgs) {
 }
 
 TEST_F(CodegenVisitorTest, VisitCallExprBadArg) {
-    std::vector<std::unique_ptr<Expr>> callArgs;
+    std::vector<ExprUPtr> callArgs;
     callArgs.push_back(std::make_unique<NumberExpr>(7.0));
     callArgs.push_back(std::make_unique<BinaryExpr>(makeBinaryExpr('a')));
     CallExpr callExpr("foo", std::move(callArgs));
@@ -255,7 +258,7 @@ TEST_F(CodegenVisitorTest, VisitForExpr) {
     auto Start = std::make_unique<NumberExpr>(0);
     auto End = std::make_unique<NumberExpr>(10);
     auto Step = std::make_unique<NumberExpr>(1);
-    std::vector<std::unique_ptr<Expr>> args;
+    std::vector<ExprUPtr> args;
     args.push_back(std::make_unique<NumberExpr>(1.0));
     auto Body = std::make_unique<NumberExpr>(1);
     auto expr = std::make_unique<ForExpr>(loopId, std::move(Start), std::move(End),
@@ -272,7 +275,7 @@ TEST_F(CodegenVisitorTest, VisitForExprNullStep) {
     auto End = std::make_unique<NumberExpr>(10);
     // Step is optional, should codegen fine
     auto Step = nullptr;
-    std::vector<std::unique_ptr<Expr>> args;
+    std::vector<ExprUPtr> args;
     args.push_back(std::make_unique<NumberExpr>(1.0));
     auto Body = std::make_unique<NumberExpr>(1);
     auto expr = std::make_unique<ForExpr>(loopId, std::move(Start), std::move(End),
@@ -288,7 +291,7 @@ TEST_F(CodegenVisitorTest, VisitForExprBadStart) {
     auto Start = std::make_unique<VariableExpr>("j");
     auto End = std::make_unique<NumberExpr>(10);
     auto Step = std::make_unique<NumberExpr>(1);
-    std::vector<std::unique_ptr<Expr>> args;
+    std::vector<ExprUPtr> args;
     args.push_back(std::make_unique<NumberExpr>(1.0));
     auto Body = std::make_unique<CallExpr>("foo", std::move(args));
     auto expr = std::make_unique<ForExpr>(loopId, std::move(Start), std::move(End),
@@ -303,7 +306,7 @@ TEST_F(CodegenVisitorTest, VisitForExprBadEnd) {
     auto Start = std::make_unique<NumberExpr>(0);
     auto End = std::make_unique<VariableExpr>("j");
     auto Step = std::make_unique<NumberExpr>(1);
-    std::vector<std::unique_ptr<Expr>> args;
+    std::vector<ExprUPtr> args;
     args.push_back(std::make_unique<NumberExpr>(1.0));
     auto Body = std::make_unique<CallExpr>("foo", std::move(args));
     auto expr = std::make_unique<ForExpr>(loopId, std::move(Start), std::move(End),
@@ -318,7 +321,7 @@ TEST_F(CodegenVisitorTest, VisitForExprBadStep) {
     auto Start = std::make_unique<NumberExpr>(0);
     auto End = std::make_unique<NumberExpr>(10);
     auto Step = std::make_unique<VariableExpr>("j");
-    std::vector<std::unique_ptr<Expr>> args;
+    std::vector<ExprUPtr> args;
     args.push_back(std::make_unique<NumberExpr>(1.0));
     auto Body = std::make_unique<CallExpr>("foo", std::move(args));
     auto expr = std::make_unique<ForExpr>(loopId, std::move(Start), std::move(End),
@@ -333,7 +336,7 @@ TEST_F(CodegenVisitorTest, VisitForExprBadBody) {
     auto Start = std::make_unique<NumberExpr>(0);
     auto End = std::make_unique<NumberExpr>(10);
     auto Step = std::make_unique<NumberExpr>(1);
-    std::vector<std::unique_ptr<Expr>> args;
+    std::vector<ExprUPtr> args;
     args.push_back(std::make_unique<NumberExpr>(1.0));
     auto Body = std::make_unique<VariableExpr>("j");
     auto expr = std::make_unique<ForExpr>(loopId, std::move(Start), std::move(End),
@@ -364,6 +367,26 @@ TEST_F(CodegenVisitorTest, VisitVarExprMultipleVars) {
     EXPECT_TRUE(isa<Constant>(val));
 }
 
+TEST_F(CodegenVisitorTest, VisitVarExprRestoresOuterBindings) {
+    auto outer = visitor->createEntryBlockAlloca(
+                                    builder->GetInsertBlock()->getParent(), "x");
+    visitor->setNamedValue("x", outer);
+
+    VarNameVector args;
+    args.push_back(std::make_pair("x", std::make_unique<NumberExpr>(1)));
+    args.push_back(std::make_pair("y", std::make_unique<NumberExpr>(2)));
+    args.push_back(std::make_pair("x", std::make_unique<NumberExpr>(3)));
+    VarExpr expr(std::move(args), std::make_unique<VariableExpr>("y"));
+    ASSERT_NE(visitor->visitVarExpr(expr), nullptr);
+
+    VariableExpr x("x");
+    auto load = dyn_cast_or_null<LoadInst>(visitor->visitVariableExpr(x));
+    ASSERT_NE(load, nullptr);
+    EXPECT_EQ(load->getPointerOperand(), outer);
+    VariableExpr y("y");
+    EXPECT_EQ(visitor->visitVariableExpr(y), nullptr);
+}
+
 TEST_F(CodegenVisitorTest, VisitVarExprNullInit) {
     VarNameVector args;
     args.push_back(std::make_pair("z", nullptr));
@@ -436,8 +459,7 @@ TEST_F(CodegenVisitorTest, VisitBinaryOpFcnSetsPrecedence) {
     Fcn fcn(std::move(proto), std::move(body));
     Value* val = visitor->visitFcn(fcn);
     
-    EXPECT_EQ(BIN_OP_PRECEDENCE['`'], 17);
-    BIN_OP_PRECEDENCE.erase('`');
+    EXPECT_EQ(operators.getPrecedence('`'), 17);
 }
 
 TEST_F(CodegenVisitorTest, VisitFcnBadBody) {
@@ -458,5 +480,26 @@ TEST_F(CodegenVisitorTest, VisitBinaryOpFcnBadBodyDoesNotSetPrecedence) {
     Fcn fcn(std::move(proto), std::move(body));
     Value* val = visitor->visitFcn(fcn);
     
-    EXPECT_EQ(BIN_OP_PRECEDENCE['`'], 0);
+    EXPECT_EQ(operators.getPrecedence('`'), -1);
+}
+
+TEST_F(CodegenVisitorTest, FailedBuiltinRedefinitionKeepsPrecedence) {
+    std::vector<std::string> args = {"x", "y"};
+    auto proto = std::make_unique<FcnPrototype>("binary+", args, true, 70);
+    auto body = std::make_unique<VariableExpr>("a");
+    Fcn fcn(std::move(proto), std::move(body));
+    EXPECT_EQ(visitor->visitFcn(fcn), nullptr);
+
+    EXPECT_EQ(operators.getPrecedence('+'), 20);
+}
+
+TEST_F(CodegenVisitorTest, VisitUnaryOpFcnRegistersOperator) {
+    std::vector<std::string> args = {"x"};
+    auto proto = std::make_unique<FcnPrototype>("unary~", args, true);
+    auto body = std::make_unique<NumberExpr>(1);
+    Fcn fcn(std::move(proto), std::move(body));
+    ASSERT_NE(visitor->visitFcn(fcn), nullptr);
+
+    EXPECT_TRUE(operators.isUnaryOperator('~'));
+    EXPECT_EQ(operators.getPrecedence('~'), -1);
 }
\ No newline at end of file
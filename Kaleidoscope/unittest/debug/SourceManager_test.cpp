@@ -0,0 +1,70 @@
+#include "gtest/gtest.h"
+
+#include <string>
+
+#include "debug/SourceManager.hpp"
+#include "frontend/Parser.hpp"
+
+using namespace lang;
+
+namespace {
+
+void expectLocation(const SourceManager& sources, SourceOffset offset, int line, int col) {
+    SourceLocation loc = sources.getLocation(offset);
+    EXPECT_EQ(loc.Line, line) << "offset " << offset;
+    EXPECT_EQ(loc.Col, col) << "offset " << offset;
+}
+
+} // namespace
+
+TEST(SourceManagerTest, EmptySource) {
+    SourceManager sources("");
+    EXPECT_EQ(sources.getNumLines(), 1);
+    expectLocation(sources, 0, 1, 1);
+}
+
+TEST(SourceManagerTest, ResolvesLinesAndColumns) {
+    SourceManager sources("ab\ncd\n\nef");
+    EXPECT_EQ(sources.getNumLines(), 4);
+    expectLocation(sources, 0, 1, 1);
+    expectLocation(sources, 1, 1, 2);
+    expectLocation(sources, 2, 1, 3); // The line break itself
+    expectLocation(sources, 3, 2, 1);
+    expectLocation(sources, 6, 3, 1);
+    expectLocation(sources, 8, 4, 2);
+}
+
+TEST(SourceManagerTest, HandlesEveryLineEnding) {
+    SourceManager sources("a\r\nb\rc\nd");
+    EXPECT_EQ(sources.getNumLines(), 4);
+    expectLocation(sources, 3, 2, 1);
+    expectLocation(sources, 5, 3, 1);
+    expectLocation(sources, 7, 4, 1);
+}
+
+TEST(SourceManagerTest, ClampsPastTheEnd) {
+    SourceManager sources("abc\nde");
+    expectLocation(sources, 6, 2, 3);
+    expectLocation(sources, 1000, 2, 3);
+}
+
+TEST(SourceManagerTest, OwnsMemoryBuffer) {
+    auto buffer = llvm::MemoryBuffer::getMemBufferCopy("x\ny", "test");
+    SourceManager sources(std::move(buffer));
+    EXPECT_EQ(sources.getSource(), "x\ny");
+    expectLocation(sources, 2, 2, 1);
+}
+
+TEST(SourceManagerTest, ResolvesParsedNodes) {
+    std::string source = "# leading comment\ndef foo(x)\n  bar(x);";
+    SourceManager sources(source);
+    Lexer lexer(sources.getSource());
+    lexer.advance();
+    Parser parser(lexer);
+
+    auto fcn = parser.parseDefinition();
+    ASSERT_NE(fcn, nullptr);
+    SourceLocation body = sources.getLocation(fcn->getBody()->getSourceLoc());
+    EXPECT_EQ(body.Line, 3);
+    EXPECT_EQ(body.Col, 3);
+}
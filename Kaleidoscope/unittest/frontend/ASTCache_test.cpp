@@ -0,0 +1,175 @@
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "frontend/ASTCache.hpp"
+#include "frontend/Parser.hpp"
+
+using namespace lang;
+
+namespace {
+
+std::string tempPath(const char* name) {
+    std::string path = ::testing::TempDir() + name;
+    std::remove(path.c_str());
+    return path;
+}
+
+void writeFile(const std::string& path, std::string_view contents) {
+    std::ofstream(path, std::ios::binary) << contents;
+}
+
+} // namespace
+
+TEST(ASTCacheTest, SplitsAtLinesStartingWithDefOrExtern) {
+    std::string_view source =
+        "1;\n"
+        "def f() 2;\n"
+        "  def g() 3;\n"
+        "extern sin(x);\n"
+        "define;";
+    std::vector<std::string_view> expected = {
+        "1;\n",
+        "def f() 2;\n  def g() 3;\n",
+        "extern sin(x);\ndefine;",
+    };
+    EXPECT_EQ(ASTCache::splitChunks(source), expected);
+    EXPECT_TRUE(ASTCache::splitChunks("").empty());
+}
+
+TEST(ASTCacheTest, KeyDependsOnTextAndOperators) {
+    OperatorTable operators;
+    uint64_t key = ASTCache::getKey("def f(x) x;", operators);
+    EXPECT_EQ(ASTCache::getKey("def f(x) x;", operators), key);
+    EXPECT_NE(ASTCache::getKey("def f(y) y;", operators), key);
+    EXPECT_EQ(ASTCache::getKey("", operators), ASTCache::getKey("", operators));
+
+    operators.setBinaryOperator('|', 5);
+    EXPECT_NE(ASTCache::getKey("def f(x) x;", operators), key);
+}
+
+TEST(ASTCacheTest, SavesOnlyEntriesUsedSinceLoading) {
+    std::string path = tempPath("ASTCacheTest_used.bin");
+    {
+        ASTCache cache(path);
+        EXPECT_EQ(cache.getNumEntries(), 0u);
+        cache.store(1, "1;", "one");
+        cache.store(2, "2;", "two");
+        ASSERT_TRUE(cache.save());
+    }
+    {
+        ASTCache cache(path);
+        EXPECT_EQ(cache.getNumEntries(), 2u);
+        const std::string* entry = cache.lookup(2, "2;");
+        ASSERT_NE(entry, nullptr);
+        EXPECT_EQ(*entry, "two");
+        EXPECT_EQ(cache.lookup(3, "3;"), nullptr);
+        ASSERT_TRUE(cache.save());
+    }
+    ASTCache cache(path);
+    EXPECT_EQ(cache.getNumEntries(), 1u);
+    EXPECT_EQ(cache.lookup(1, "1;"), nullptr);
+    EXPECT_NE(cache.lookup(2, "2;"), nullptr);
+}
+
+TEST(ASTCacheTest, MissesWhenTheKeyCollides) {
+    ASTCache cache(tempPath("ASTCacheTest_collision.bin"));
+    cache.store(1, "def f() 1;", "one");
+    EXPECT_EQ(cache.lookup(1, "def f() 2;"), nullptr);
+    EXPECT_EQ(cache.lookup(1, "def f() 1;\n"), nullptr);
+    EXPECT_NE(cache.lookup(1, "def f() 1;"), nullptr);
+}
+
+TEST(ASTCacheTest, StartsEmptyFromBadFiles) {
+    std::string path = tempPath("ASTCacheTest_bad.bin");
+    {
+        ASTCache cache(path);
+        cache.store(1, "1;", "one");
+        ASSERT_TRUE(cache.save());
+    }
+    std::ifstream file(path, std::ios::binary);
+    std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    writeFile(path, contents.substr(0, contents.size() - 1));
+    EXPECT_EQ(ASTCache(path).getNumEntries(), 0u);
+
+    std::string otherVersion = contents;
+    otherVersion[otherVersion.find('\n') - 1] ^= 1;
+    writeFile(path, otherVersion);
+    EXPECT_EQ(ASTCache(path).getNumEntries(), 0u);
+
+    writeFile(path, "garbage");
+    EXPECT_EQ(ASTCache(path).getNumEntries(), 0u);
+}
+
+TEST(ASTCacheTest, EntriesRoundTripItemsAndDiagnostics) {
+    OperatorTable operators;
+    Lexer lexer(std::string_view("extern sin(x); def f(x) sin(x) * 2; then"), 50);
+    Parser parser(lexer, operators);
+    lexer.advance();
+    auto proto = parser.parseExtern();
+    lexer.advance();
+    auto fcn = parser.parseDefinition();
+    ASSERT_NE(proto, nullptr);
+    ASSERT_NE(fcn, nullptr);
+
+    CacheEntryWriter writer(50);
+    writer.addItem(CachedItemKind::Extern, 63, nullptr, proto.get());
+    writer.addOperators(operators);
+    writer.addItem(CachedItemKind::Definition, 84, fcn.get(), nullptr);
+    writer.addOperators(operators);
+    writer.addItem(CachedItemKind::Error, 90, nullptr, nullptr);
+    writer.addOperators(operators);
+    std::string entry = writer.finish({{86, "Unknown token"}});
+
+    // Read back as if the chunk had moved to offset 0
+    CacheEntryReader reader(entry, 0);
+    std::vector<Diagnostic> diagnostics;
+    ASSERT_TRUE(reader.readDiagnostics(diagnostics));
+    ASSERT_EQ(diagnostics.size(), 1u);
+    EXPECT_EQ(diagnostics[0].loc, 36u);
+    EXPECT_EQ(diagnostics[0].message, "Unknown token");
+
+    CacheEntryReader::Item item;
+    uint64_t fingerprint;
+    ASSERT_TRUE(reader.readItem(item));
+    EXPECT_EQ(item.kind, CachedItemKind::Extern);
+    EXPECT_EQ(item.end, 13u);
+    ASSERT_NE(item.proto, nullptr);
+    EXPECT_EQ(item.proto->getName(), Symbol("sin"));
+    ASSERT_TRUE(reader.readOperators(fingerprint));
+    EXPECT_EQ(fingerprint, operators.getFingerprint());
+
+    ASSERT_TRUE(reader.readItem(item));
+    EXPECT_EQ(item.kind, CachedItemKind::Definition);
+    EXPECT_EQ(item.end, 34u);
+    ASSERT_NE(item.fcn, nullptr);
+    EXPECT_EQ(item.fcn->getBody()->toString(), fcn->getBody()->toString());
+    EXPECT_EQ(item.proto, nullptr);
+    ASSERT_TRUE(reader.readOperators(fingerprint));
+
+    ASSERT_TRUE(reader.readItem(item));
+    EXPECT_EQ(item.kind, CachedItemKind::Error);
+    EXPECT_EQ(item.fcn, nullptr);
+    ASSERT_TRUE(reader.readOperators(fingerprint));
+    EXPECT_TRUE(reader.atEnd());
+}
+
+TEST(ASTCacheTest, RejectsDamagedEntries) {
+    CacheEntryWriter writer(0);
+    FcnPrototype proto("cos", std::vector<Symbol>{"x"});
+    writer.addItem(CachedItemKind::Extern, 14, nullptr, &proto);
+    std::string entry = writer.finish({});
+    entry[1] = 9; // Not an item kind
+
+    CacheEntryReader reader(entry, 0);
+    std::vector<Diagnostic> diagnostics;
+    ASSERT_TRUE(reader.readDiagnostics(diagnostics));
+    CacheEntryReader::Item item;
+    EXPECT_FALSE(reader.readItem(item));
+}
@@ -0,0 +1,35 @@
+#include "gtest/gtest.h"
+
+#include <sstream>
+
+#include "debug/SourceManager.hpp"
+#include "frontend/Diagnostic.hpp"
+
+using namespace lang;
+
+TEST(DiagnosticTest, PrintsFileLineAndColumn) {
+    SourceManager sources("def f(x)\n  x +;\n1 @ 2;");
+    std::vector<Diagnostic> diagnostics = {
+        {14, "Unknown token when expecting an expression"},
+        {18, "Unknown character '@'"},
+    };
+
+    std::ostringstream out;
+    printDiagnostics(out, "test.k", sources, diagnostics);
+    EXPECT_EQ(out.str(), 
+        "test.k:2:6: error: Unknown token when expecting an expression\n"
+        "test.k:3:3: error: Unknown character '@'\n");
+}
+
+TEST(DiagnosticTest, PrintsOffsetWithoutSource) {
+    std::ostringstream out;
+    printDiagnostic(out, "<stdin>", {42, "Expected ')'"});
+    EXPECT_EQ(out.str(), "<stdin>:42: error: Expected ')'\n");
+}
+
+TEST(DiagnosticTest, NothingToPrint) {
+    SourceManager sources("1;");
+    std::ostringstream out;
+    printDiagnostics(out, "test.k", sources, {});
+    EXPECT_TRUE(out.str().empty());
+}
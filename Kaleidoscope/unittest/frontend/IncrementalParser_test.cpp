@@ -0,0 +1,295 @@
+#include "gtest/gtest.h"
+
+#include <string>
+
+#include "frontend/IncrementalParser.hpp"
+
+using namespace lang;
+
+namespace {
+
+using ItemKind = IncrementalParser::ItemKind;
+
+const char* SOURCE = 
+    "def add(x y) x + y;\n"
+    "extern sin(a);\n"
+    "def twice(x) add(x, x);\n"
+    "twice(3);\n"
+    "def square(x) x * x;\n"
+    "square(4) + 1;\n";
+
+std::string describe(const IncrementalParser::Item& item) {
+    std::string result = std::to_string(static_cast<int>(item.kind)) + "@" 
+        + std::to_string(item.begin) + "-" + std::to_string(item.end);
+    if (item.fcn) {
+        result += " " + item.fcn->getBody()->toString() 
+            + " loc " + std::to_string(item.fcn->getBody()->getSourceLoc());
+    }
+    return result;
+}
+
+// An incremental parse must always end up where a fresh one would
+void expectMatchesFreshParse(const IncrementalParser& incremental) {
+    IncrementalParser fresh;
+    fresh.update(incremental.getSource());
+    ASSERT_EQ(incremental.getItems().size(), fresh.getItems().size());
+    for (size_t i = 0; i < fresh.getItems().size(); ++i) {
+        EXPECT_EQ(describe(incremental.getItems()[i]), describe(fresh.getItems()[i])) << "item " << i;
+    }
+}
+
+std::string replace(std::string source, const std::string& from, const std::string& to) {
+    return source.replace(source.find(from), from.size(), to);
+}
+
+} // namespace
+
+TEST(IncrementalParserTest, FirstUpdateParsesEverything) {
+    IncrementalParser parser;
+    auto changed = parser.update(SOURCE);
+    ASSERT_EQ(changed.size(), 6);
+    EXPECT_EQ(changed[0]->kind, ItemKind::Definition);
+    EXPECT_EQ(changed[0]->name, Symbol("add"));
+    EXPECT_EQ(changed[1]->kind, ItemKind::Extern);
+    EXPECT_EQ(changed[1]->name, Symbol("sin"));
+    EXPECT_EQ(changed[2]->callees, std::vector<Symbol>{Symbol("add")});
+    EXPECT_EQ(changed[3]->kind, ItemKind::Expression);
+}
+
+TEST(IncrementalParserTest, UnchangedSourceReparsesNothing) {
+    IncrementalParser parser;
+    parser.update(SOURCE);
+    EXPECT_TRUE(parser.update(SOURCE).empty());
+    EXPECT_EQ(parser.getItems().size(), 6);
+}
+
+TEST(IncrementalParserTest, EditReparsesOnlyTouchedItem) {
+    IncrementalParser parser;
+    parser.update(SOURCE);
+    Fcn* first = parser.getItems()[0].fcn.get();
+    Fcn* last = parser.getItems()[5].fcn.get();
+
+    auto changed = parser.update(replace(SOURCE, "add(x, x)", "add(x, x * 2)"));
+    ASSERT_EQ(changed.size(), 1);
+    EXPECT_EQ(changed[0]->name, Symbol("twice"));
+    EXPECT_EQ(changed[0]->fcn->getBody()->toString(), "add(x, (x * 2))");
+
+    // Untouched items are the same objects, shifted where needed
+    EXPECT_EQ(parser.getItems()[0].fcn.get(), first);
+    EXPECT_EQ(parser.getItems()[5].fcn.get(), last);
+    expectMatchesFreshParse(parser);
+}
+
+TEST(IncrementalParserTest, InsertedItem) {
+    IncrementalParser parser;
+    parser.update(SOURCE);
+    auto changed = parser.update(replace(SOURCE, "twice(3);\n", "twice(3);\nadd(1, 2);\n"));
+    ASSERT_EQ(changed.size(), 1);
+    EXPECT_EQ(changed[0]->fcn->getBody()->toString(), "add(1, 2)");
+    EXPECT_EQ(parser.getItems().size(), 7);
+    expectMatchesFreshParse(parser);
+}
+
+TEST(IncrementalParserTest, DeletedItem) {
+    IncrementalParser parser;
+    parser.update(SOURCE);
+    auto changed = parser.update(replace(SOURCE, "extern sin(a);\n", ""));
+    EXPECT_TRUE(changed.empty());
+    EXPECT_EQ(parser.getItems().size(), 5);
+    expectMatchesFreshParse(parser);
+}
+
+TEST(IncrementalParserTest, AppendedText) {
+    IncrementalParser parser;
+    parser.update(SOURCE);
+    parser.update(std::string(SOURCE) + "square(5);");
+    expectMatchesFreshParse(parser);
+    EXPECT_EQ(parser.getItems().size(), 7);
+}
+
+TEST(IncrementalParserTest, EditMergingTokens) {
+    IncrementalParser parser;
+    parser.update("foo;bar;baz;");
+    auto changed = parser.update("foo;barx;baz;");
+    ASSERT_EQ(changed.size(), 1);
+    EXPECT_EQ(changed[0]->fcn->getBody()->toString(), "barx");
+    expectMatchesFreshParse(parser);
+
+    // "bar" and "baz" become one identifier, nothing can be kept after it
+    changed = parser.update("foo;barxbaz;");
+    ASSERT_EQ(changed.size(), 1);
+    EXPECT_EQ(changed[0]->fcn->getBody()->toString(), "barxbaz");
+    expectMatchesFreshParse(parser);
+}
+
+TEST(IncrementalParserTest, CommentHidesRestOfLine) {
+    IncrementalParser parser;
+    parser.update("a; b; c;\nd;\n");
+    auto changed = parser.update("a; # b; c;\nd;\n");
+    EXPECT_TRUE(changed.empty());
+    EXPECT_EQ(parser.getItems().size(), 2);
+    expectMatchesFreshParse(parser);
+}
+
+TEST(IncrementalParserTest, ItemSpanningEditIsReparsed) {
+    IncrementalParser parser;
+    parser.update("def f(x)\n  x +\n  1;\nf(2);\n");
+    auto changed = parser.update("def f(x)\n  x *\n  1;\nf(2);\n");
+    ASSERT_EQ(changed.size(), 1);
+    EXPECT_EQ(changed[0]->fcn->getBody()->toString(), "(x * 1)");
+    expectMatchesFreshParse(parser);
+}
+
+TEST(IncrementalParserTest, OperatorDefinitionReparsesRest) {
+    IncrementalParser parser;
+    parser.update("def binary| 5 (a b) a;\nfoo(1);\nbar(2);\n");
+    auto changed = parser.update("def binary| 6 (a b) a;\nfoo(1);\nbar(2);\n");
+    EXPECT_EQ(changed.size(), 3);
+    expectMatchesFreshParse(parser);
+}
+
+TEST(IncrementalParserTest, OperatorsApplyToLaterItemsOnly) {
+    IncrementalParser parser;
+    std::string source = "a(1 | 2);\ndef binary| 5 (x y) x;\nb(1 | 2);\n";
+    parser.update(source);
+    ASSERT_EQ(parser.getItems().size(), 3u);
+    EXPECT_EQ(parser.getItems()[0].kind, ItemKind::Error);
+    EXPECT_EQ(parser.getItems()[2].fcn->getBody()->toString(), "b((1 | 2))");
+
+    // Re-parsing the first item must not see the operator defined below it
+    parser.update(replace(source, "a(1 | 2)", "a(1 | 3)"));
+    EXPECT_EQ(parser.getItems()[0].kind, ItemKind::Error);
+    expectMatchesFreshParse(parser);
+}
+
+TEST(IncrementalParserTest, RemovedOperatorDefinitionIsUndone) {
+    IncrementalParser parser;
+    std::string source = "def binary| 5 (x y) x;\nb(1 | 2);\nc(3);\n";
+    parser.update(source);
+    EXPECT_EQ(parser.getOperators().getPrecedence('|'), 5);
+
+    auto changed = parser.update(replace(source, "def binary| 5 (x y) x;\n", ""));
+    EXPECT_EQ(parser.getOperators().getPrecedence('|'), -1);
+    ASSERT_FALSE(changed.empty());
+    EXPECT_EQ(changed[0]->kind, ItemKind::Error);
+    expectMatchesFreshParse(parser);
+
+    // Items after the one that no longer uses it are kept again
+    parser.update(source);
+    changed = parser.update(replace(source, "b(1 | 2)", "b(2)"));
+    ASSERT_EQ(changed.size(), 1u);
+    EXPECT_EQ(changed[0]->fcn->getBody()->toString(), "b(2)");
+    EXPECT_EQ(parser.getOperators().getPrecedence('|'), 5);
+    expectMatchesFreshParse(parser);
+}
+
+TEST(IncrementalParserTest, ParseErrorsAreItemsToo) {
+    IncrementalParser parser;
+    parser.update("def (x) x;\nfoo(1);\n");
+    bool sawError = false;
+    for (const auto& item : parser.getItems()) {
+        sawError |= item.kind == ItemKind::Error;
+    }
+    EXPECT_TRUE(sawError);
+
+    auto changed = parser.update("def f(x) x;\nfoo(1);\n");
+    expectMatchesFreshParse(parser);
+    ASSERT_FALSE(changed.empty());
+    EXPECT_EQ(changed[0]->name, Symbol("f"));
+}
+
+TEST(IncrementalParserTest, EditExtendingTokenAfterErrorItem) {
+    // The broken item stops at the keyword, which the edit turns into an
+    // identifier the item would have swallowed
+    IncrementalParser parser;
+    parser.update("1 + ) def f(x) x;\n");
+    parser.update("1 + ) define(x) x;\n");
+    expectMatchesFreshParse(parser);
+
+    parser.update("1 + ) extern g(x);\n");
+    parser.update("1 + ) externs(x);\n");
+    expectMatchesFreshParse(parser);
+}
+
+TEST(IncrementalParserTest, EditRightAfterStopTokenKeepsItem) {
+    IncrementalParser parser;
+    parser.update("1 + ) def f(x) x;\n");
+    ASSERT_EQ(parser.getItems()[0].kind, ItemKind::Error);
+
+    auto changed = parser.update("1 + ) def g(x) x;\n");
+    ASSERT_EQ(changed.size(), 1u);
+    EXPECT_EQ(changed[0]->name, Symbol("g"));
+    expectMatchesFreshParse(parser);
+}
+
+TEST(IncrementalParserTest, DiagnosticsFollowTheirItems) {
+    IncrementalParser parser;
+    std::string source = "def f(x) then;\nfoo(1);\ng(then);\n";
+    parser.update(source);
+    std::vector<Diagnostic> diagnostics = parser.getDiagnostics();
+    ASSERT_EQ(diagnostics.size(), 2u);
+    EXPECT_EQ(diagnostics[0].loc, source.find("then"));
+    EXPECT_EQ(diagnostics[1].loc, source.find("then", 10));
+
+    // Fixing one drops its error, the other moves with its item
+    source = replace(source, "then", "x + 100");
+    parser.update(source);
+    diagnostics = parser.getDiagnostics();
+    ASSERT_EQ(diagnostics.size(), 1u);
+    EXPECT_EQ(diagnostics[0].loc, source.find("then"));
+
+    // Breaking one again reports it again
+    source = replace(source, "foo(1)", "foo(1");
+    parser.update(source);
+    EXPECT_EQ(parser.getDiagnostics().size(), 2u);
+    IncrementalParser fresh;
+    fresh.update(source);
+    ASSERT_EQ(fresh.getDiagnostics().size(), 2u);
+    EXPECT_EQ(parser.getDiagnostics()[0].loc, fresh.getDiagnostics()[0].loc);
+    EXPECT_EQ(parser.getDiagnostics()[1].loc, fresh.getDiagnostics()[1].loc);
+}
+
+TEST(IncrementalParserTest, LexerErrorsBelongToTheirItem) {
+    IncrementalParser parser;
+    parser.update("a;\n1e;\nb;\n");
+    ASSERT_EQ(parser.getDiagnostics().size(), 1u);
+    EXPECT_EQ(parser.getDiagnostics()[0].loc, 3u);
+
+    // Only the first item changes, the error stays with the second one
+    parser.update("aa;\n1e;\nb;\n");
+    ASSERT_EQ(parser.getDiagnostics().size(), 1u);
+    EXPECT_EQ(parser.getDiagnostics()[0].loc, 4u);
+    ASSERT_EQ(parser.getItems().size(), 3u);
+    EXPECT_EQ(parser.getItems()[0].diagnostics.size(), 0u);
+}
+
+TEST(IncrementalParserTest, EmptySource) {
+    IncrementalParser parser;
+    EXPECT_TRUE(parser.update("").empty());
+    parser.update(SOURCE);
+    EXPECT_TRUE(parser.update("").empty());
+    EXPECT_TRUE(parser.getItems().empty());
+}
+
+TEST(IncrementalParserTest, DeepExpression) {
+    // Collecting callees and shifting locations must not recurse
+    std::string source = "def f(x) ";
+    for (int i = 0; i < 1000000; ++i) {
+        source += "g(x)+";
+    }
+    source += "1;\n2;\n";
+
+    IncrementalParser parser;
+    parser.update(source);
+    ASSERT_EQ(parser.getItems().size(), 2u);
+    EXPECT_EQ(parser.getItems()[0].kind, ItemKind::Definition);
+    EXPECT_EQ(parser.getItems()[0].callees.size(), 1000000u);
+
+    // Only the prefix changes, the deep item after it is shifted
+    auto changed = parser.update("3;\n" + source);
+    ASSERT_EQ(changed.size(), 1u);
+    ASSERT_EQ(parser.getItems().size(), 3u);
+    EXPECT_EQ(parser.getItems()[1].begin, 3u);
+    // The last +
+    EXPECT_EQ(parser.getItems()[1].fcn->getBody()->getSourceLoc(), parser.getItems()[1].begin + 9 + 5 * 999999 + 4);
+}
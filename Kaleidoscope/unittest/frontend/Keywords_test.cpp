@@ -0,0 +1,46 @@
+#include "gtest/gtest.h"
+
+#include "frontend/Keywords.hpp"
+
+using namespace lang;
+
+static_assert(lookupKeyword("def") == tok_def);
+static_assert(lookupKeyword("var") == tok_var);
+static_assert(lookupKeyword("foo") == tok_identifier);
+
+TEST(KeywordsTest, EveryKeywordIsRecognized) {
+    for (const auto& kw : KEYWORDS) {
+        EXPECT_EQ(lookupKeyword(kw.spelling), kw.token) << kw.spelling;
+    }
+}
+
+TEST(KeywordsTest, KeywordPrefixesAndSuffixesAreIdentifiers) {
+    for (const auto& kw : KEYWORDS) {
+        std::string word(kw.spelling);
+        EXPECT_EQ(lookupKeyword(word.substr(0, word.size() - 1)), tok_identifier) << word;
+        EXPECT_EQ(lookupKeyword(word + "x"), tok_identifier) << word;
+        EXPECT_EQ(lookupKeyword("x" + word), tok_identifier) << word;
+    }
+}
+
+TEST(KeywordsTest, SameShapeIdentifiersAreNotKeywords) {
+    // Same length, first and last character as a keyword
+    EXPECT_EQ(lookupKeyword("dxf"), tok_identifier);
+    EXPECT_EQ(lookupKeyword("eXXXXn"), tok_identifier);
+    EXPECT_EQ(lookupKeyword("iN"), tok_identifier);
+    EXPECT_EQ(lookupKeyword("Def"), tok_identifier);
+}
+
+TEST(KeywordsTest, EmptyAndLongWordsAreIdentifiers) {
+    EXPECT_EQ(lookupKeyword(""), tok_identifier);
+    EXPECT_EQ(lookupKeyword("averyveryverylongidentifiername"), tok_identifier);
+}
+
+TEST(KeywordsTest, TopLevelItemsStartWithDefOrExtern) {
+    EXPECT_TRUE(startsTopLevelItem("def f(x) x;"));
+    EXPECT_TRUE(startsTopLevelItem("extern(sin)"));
+    EXPECT_TRUE(startsTopLevelItem("def"));
+    EXPECT_FALSE(startsTopLevelItem("define;"));
+    EXPECT_FALSE(startsTopLevelItem(" def f(x) x;"));
+    EXPECT_FALSE(startsTopLevelItem("de"));
+}
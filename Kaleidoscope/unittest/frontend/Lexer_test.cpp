@@ -50,10 +50,67 @@ TEST(LexerTest, RecognizesNumberWithDecimal) {
     EXPECT_DOUBLE_EQ(lexer.getNumVal(), 0.123);
 }
 
-TEST(LexerTest, BreaksOnExtraDecimal) {
+TEST(LexerTest, ReportsExtraDecimal) {
     std::istringstream iss("0.123.456");
     Lexer lexer(iss);
-    EXPECT_DEATH(lexer.advance(), "multiple decimals");
+    EXPECT_EQ(lexer.advance(), tok_error);
+    ASSERT_EQ(lexer.getDiagnostics().size(), 1);
+    EXPECT_NE(lexer.getDiagnostics()[0].message.find("multiple decimal points"), std::string::npos);
+    EXPECT_EQ(lexer.advance(), tok_eof);
+}
+
+TEST(LexerTest, RecognizesExponent) {
+    std::istringstream iss("1.5e3 2E-2 7e+1");
+    Lexer lexer(iss);
+    EXPECT_EQ(lexer.advance(), tok_number);
+    EXPECT_DOUBLE_EQ(lexer.getNumVal(), 1500);
+    EXPECT_EQ(lexer.advance(), tok_number);
+    EXPECT_DOUBLE_EQ(lexer.getNumVal(), 0.02);
+    EXPECT_EQ(lexer.advance(), tok_number);
+    EXPECT_DOUBLE_EQ(lexer.getNumVal(), 70);
+}
+
+TEST(LexerTest, RecognizesHexFloat) {
+    std::istringstream iss("0x1.8p3 0xff");
+    Lexer lexer(iss);
+    EXPECT_EQ(lexer.advance(), tok_number);
+    EXPECT_DOUBLE_EQ(lexer.getNumVal(), 12);
+    EXPECT_EQ(lexer.advance(), tok_number);
+    EXPECT_DOUBLE_EQ(lexer.getNumVal(), 255);
+}
+
+TEST(LexerTest, RecognizesDigitSeparators) {
+    std::istringstream iss("1_000_000.000_5");
+    Lexer lexer(iss);
+    EXPECT_EQ(lexer.advance(), tok_number);
+    EXPECT_DOUBLE_EQ(lexer.getNumVal(), 1000000.0005);
+}
+
+TEST(LexerTest, SignOnlyFollowsExponent) {
+    std::istringstream iss("1-2");
+    Lexer lexer(iss);
+    EXPECT_EQ(lexer.advance(), tok_number);
+    EXPECT_EQ(lexer.advance(), '-');
+    EXPECT_EQ(lexer.advance(), tok_number);
+    EXPECT_TRUE(lexer.getDiagnostics().empty());
+}
+
+TEST(LexerTest, ReportsMalformedNumberAndContinues) {
+    std::istringstream iss("12ab + 3");
+    Lexer lexer(iss);
+    EXPECT_EQ(lexer.advance(), tok_error);
+    EXPECT_EQ(lexer.advance(), '+');
+    EXPECT_EQ(lexer.advance(), tok_number);
+    EXPECT_DOUBLE_EQ(lexer.getNumVal(), 3);
+    ASSERT_EQ(lexer.getDiagnostics().size(), 1);
+    EXPECT_EQ(lexer.getDiagnostics()[0].loc, 0);
+}
+
+TEST(LexerTest, ReportsOverlongNumber) {
+    std::istringstream iss(std::string(MAX_NUMBER_LENGTH + 1, '1'));
+    Lexer lexer(iss);
+    EXPECT_EQ(lexer.advance(), tok_error);
+    EXPECT_EQ(lexer.advance(), tok_eof);
 }
 
 TEST(LexerTest, RecognizesSingleCharToken) {
@@ -246,3 +303,92 @@ TEST(LexerTest, ConsumeWorksWithNumberAndIdentifier) {
     lexer.consume(tok_identifier);
     EXPECT_EQ(lexer.advance(), tok_eof);
 }
+
+// Buffer backend tests, the buffer backend must be indistinguishable
+// from the stream backend
+TEST(LexerBufferTest, RecognizesEOF) {
+    Lexer lexer(std::string_view(""));
+    EXPECT_EQ(lexer.advance(), tok_eof);
+    EXPECT_EQ(lexer.advance(), tok_eof);
+}
+
+TEST(LexerBufferTest, RecognizesIdentifierAtEndOfBuffer) {
+    Lexer lexer(std::string_view("foo123"));
+    EXPECT_EQ(lexer.advance(), tok_identifier);
+    EXPECT_EQ(lexer.getIdentifierStr(), "foo123");
+    EXPECT_EQ(lexer.advance(), tok_eof);
+}
+
+TEST(LexerBufferTest, DoesNotReadPastView) {
+    std::string source = "foo bar";
+    Lexer lexer(std::string_view(source).substr(0, 5));
+    EXPECT_EQ(lexer.advance(), tok_identifier);
+    EXPECT_EQ(lexer.getIdentifierStr(), "foo");
+    EXPECT_EQ(lexer.advance(), tok_identifier);
+    EXPECT_EQ(lexer.getIdentifierStr(), "b");
+    EXPECT_EQ(lexer.advance(), tok_eof);
+}
+
+TEST(LexerBufferTest, ReportsExtraDecimal) {
+    Lexer lexer(std::string_view("0.123.456"));
+    EXPECT_EQ(lexer.advance(), tok_error);
+    ASSERT_EQ(lexer.getDiagnostics().size(), 1);
+    EXPECT_NE(lexer.getDiagnostics()[0].message.find("multiple decimal points"), std::string::npos);
+}
+
+TEST(LexerBufferTest, ReportsOverlongNumber) {
+    std::string source(MAX_NUMBER_LENGTH + 1, '1');
+    Lexer lexer{std::string_view(source)};
+    EXPECT_EQ(lexer.advance(), tok_error);
+    EXPECT_EQ(lexer.advance(), tok_eof);
+}
+
+class LexerBackendTest : public testing::TestWithParam<const char*> {};
+
+TEST_P(LexerBackendTest, BackendsProduceIdenticalTokens) {
+    std::istringstream iss(GetParam());
+    Lexer streamLexer(iss);
+    Lexer bufferLexer{std::string_view(GetParam())};
+
+    while (true) {
+        Token tok = streamLexer.advance();
+        ASSERT_EQ(bufferLexer.advance(), tok);
+        EXPECT_EQ(bufferLexer.getCurrentOffset(), streamLexer.getCurrentOffset());
+        if (tok == tok_identifier) {
+            EXPECT_EQ(bufferLexer.getIdentifierStr(), streamLexer.getIdentifierStr());
+        } else if (tok == tok_number) {
+            EXPECT_DOUBLE_EQ(bufferLexer.getNumVal(), streamLexer.getNumVal());
+        } else if (tok == tok_eof) {
+            break;
+        }
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(LexerTest, LexerBackendTest, testing::Values(
+    "",
+    "   ",
+    "def foo(x y) x + y;",
+    "# only a comment",
+    "extern sin(a);\n# comment\r\nsin(1.5)",
+    "def fib(x)\n  if x < 3 then\n    1\n  else\n    fib(x-1)+fib(x-2);\n\nfib(10);",
+    "var a = 1, b = 2 in\n\tfor i = 0, i < 10 in a = a + b",
+    "def binary| 5 (LHS RHS) if LHS then 1 else if RHS then 1 else 0;",
+    "foo123bar 0.5 .5 42. \x7f\xff",
+    "                                        \n\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\tdef\v\f\r\n",
+    "# a comment that is longer than a single thirty-two byte vector\r\n# another\nx",
+    "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789 tail",
+    "#",
+    "1e10 2.5E-3 0x1.8p3 0xFF_FF 1_000 1-2 3e+x 0.1.2 12ab ."
+));
+
+TEST(LexerTest, InternsIdentifiers) {
+    std::istringstream iss("foo bar foo");
+    Lexer lexer(iss);
+    EXPECT_EQ(lexer.advance(), tok_identifier);
+    Symbol foo = lexer.getIdentifier();
+    EXPECT_EQ(lexer.advance(), tok_identifier);
+    EXPECT_NE(lexer.getIdentifier(), foo);
+    EXPECT_EQ(lexer.advance(), tok_identifier);
+    EXPECT_EQ(lexer.getIdentifier(), foo);
+    EXPECT_EQ(foo.str(), "foo");
+}
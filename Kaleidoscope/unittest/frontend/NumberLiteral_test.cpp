@@ -0,0 +1,99 @@
+#include "gtest/gtest.h"
+
+#include <string>
+
+#include "frontend/NumberLiteral.hpp"
+
+using namespace lang;
+
+namespace {
+
+double parse(std::string_view text) {
+    double value = -1;
+    const char* error = parseNumberLiteral(text, value);
+    EXPECT_EQ(error, nullptr) << text << ": " << error;
+    return value;
+}
+
+const char* parseError(std::string_view text) {
+    double value;
+    return parseNumberLiteral(text, value);
+}
+
+size_t scannedLength(std::string_view text) {
+    NumberScanner scanner(text[0]);
+    size_t length = 1;
+    while (length < text.size() && scanner.accept(static_cast<unsigned char>(text[length]))) {
+        ++length;
+    }
+    return length;
+}
+
+} // namespace
+
+TEST(NumberLiteralTest, ParsesDecimal) {
+    EXPECT_DOUBLE_EQ(parse("0"), 0);
+    EXPECT_DOUBLE_EQ(parse("42"), 42);
+    EXPECT_DOUBLE_EQ(parse("0123"), 123);
+    EXPECT_DOUBLE_EQ(parse("3.25"), 3.25);
+    EXPECT_DOUBLE_EQ(parse(".5"), 0.5);
+    EXPECT_DOUBLE_EQ(parse("5."), 5);
+}
+
+TEST(NumberLiteralTest, ParsesExponent) {
+    EXPECT_DOUBLE_EQ(parse("1e3"), 1000);
+    EXPECT_DOUBLE_EQ(parse("2.5E-2"), 0.025);
+    EXPECT_DOUBLE_EQ(parse("1.e+2"), 100);
+    EXPECT_DOUBLE_EQ(parse(".5e1"), 5);
+}
+
+TEST(NumberLiteralTest, ParsesHex) {
+    EXPECT_DOUBLE_EQ(parse("0xff"), 255);
+    EXPECT_DOUBLE_EQ(parse("0X1p4"), 16);
+    EXPECT_DOUBLE_EQ(parse("0x1.8p3"), 12);
+    EXPECT_DOUBLE_EQ(parse("0x.8p-1"), 0.25);
+    EXPECT_DOUBLE_EQ(parse("0x1ep1"), 60);
+}
+
+TEST(NumberLiteralTest, ParsesDigitSeparators) {
+    EXPECT_DOUBLE_EQ(parse("1_000_000"), 1000000);
+    EXPECT_DOUBLE_EQ(parse("0.000_001"), 0.000001);
+    EXPECT_DOUBLE_EQ(parse("1e1_0"), 1e10);
+    EXPECT_DOUBLE_EQ(parse("0xF_F"), 255);
+}
+
+TEST(NumberLiteralTest, RejectsMalformedLiterals) {
+    EXPECT_STREQ(parseError("1.2.3"), "multiple decimal points in numeric literal");
+    EXPECT_STREQ(parseError("12ab"), "invalid character in numeric literal");
+    EXPECT_STREQ(parseError("1e"), "expected digits in exponent");
+    EXPECT_STREQ(parseError("1e+"), "expected digits in exponent");
+    EXPECT_STREQ(parseError("."), "expected digits in numeric literal");
+    EXPECT_STREQ(parseError("0x"), "expected digits in numeric literal");
+    EXPECT_STREQ(parseError("0x1.8"), "hexadecimal floating literal requires an exponent");
+    EXPECT_STREQ(parseError("1e1.5"), "invalid character in numeric literal");
+}
+
+TEST(NumberLiteralTest, RejectsMisplacedSeparators) {
+    for (const char* text : {"1_", "1__0", "1_.5", "1._5", "1_e5", "0x_1", "1e_5"}) {
+        EXPECT_STREQ(parseError(text), "digit separator must be between two digits") << text;
+    }
+}
+
+TEST(NumberLiteralTest, RejectsOutOfRange) {
+    EXPECT_STREQ(parseError("1e999"), "numeric literal is out of range");
+}
+
+TEST(NumberLiteralTest, RejectsOverlongLiteral) {
+    EXPECT_STREQ(parseError(std::string(MAX_NUMBER_LENGTH + 1, '1')), "numeric literal is too long");
+    EXPECT_EQ(parseError(std::string(MAX_NUMBER_LENGTH, '1')), nullptr);
+}
+
+TEST(NumberLiteralTest, ScannerStopsAtOperators) {
+    EXPECT_EQ(scannedLength("12+3"), 2);
+    EXPECT_EQ(scannedLength("1e+3*2"), 4);
+    EXPECT_EQ(scannedLength("1.5E-3)"), 6);
+    EXPECT_EQ(scannedLength("0x1e+3"), 4);
+    EXPECT_EQ(scannedLength("0x1p-3 "), 6);
+    EXPECT_EQ(scannedLength("1_000,"), 5);
+    EXPECT_EQ(scannedLength("1.2.3;"), 5);
+}
@@ -0,0 +1,180 @@
+#include "gtest/gtest.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "frontend/ParallelParser.hpp"
+#include "frontend/Parser.hpp"
+
+using namespace lang;
+
+namespace {
+
+using ItemKind = ParallelParser::ItemKind;
+
+std::string describe(ItemKind kind, SourceOffset begin, const Fcn* fcn, const FcnPrototype* proto) {
+    std::string result = std::to_string(static_cast<int>(kind)) + "@" + std::to_string(begin);
+    if (fcn) {
+        result += " " + std::string(fcn->getName().str()) + " " + fcn->getBody()->toString();
+    }
+    if (proto) {
+        result += " " + std::string(proto->getName().str());
+    }
+    return result;
+}
+
+// Parses like Driver::MainLoop, registering binary operators as codegen would
+std::vector<std::string> parseSequentially(const TokenStream& tokens) {
+    OperatorTable operators;
+    Lexer lexer(tokens);
+    Parser parser(lexer, operators);
+    lexer.advance();
+
+    std::vector<std::string> items;
+    while (lexer.getCurrentToken() != tok_eof) {
+        if (lexer.getCurrentToken() == tok_semicolon) {
+            lexer.advance();
+            continue;
+        }
+
+        SourceOffset begin = lexer.getCurrentOffset();
+        if (lexer.getCurrentToken() == tok_def) {
+            auto fcn = parser.parseDefinition();
+            if (fcn && fcn->getPrototype()->isBinaryOp()) {
+                FcnPrototype* proto = fcn->getPrototype();
+                operators.setBinaryOperator(proto->getOperatorName(), proto->getBinaryPrecedence());
+            }
+            items.push_back(fcn ? describe(ItemKind::Definition, begin, fcn.get(), nullptr)
+                                : describe(ItemKind::Error, begin, nullptr, nullptr));
+        } else if (lexer.getCurrentToken() == tok_extern) {
+            auto proto = parser.parseExtern();
+            items.push_back(proto ? describe(ItemKind::Extern, begin, nullptr, proto.get())
+                                  : describe(ItemKind::Error, begin, nullptr, nullptr));
+        } else {
+            auto fcn = parser.parseTopLevelExpr();
+            items.push_back(fcn ? describe(ItemKind::Expression, begin, fcn.get(), nullptr)
+                                : describe(ItemKind::Error, begin, nullptr, nullptr));
+        }
+        if (items.back().starts_with(std::to_string(static_cast<int>(ItemKind::Error)))) {
+            parser.synchronize();
+        }
+    }
+    return items;
+}
+
+std::vector<std::string> parseInParallel(const TokenStream& tokens, unsigned jobs) {
+    ParallelParser parallel(tokens, OperatorTable::builtins());
+    std::vector<std::string> items;
+    for (const ParallelParser::Item& item : parallel.parse(jobs)) {
+        items.push_back(describe(item.kind, item.begin, item.fcn.get(), item.proto.get()));
+    }
+    return items;
+}
+
+TokenStream lex(std::string_view source) {
+    Lexer lexer(source);
+    return TokenStream(lexer);
+}
+
+std::string makeSource() {
+    std::string source = "1 + 2;\n";
+    for (int i = 0; i < 300; ++i) {
+        std::string n = std::to_string(i);
+        source += "def f" + n + "(x y) if x < " + n + " then x * y else f" + n + "(x - 1, y);\n";
+        source += "extern g" + n + "(a);\n";
+        source += "f" + n + "(" + n + ", 2) + g" + n + "(1);;\n";
+        if (i == 100) {
+            source += "def binary | 5 (a b) if a then 1 else b;\n";
+            source += "def binary ^ (a b) a * b;\n";
+        }
+        if (i >= 100) {
+            source += "1 | 2 ^ 3 + 4 * 5;\n";
+        }
+    }
+    return source;
+}
+
+} // namespace
+
+TEST(ParallelParserTest, MatchesSequentialParse) {
+    TokenStream tokens = lex(makeSource());
+    std::vector<std::string> expected = parseSequentially(tokens);
+    ASSERT_GT(expected.size(), 900u);
+
+    for (unsigned jobs : {1u, 2u, 3u, 8u, 64u}) {
+        SCOPED_TRACE(jobs);
+        EXPECT_EQ(parseInParallel(tokens, jobs), expected);
+    }
+}
+
+TEST(ParallelParserTest, SplitsAtDefAndExtern) {
+    TokenStream tokens = lex("1; 2; def f(x) x; extern g(y); g(1); f(2);");
+    ParallelParser parallel(tokens, OperatorTable::builtins());
+    EXPECT_EQ(parallel.getNumSegments(), 3u);
+
+    auto items = parallel.parse(4);
+    ASSERT_EQ(items.size(), 6u);
+    EXPECT_EQ(items[2].kind, ItemKind::Definition);
+    EXPECT_EQ(items[3].kind, ItemKind::Extern);
+    EXPECT_EQ(items[5].kind, ItemKind::Expression);
+    EXPECT_EQ(items[5].fcn->getBody()->toString(), "f(2)");
+}
+
+TEST(ParallelParserTest, OperatorsApplyAfterTheirDefinition) {
+    TokenStream tokens = lex(
+        "1 % 2;\n"
+        "def binary % 50 (a b) a % b;\n"
+        "1 + 2 % 3;\n");
+    auto items = ParallelParser(tokens, OperatorTable::builtins()).parse(2);
+    ASSERT_EQ(items.size(), 5u);
+
+    // Before the definition `%` is no binary operator, the rest of the item
+    // parses as a unary one. The definition's own body does not see it either.
+    EXPECT_EQ(items[0].fcn->getBody()->toString(), "1");
+    EXPECT_EQ(items[1].fcn->getBody()->toString(), "%2");
+    EXPECT_EQ(items[2].kind, ItemKind::Definition);
+    EXPECT_EQ(items[2].fcn->getBody()->toString(), "a");
+    EXPECT_EQ(items[3].fcn->getBody()->toString(), "%b");
+    EXPECT_EQ(items[4].fcn->getBody()->toString(), "(1 + (2 % 3))");
+}
+
+TEST(ParallelParserTest, StartsFromTheGivenOperators) {
+    OperatorTable operators;
+    operators.setBinaryOperator('%', 50);
+    TokenStream tokens = lex("1 + 2 % 3;");
+    auto items = ParallelParser(tokens, operators).parse(1);
+    ASSERT_EQ(items.size(), 1u);
+    EXPECT_EQ(items[0].fcn->getBody()->toString(), "(1 + (2 % 3))");
+}
+
+TEST(ParallelParserTest, ErrorsDoNotSpillIntoTheNextDefinition) {
+    TokenStream tokens = lex("1 + ; def f(x) x;");
+    auto items = ParallelParser(tokens, OperatorTable::builtins()).parse(2);
+    ASSERT_FALSE(items.empty());
+    EXPECT_EQ(items.front().kind, ItemKind::Error);
+    EXPECT_EQ(items.back().kind, ItemKind::Definition);
+    EXPECT_EQ(items.back().fcn->getName(), "f");
+}
+
+TEST(ParallelParserTest, CollectsDiagnosticsInSourceOrder) {
+    std::string source;
+    for (int i = 0; i < 200; ++i) {
+        source += "def f" + std::to_string(i) + "(x) x + ;\n";
+    }
+    TokenStream tokens = lex(source);
+    ParallelParser parallel(tokens, OperatorTable::builtins());
+    parallel.parse(8);
+
+    ASSERT_EQ(parallel.getDiagnostics().size(), 200u);
+    for (size_t i = 1; i < parallel.getDiagnostics().size(); ++i) {
+        EXPECT_LT(parallel.getDiagnostics()[i - 1].loc, parallel.getDiagnostics()[i].loc);
+    }
+}
+
+TEST(ParallelParserTest, EmptySource) {
+    TokenStream tokens = lex("");
+    ParallelParser parallel(tokens, OperatorTable::builtins());
+    EXPECT_EQ(parallel.getNumSegments(), 0u);
+    EXPECT_TRUE(parallel.parse(4).empty());
+}
@@ -1,4 +1,5 @@
 #include <gtest/gtest.h>
+#include <cstdio>
 #include <sstream>
 #include "frontend/Parser.hpp"
 
@@ -281,6 +282,52 @@ TEST(Parser, ParseUnknownTokenError) {
     EXPECT_EQ(expr, nullptr);
 }
 
+TEST(Parser, ErrorsAreRecordedWithTheirLocation) {
+    Lexer lexer(std::string_view("def f(x) x +\nthen 1;"));
+    lexer.advance();
+    Parser parser(lexer);
+
+    EXPECT_EQ(parser.parseDefinition(), nullptr);
+    // Only the innermost error, not one for every caller that gave up
+    ASSERT_EQ(parser.getDiagnostics().size(), 1);
+    EXPECT_EQ(parser.getDiagnostics()[0].loc, 13);
+    EXPECT_EQ(parser.getDiagnostics()[0].message, "Unknown token when expecting an expression");
+}
+
+TEST(Parser, SynchronizeSkipsToTheNextItem) {
+    std::istringstream input("foo(1 2 3) + bar(4); def g(x) x; 1 + ) ) ) extern h(); 5");
+    Lexer lexer(input);
+    lexer.advance();
+    Parser parser(lexer);
+
+    EXPECT_EQ(parser.parseTopLevelExpr(), nullptr);
+    parser.synchronize();
+    EXPECT_EQ(lexer.getCurrentToken(), tok_semicolon);
+    lexer.consume(tok_semicolon);
+    ASSERT_NE(parser.parseDefinition(), nullptr);
+
+    lexer.consume(tok_semicolon);
+    EXPECT_EQ(parser.parseTopLevelExpr(), nullptr);
+    parser.synchronize();
+    EXPECT_EQ(lexer.getCurrentToken(), tok_extern);
+    ASSERT_NE(parser.parseExtern(), nullptr);
+
+    lexer.consume(tok_semicolon);
+    ASSERT_NE(parser.parseTopLevelExpr(), nullptr);
+    EXPECT_EQ(parser.getDiagnostics().size(), 2);
+}
+
+TEST(Parser, LexerErrorsAreNotReportedAgain) {
+    std::istringstream input("1 + 0x;");
+    Lexer lexer(input);
+    lexer.advance();
+    Parser parser(lexer);
+
+    EXPECT_EQ(parser.parseTopLevelExpr(), nullptr);
+    EXPECT_EQ(lexer.getDiagnostics().size(), 1);
+    EXPECT_TRUE(parser.getDiagnostics().empty());
+}
+
 TEST(Parser, ParseCallExprMissingClosingParen) {
     std::istringstream input("foo(1, 2");
     Lexer lexer(input);
@@ -612,6 +659,348 @@ TEST(Parser, ParseVarExprNoCommaInList) {
     EXPECT_FALSE(fcn);
 }
 
+TEST(Parser, AssignmentIsRightAssociative) {
+    std::istringstream input("a = b = c + 1");
+    Lexer lexer(input);
+    lexer.advance();
+    Parser parser(lexer);
+
+    auto fcn = parser.parseTopLevelExpr();
+    ASSERT_NE(fcn, nullptr);
+    EXPECT_EQ(fcn->getBody()->toString(), "(a = (b = (c + 1)))");
+}
+
+TEST(Parser, SubtractionIsLeftAssociative) {
+    std::istringstream input("a - b - c");
+    Lexer lexer(input);
+    lexer.advance();
+    Parser parser(lexer);
+
+    auto fcn = parser.parseTopLevelExpr();
+    ASSERT_NE(fcn, nullptr);
+    EXPECT_EQ(fcn->getBody()->toString(), "((a - b) - c)");
+}
+
+TEST(Parser, UsesSessionOperatorTable) {
+    OperatorTable operators;
+    operators.setBinaryOperator('|', 50);
+
+    std::istringstream input("a + b | c");
+    Lexer lexer(input);
+    lexer.advance();
+    Parser parser(lexer, operators);
+
+    auto fcn = parser.parseTopLevelExpr();
+    ASSERT_NE(fcn, nullptr);
+    EXPECT_EQ(fcn->getBody()->toString(), "(a + (b | c))");
+
+    // Other sessions only know the builtins
+    std::istringstream other("a + b | c");
+    Lexer otherLexer(other);
+    otherLexer.advance();
+    Parser builtinParser(otherLexer);
+    auto partial = builtinParser.parseTopLevelExpr();
+    ASSERT_NE(partial, nullptr);
+    EXPECT_EQ(partial->getBody()->toString(), "(a + b)");
+}
+
+TEST(Parser, MixedPrecedenceAndPrefixOperators) {
+    std::istringstream input("-a * (b + !c) < d - e * f + g");
+    Lexer lexer(input);
+    lexer.advance();
+    Parser parser(lexer);
+
+    auto fcn = parser.parseTopLevelExpr();
+    ASSERT_NE(fcn, nullptr);
+    EXPECT_EQ(fcn->getBody()->toString(), "((-a * (b + !c)) < ((d - (e * f)) + g))");
+}
+
+TEST(Parser, UnbalancedParenFails) {
+    std::istringstream input("((a + b) * c");
+    Lexer lexer(input);
+    lexer.advance();
+    Parser parser(lexer);
+
+    EXPECT_EQ(parser.parseTopLevelExpr(), nullptr);
+}
+
+TEST(Parser, CloseParenEndsCallArgument) {
+    std::istringstream input("f((a + b), c) * 2");
+    Lexer lexer(input);
+    lexer.advance();
+    Parser parser(lexer);
+
+    auto fcn = parser.parseTopLevelExpr();
+    ASSERT_NE(fcn, nullptr);
+    EXPECT_EQ(fcn->getBody()->toString(), "(f((a + b), c) * 2)");
+}
+
+TEST(Parser, DeeplyNestedParentheses) {
+    const int depth = 100000;
+    std::string source = std::string(depth, '(') + "x";
+    for (int i = 0; i < depth; ++i) {
+        source += " + 1)";
+    }
+    Lexer lexer(source);
+    lexer.advance();
+    Parser parser(lexer);
+
+    auto fcn = parser.parseTopLevelExpr();
+    ASSERT_NE(fcn, nullptr);
+    EXPECT_EQ(fcn->getArena()->getNumNodes(), 2u * depth + 1);
+    EXPECT_EQ(fcn->getBody()->toString(), source);
+}
+
+TEST(Parser, LongOperatorChains) {
+    const int length = 100000;
+    std::string source = "x";
+    for (int i = 0; i < length; ++i) {
+        source += " = x";
+    }
+    source += "; y";
+    for (int i = 0; i < length; ++i) {
+        source += " - y";
+    }
+    Lexer lexer(source);
+    lexer.advance();
+    Parser parser(lexer);
+
+    // Right associative, nests to the right
+    auto assign = parser.parseTopLevelExpr();
+    ASSERT_NE(assign, nullptr);
+    EXPECT_EQ(assign->getBody()->toString().substr(0, 10), "(x = (x = ");
+
+    lexer.consume(tok_semicolon);
+    // Left associative, nests to the left
+    auto sub = parser.parseTopLevelExpr();
+    ASSERT_NE(sub, nullptr);
+    EXPECT_EQ(sub->getBody()->toString().substr(0, 6), "((((((");
+}
+
+TEST(Parser, LongPrefixOperatorChain) {
+    const int length = 100000;
+    std::string source = std::string(length, '!') + "x";
+    Lexer lexer(source);
+    lexer.advance();
+    Parser parser(lexer);
+
+    auto fcn = parser.parseTopLevelExpr();
+    ASSERT_NE(fcn, nullptr);
+    EXPECT_EQ(fcn->getBody()->toString(), source);
+}
+
+TEST(Parser, HashConsingSharesRepeatedSubexpressions) {
+    std::string_view source = "def f(x y) (x*x + y*y) * (x*x + y*y) - f(x, x) - f(x, x);";
+    Lexer plainLexer(source);
+    plainLexer.advance();
+    auto plain = Parser(plainLexer).parseDefinition();
+    ASSERT_NE(plain, nullptr);
+
+    Lexer lexer(source);
+    lexer.advance();
+    Parser parser(lexer);
+    parser.setHashConsing(true);
+    auto fcn = parser.parseDefinition();
+    ASSERT_NE(fcn, nullptr);
+    EXPECT_EQ(fcn->getBody()->toString(), plain->getBody()->toString());
+
+    // ((a * a) - f(x, x)) - f(x, x), a shared and the calls not
+    auto* outer = dynamic_cast<BinaryExpr*>(fcn->getBody());
+    ASSERT_NE(outer, nullptr);
+    auto* inner = dynamic_cast<BinaryExpr*>(outer->getLHS());
+    ASSERT_NE(inner, nullptr);
+    auto* product = dynamic_cast<BinaryExpr*>(inner->getLHS());
+    ASSERT_NE(product, nullptr);
+    EXPECT_EQ(product->getLHS(), product->getRHS());
+    EXPECT_NE(inner->getRHS(), outer->getRHS());
+    EXPECT_EQ(dynamic_cast<CallExpr*>(inner->getRHS())->getArgs()[0],
+              dynamic_cast<CallExpr*>(outer->getRHS())->getArgs()[1]);
+
+    // x, x*x, y, y*y, +, *, two calls and two -
+    EXPECT_EQ(fcn->getArena()->getNumNodes(), 10u);
+    EXPECT_LT(fcn->getArena()->getBytesUsed(), plain->getArena()->getBytesUsed());
+}
+
+TEST(Parser, HashConsingStartsOverForEachItem) {
+    Lexer lexer(std::string_view("x + 1; x + 1;"));
+    lexer.advance();
+    Parser parser(lexer);
+    parser.setHashConsing(true);
+    auto first = parser.parseTopLevelExpr();
+    lexer.advance();
+    auto second = parser.parseTopLevelExpr();
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(second, nullptr);
+    EXPECT_EQ(second->getArena()->getNumNodes(), 3u);
+    EXPECT_EQ(parser.getInterner()->getNumShared(), 0u);
+}
+
+TEST(Parser, LazyDefinitionSkipsTheBody) {
+    Lexer lexer(std::string_view("def f(x y) x * (y + 1); f(1, 2)"));
+    TokenStream tokens(lexer);
+    Lexer replay(tokens);
+    replay.advance();
+    Parser parser(replay);
+
+    auto definition = parser.parseLazyDefinition();
+    ASSERT_NE(definition, nullptr);
+    EXPECT_EQ(definition->proto->getName(), "f");
+    EXPECT_EQ(definition->bodyBegin, 6u);
+    EXPECT_EQ(definition->bodyEnd, 13u);
+    EXPECT_EQ(replay.getCurrentToken(), tok_semicolon);
+
+    Lexer bodyLexer(tokens, definition->bodyBegin, definition->bodyEnd);
+    bodyLexer.advance();
+    Parser bodyParser(bodyLexer);
+    auto fcn = bodyParser.parseLazyBody(*definition);
+    ASSERT_NE(fcn, nullptr);
+    EXPECT_EQ(fcn->getName(), "f");
+    EXPECT_EQ(fcn->getBody()->toString(), "(x * (y + 1))");
+}
+
+TEST(Parser, LazyDefinitionEndsAtTheNextItem) {
+    Lexer lexer(std::string_view("def f(x) x + 1 def g(x) x"));
+    TokenStream tokens(lexer);
+    Lexer replay(tokens);
+    replay.advance();
+    Parser parser(replay);
+
+    auto f = parser.parseLazyDefinition();
+    ASSERT_NE(f, nullptr);
+    EXPECT_EQ(replay.getCurrentToken(), tok_def);
+    auto g = parser.parseLazyDefinition();
+    ASSERT_NE(g, nullptr);
+    EXPECT_EQ(replay.getCurrentToken(), tok_eof);
+    EXPECT_EQ(g->bodyEnd, tokens.size() - 1);
+}
+
+TEST(Parser, LazyDefinitionErrors) {
+    Lexer lexer(std::string_view("def f(x); def g(x) x 1;"));
+    TokenStream tokens(lexer);
+    Lexer replay(tokens);
+    replay.advance();
+    Parser parser(replay);
+
+    // No body at all
+    EXPECT_EQ(parser.parseLazyDefinition(), nullptr);
+    replay.consume(tok_semicolon);
+
+    // A body followed by another expression without a ';' in between
+    auto g = parser.parseLazyDefinition();
+    ASSERT_NE(g, nullptr);
+    Lexer bodyLexer(tokens, g->bodyBegin, g->bodyEnd);
+    bodyLexer.advance();
+    Parser bodyParser(bodyLexer);
+    EXPECT_EQ(bodyParser.parseLazyBody(*g), nullptr);
+}
+
+TEST(ParserSystemTest, LazyDefinitionsCompileOnFirstCall) {
+    InitializeNativeTarget();
+    InitializeNativeTargetAsmPrinter();
+    InitializeNativeTargetAsmParser();
+    Lexer lexer(std::string_view(
+        "def unused(x) x + 1;\n"
+        "def binary % 50 (a b) a - b;\n"
+        "def helper(x) x % 2;\n"
+        "def lazyUser(x) helper(x) + 1;\n"
+        "lazyUser(3);\n"));
+    TokenStream tokens(lexer);
+
+    // Without the JIT every item stays in the one module
+    Driver driver("test", tokens, false, false);
+    driver.initilizeModuleAndManagers();
+    driver.setLazyDefinitions(true);
+    driver.MainLoop();
+
+    Module* module = driver.getModule();
+    auto isDefined = [module](const char* name) {
+        Function* fcn = module->getFunction(name);
+        return fcn && !fcn->isDeclaration();
+    };
+    EXPECT_TRUE(isDefined("lazyUser"));
+    EXPECT_TRUE(isDefined("helper"));
+    EXPECT_TRUE(isDefined("binary%"));
+    EXPECT_EQ(module->getFunction("unused"), nullptr);
+}
+
+TEST(ParserSystemTest, CachedParsesCompileTheSame) {
+    InitializeNativeTarget();
+    InitializeNativeTargetAsmPrinter();
+    InitializeNativeTargetAsmParser();
+    std::string_view source =
+        "def binary % 50 (a b) a - b;\n"
+        "def helper(x) x % 2;\n"
+        "def broken(x) then;\n"
+        "def user(x) helper(x) + 1;\n"
+        "user(2);\n";
+    std::string path = ::testing::TempDir() + "ParserSystemTest_cache.bin";
+    std::remove(path.c_str());
+
+    // The second run compiles every item from the cache
+    for (int run = 0; run < 2; ++run) {
+        ASTCache cache(path);
+        EXPECT_EQ(cache.getNumEntries(), run == 0 ? 0u : 4u);
+        Driver driver("test", false, false);
+        driver.initilizeModuleAndManagers();
+        driver.CachedMainLoop(source, cache);
+        ASSERT_TRUE(cache.save());
+
+        Module* module = driver.getModule();
+        for (const char* name : {"binary%", "helper", "user"}) {
+            Function* fcn = module->getFunction(name);
+            EXPECT_TRUE(fcn && !fcn->isDeclaration()) << name << " in run " << run;
+        }
+        EXPECT_EQ(module->getFunction("broken"), nullptr);
+        std::vector<Diagnostic> diagnostics = driver.getDiagnostics();
+        ASSERT_EQ(diagnostics.size(), 1u);
+        EXPECT_EQ(diagnostics[0].loc, source.find("then"));
+    }
+}
+
+TEST(ParserSystemTest, StatsRecordEveryParsedItem) {
+    InitializeNativeTarget();
+    InitializeNativeTargetAsmPrinter();
+    InitializeNativeTargetAsmParser();
+    std::string_view source =
+        "def twice(x) x * 2;\n"
+        "def broken(x) then;\n"
+        "twice(3);\n";
+    ASTStats stats;
+    Driver driver("test", source, false, false);
+    driver.initilizeModuleAndManagers();
+    driver.setStats(&stats);
+    driver.MainLoop();
+
+    ASSERT_EQ(stats.getItems().size(), 2u);
+    EXPECT_EQ(stats.getItems()[0].name, Symbol("twice"));
+    EXPECT_EQ(stats.getItems()[0].numNodes, 5u);
+    EXPECT_EQ(stats.getItems()[1].name, Symbol("main"));
+    EXPECT_EQ(stats.getItems()[1].loc, source.find("twice(3)"));
+}
+
+TEST(ParserSystemTest, HandlerGetsErrorsAfterEachItem) {
+    InitializeNativeTarget();
+    InitializeNativeTargetAsmPrinter();
+    InitializeNativeTargetAsmParser();
+    std::string_view source =
+        "def broken(x) then;\n"
+        "def fine(x) x;\n"
+        "extern 3;\n";
+    Driver driver("test", source, false, false);
+    driver.initilizeModuleAndManagers();
+    std::vector<Diagnostic> reported;
+    driver.setDiagnosticHandler([&reported](const Diagnostic& diag) {
+        reported.push_back(diag);
+    });
+    driver.MainLoop();
+
+    ASSERT_EQ(reported.size(), 2u);
+    EXPECT_EQ(reported[0].loc, source.find("then"));
+    EXPECT_EQ(reported[1].loc, source.find("3;"));
+    // Nothing is kept once it is reported
+    EXPECT_TRUE(driver.getDiagnostics().empty());
+}
+
 TEST(ParserSystemTest, VarInLoop) {
     InitializeNativeTarget();
     InitializeNativeTargetAsmPrinter();
@@ -0,0 +1,97 @@
+#include "gtest/gtest.h"
+
+#include <random>
+#include <string>
+
+#include "frontend/Scanner.hpp"
+
+using namespace lang;
+
+// Runs every test against each implementation the CPU supports
+class ScannerTest : public testing::TestWithParam<scan::Impl> {
+protected:
+    void SetUp() override {
+        original = scan::getImpl();
+        if (!scan::setImpl(GetParam())) {
+            GTEST_SKIP() << scan::getImplName(GetParam()) << " is not supported";
+        }
+    }
+
+    void TearDown() override {
+        scan::setImpl(original);
+    }
+
+    // Mostly scanner-relevant characters so runs of every class show up
+    static std::string randomSource(size_t size, unsigned seed) {
+        static const char CHARS[] = "   \t\n\r\v\f#abcXYZ09_+(;\x80\xff";
+        std::mt19937 rng(seed);
+        std::string result(size, ' ');
+        for (auto& c : result) {
+            c = CHARS[rng() % (sizeof(CHARS) - 1)];
+        }
+        return result;
+    }
+
+    scan::Impl original;
+};
+
+static bool isWs(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+static bool isIdent(char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+TEST_P(ScannerTest, SkipWhitespace) {
+    std::string src = "  \t\v\f\r\n" + std::string(70, ' ') + "x";
+    const char* end = src.data() + src.size();
+    EXPECT_EQ(scan::skipWhitespace(src.data(), end), end - 1);
+    EXPECT_EQ(scan::skipWhitespace(src.data(), end - 1), end - 1);
+    EXPECT_EQ(scan::skipWhitespace(end - 1, end), end - 1);
+}
+
+TEST_P(ScannerTest, FindEndOfLine) {
+    std::string src = std::string(40, 'a') + "\r" + std::string(40, 'b') + "\n";
+    const char* begin = src.data();
+    const char* end = begin + src.size();
+    EXPECT_EQ(scan::findEndOfLine(begin, end), begin + 40);
+    EXPECT_EQ(scan::findEndOfLine(begin + 41, end), end - 1);
+    EXPECT_EQ(scan::findEndOfLine(begin, begin + 20), begin + 20);
+}
+
+TEST_P(ScannerTest, SkipIdentifier) {
+    std::string src = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789@";
+    const char* end = src.data() + src.size();
+    EXPECT_EQ(scan::skipIdentifier(src.data(), end), end - 1);
+    for (char c : std::string("`[{/:@_\x80")) {
+        std::string stop = std::string(33, 'a') + c;
+        EXPECT_EQ(scan::skipIdentifier(stop.data(), stop.data() + stop.size()), stop.data() + 33) << c;
+    }
+}
+
+TEST_P(ScannerTest, MatchesReferenceOnRandomInput) {
+    for (unsigned seed = 0; seed < 20; ++seed) {
+        std::string src = randomSource(200, seed);
+        const char* end = src.data() + src.size();
+        for (const char* p = src.data(); p != end; ++p) {
+            const char* ws = p;
+            while (ws != end && isWs(*ws)) ++ws;
+            ASSERT_EQ(scan::skipWhitespace(p, end), ws);
+
+            const char* eol = p;
+            while (eol != end && *eol != '\n' && *eol != '\r') ++eol;
+            ASSERT_EQ(scan::findEndOfLine(p, end), eol);
+
+            const char* id = p;
+            while (id != end && isIdent(*id)) ++id;
+            ASSERT_EQ(scan::skipIdentifier(p, end), id);
+        }
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(Scanner, ScannerTest, 
+    testing::Values(scan::Impl::Scalar, scan::Impl::SSE2, scan::Impl::AVX2),
+    [](const testing::TestParamInfo<scan::Impl>& info) {
+        return std::string(scan::getImplName(info.param));
+    });
@@ -0,0 +1,152 @@
+#include "gtest/gtest.h"
+
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+#include "frontend/Lexer.hpp"
+#include "frontend/StreamSource.hpp"
+
+using namespace lang;
+
+namespace {
+
+// Writes `data` into a pipe from another thread, like a producer process
+class PipeWriter {
+public:
+    explicit PipeWriter(std::string data) : data(std::move(data)) {
+        int fds[2];
+        if (pipe(fds) != 0) {
+            ADD_FAILURE() << "pipe() failed";
+            return;
+        }
+        readFd = fds[0];
+        writer = std::thread([this, fd = fds[1]] {
+            size_t written = 0;
+            while (written < this->data.size()) {
+                ssize_t n = write(fd, this->data.data() + written, this->data.size() - written);
+                if (n <= 0) {
+                    break;
+                }
+                written += n;
+            }
+            close(fd);
+        });
+    }
+
+    ~PipeWriter() {
+        writer.join();
+        close(readFd);
+    }
+
+    int getReadFd() const {
+        return readFd;
+    }
+
+private:
+    std::string data;
+    int readFd = -1;
+    std::thread writer;
+};
+
+std::string readAll(StreamSource& source, size_t& chunks) {
+    std::string result;
+    chunks = 0;
+    for (std::string_view chunk = source.nextChunk(); !chunk.empty(); chunk = source.nextChunk()) {
+        result += chunk;
+        ++chunks;
+    }
+    return result;
+}
+
+} // namespace
+
+TEST(StreamSourceTest, EmptyStream) {
+    PipeWriter pipe("");
+    StreamSource source(pipe.getReadFd());
+    EXPECT_TRUE(source.nextChunk().empty());
+    EXPECT_TRUE(source.nextChunk().empty());
+}
+
+TEST(StreamSourceTest, ChunksEndOnLineBreaks) {
+    std::string input;
+    for (int i = 0; i < 100; ++i) {
+        input += "foo(" + std::to_string(i) + ");\n";
+    }
+    input += "tail";
+
+    PipeWriter pipe(input);
+    StreamSource source(pipe.getReadFd(), 32);
+    std::string result;
+    for (std::string_view chunk = source.nextChunk(); !chunk.empty(); chunk = source.nextChunk()) {
+        if (!chunk.ends_with("tail")) {
+            EXPECT_EQ(chunk.back(), '\n');
+        }
+        EXPECT_LE(chunk.size(), 32);
+        result += chunk;
+    }
+    EXPECT_EQ(result, input);
+}
+
+TEST(StreamSourceTest, LongLineGetsItsOwnChunk) {
+    std::string longLine(1000, 'x');
+    std::string input = "a\n" + longLine + "\nb\n";
+
+    PipeWriter pipe(input);
+    StreamSource source(pipe.getReadFd(), 16);
+    size_t chunks;
+    EXPECT_EQ(readAll(source, chunks), input);
+}
+
+TEST(StreamSourceTest, ReleasedChunksAreReused) {
+    std::string input;
+    for (int i = 0; i < 10000; ++i) {
+        input += "1 + 2;\n";
+    }
+
+    PipeWriter pipe(input);
+    StreamSource source(pipe.getReadFd(), 64);
+    Lexer lexer(source);
+    int semicolons = 0;
+    for (Token tok = lexer.advance(); tok != tok_eof; tok = lexer.advance()) {
+        if (tok == tok_semicolon) {
+            ++semicolons;
+            lexer.releaseConsumedInput();
+            EXPECT_LE(source.getAllocatedChunks(), 2);
+        }
+    }
+    EXPECT_EQ(semicolons, 10000);
+}
+
+class StreamSourceLexerTest : public testing::TestWithParam<size_t> {};
+
+TEST_P(StreamSourceLexerTest, MatchesBufferBackend) {
+    std::string input = 
+        "# fib\r\n"
+        "def fib(x)\n  if x < 3 then\n    1\n  else\n    fib(x-1)+fib(x-2);\n\n"
+        "extern sin(a);   \n\n\n\t\t   \n"
+        "var abcdefghijklmnopqrstuvwxyz = 1.5e3, b = 0x1p4 in\r\n"
+        "  for i = 0, i < 10 in abcdefghijklmnopqrstuvwxyz = b + 1_000;\n"
+        "fib(10) # trailing";
+
+    PipeWriter pipe(input);
+    StreamSource source(pipe.getReadFd(), GetParam());
+    Lexer streamed(source);
+    Lexer buffered{std::string_view(input)};
+
+    while (true) {
+        Token tok = buffered.advance();
+        ASSERT_EQ(streamed.advance(), tok);
+        EXPECT_EQ(streamed.getCurrentOffset(), buffered.getCurrentOffset());
+        if (tok == tok_identifier) {
+            EXPECT_EQ(streamed.getIdentifierStr(), buffered.getIdentifierStr());
+        } else if (tok == tok_number) {
+            EXPECT_DOUBLE_EQ(streamed.getNumVal(), buffered.getNumVal());
+        } else if (tok == tok_eof) {
+            break;
+        }
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(StreamSourceTest, StreamSourceLexerTest, 
+                         testing::Values(1, 7, 64, StreamSource::DEFAULT_CHUNK_SIZE));
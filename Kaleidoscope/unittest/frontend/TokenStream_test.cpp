@@ -0,0 +1,216 @@
+#include "gtest/gtest.h"
+
+#include <sstream>
+#include <string>
+#include <string_view>
+
+#include "frontend/Parser.hpp"
+#include "frontend/TokenStream.hpp"
+
+using namespace lang;
+
+TEST(TokenStreamTest, EmptySourceHoldsOnlyEof) {
+    Lexer lexer(std::string_view(""));
+    TokenStream tokens(lexer);
+    ASSERT_EQ(tokens.size(), 1);
+    EXPECT_EQ(tokens.getKind(0), tok_eof);
+}
+
+TEST(TokenStreamTest, StoresPayloads) {
+    Lexer lexer(std::string_view("def foo(x) x + 2.5;"));
+    TokenStream tokens(lexer);
+    ASSERT_EQ(tokens.size(), 10);
+    EXPECT_EQ(tokens.getKind(0), tok_def);
+    EXPECT_EQ(tokens.getKind(1), tok_identifier);
+    EXPECT_EQ(tokens.getSymbol(1), Symbol("foo"));
+    EXPECT_EQ(tokens.getSymbol(3), Symbol("x"));
+    EXPECT_EQ(tokens.getKind(7), tok_number);
+    EXPECT_DOUBLE_EQ(tokens.getNumVal(7), 2.5);
+    EXPECT_EQ(tokens.getOffset(7), 15);
+    EXPECT_EQ(tokens.getKind(9), tok_eof);
+}
+
+TEST(TokenStreamTest, KeepsDiagnostics) {
+    Lexer lexer(std::string_view("1.2.3 + 4"));
+    TokenStream tokens(lexer);
+    EXPECT_EQ(tokens.getKind(0), tok_error);
+    ASSERT_EQ(tokens.getDiagnostics().size(), 1);
+
+    Lexer replay(tokens);
+    EXPECT_EQ(replay.getDiagnostics().size(), 1);
+}
+
+class TokenStreamReplayTest : public testing::TestWithParam<const char*> {};
+
+TEST_P(TokenStreamReplayTest, ReplayMatchesDirectLexing) {
+    Lexer prelexer{std::string_view(GetParam())};
+    TokenStream tokens(prelexer);
+
+    std::istringstream iss(GetParam());
+    Lexer direct(iss);
+    Lexer replay(tokens);
+
+    while (true) {
+        Token tok = direct.advance();
+        ASSERT_EQ(replay.advance(), tok);
+        EXPECT_EQ(replay.getCurrentOffset(), direct.getCurrentOffset());
+        if (tok == tok_identifier) {
+            EXPECT_EQ(replay.getIdentifier(), direct.getIdentifier());
+            EXPECT_EQ(replay.getIdentifierStr(), direct.getIdentifierStr());
+        } else if (tok == tok_number) {
+            EXPECT_DOUBLE_EQ(replay.getNumVal(), direct.getNumVal());
+        } else if (tok == tok_eof) {
+            break;
+        }
+    }
+    // Replay stays at the end once it gets there
+    EXPECT_EQ(replay.advance(), tok_eof);
+}
+
+INSTANTIATE_TEST_SUITE_P(TokenStreamTest, TokenStreamReplayTest, testing::Values(
+    "",
+    "\n\n\n",
+    "def fib(x)\n  if x < 3 then\n    1\n  else\n    fib(x-1)+fib(x-2);\n\nfib(10);",
+    "extern sin(a);\r\n# comment\r\n\r\nsin(1.5e3)",
+    "var a = 1, b = 0x10 in\n\tfor i = 0, i < 10 in a = a + b\n"
+));
+
+TEST(TokenStreamTest, PeekDoesNotAdvance) {
+    Lexer lexer(std::string_view("foo(1)"));
+    TokenStream tokens(lexer);
+    Lexer replay(tokens);
+
+    EXPECT_EQ(replay.advance(), tok_identifier);
+    EXPECT_EQ(replay.peek(), tok_open_paren);
+    EXPECT_EQ(replay.peek(2), tok_number);
+    EXPECT_EQ(replay.peek(10), tok_eof);
+    EXPECT_EQ(replay.getCurrentToken(), tok_identifier);
+    EXPECT_EQ(replay.advance(), tok_open_paren);
+}
+
+TEST(TokenStreamTest, RewindRestoresCurrentToken) {
+    Lexer lexer(std::string_view("a + b * c"));
+    TokenStream tokens(lexer);
+    Lexer replay(tokens);
+
+    replay.advance();
+    replay.advance();
+    size_t mark = replay.mark();
+    EXPECT_EQ(replay.advance(), tok_identifier);
+    EXPECT_EQ(replay.getIdentifierStr(), "b");
+    replay.advance();
+    replay.advance();
+
+    replay.rewind(mark);
+    EXPECT_EQ(replay.getCurrentToken(), '+');
+    EXPECT_EQ(replay.advance(), tok_identifier);
+    EXPECT_EQ(replay.getIdentifierStr(), "b");
+
+    replay.rewind(0);
+    EXPECT_EQ(replay.advance(), tok_identifier);
+    EXPECT_EQ(replay.getIdentifierStr(), "a");
+}
+
+TEST(TokenStreamTest, ReplaysATokenRange) {
+    Lexer lexer(std::string_view("a b c d"));
+    TokenStream tokens(lexer);
+    Lexer replay(tokens, 1, 3);
+
+    EXPECT_EQ(replay.peek(), tok_identifier);
+    EXPECT_EQ(replay.peek(3), tok_eof);
+    EXPECT_EQ(replay.advance(), tok_identifier);
+    EXPECT_EQ(replay.getIdentifierStr(), "b");
+    EXPECT_EQ(replay.advance(), tok_identifier);
+    EXPECT_EQ(replay.getIdentifierStr(), "c");
+
+    // Ends where the next token starts, and stays there
+    EXPECT_EQ(replay.advance(), tok_eof);
+    EXPECT_EQ(replay.getCurrentOffset(), 6);
+    EXPECT_EQ(replay.advance(), tok_eof);
+
+    replay.rewind(1);
+    EXPECT_EQ(replay.advance(), tok_identifier);
+    EXPECT_EQ(replay.getIdentifierStr(), "b");
+}
+
+TEST(TokenStreamTest, ParserAcceptsReplay) {
+    const char* source = "def foo(x y) x * (y + 2);";
+    Lexer lexer{std::string_view(source)};
+    TokenStream tokens(lexer);
+
+    Lexer replay(tokens);
+    replay.advance();
+    Parser parser(replay);
+    auto fcn = parser.parseDefinition();
+    ASSERT_NE(fcn, nullptr);
+    EXPECT_EQ(fcn->getName(), "foo");
+    EXPECT_EQ(fcn->getBody()->toString(), "(x * (y + 2))");
+}
+
+namespace {
+
+std::string makeParallelSource() {
+    std::string source;
+    for (int i = 0; i < 200; ++i) {
+        std::string n = std::to_string(i);
+        source += "# item " + n + "\n";
+        source += "def f" + n + "(x y)\n  if x < " + n + " then x * y else f" + n + "(x - 1, y);\r\n";
+        source += "extern g" + n + "(a);\n\n";
+        source += "f" + n + "(" + n + ".5e1, 0x1p" + std::to_string(i % 8) + ");\n";
+        if (i % 50 == 0) {
+            source += "1.2.3 + 4;\n";
+        }
+    }
+    return source;
+}
+
+void expectSameTokens(const TokenStream& expected, const TokenStream& actual) {
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        ASSERT_EQ(actual.getKind(i), expected.getKind(i)) << "token " << i;
+        EXPECT_EQ(actual.getOffset(i), expected.getOffset(i)) << "token " << i;
+        if (expected.getKind(i) == tok_identifier) {
+            EXPECT_EQ(actual.getSymbol(i), expected.getSymbol(i)) << "token " << i;
+        } else if (expected.getKind(i) == tok_number) {
+            EXPECT_DOUBLE_EQ(actual.getNumVal(i), expected.getNumVal(i)) << "token " << i;
+        }
+    }
+
+    ASSERT_EQ(actual.getDiagnostics().size(), expected.getDiagnostics().size());
+    for (size_t i = 0; i < expected.getDiagnostics().size(); ++i) {
+        EXPECT_EQ(actual.getDiagnostics()[i].loc, expected.getDiagnostics()[i].loc);
+    }
+}
+
+} // namespace
+
+TEST(TokenStreamTest, ParallelLexingMatchesSerial) {
+    std::string source = makeParallelSource();
+    Lexer lexer{std::string_view(source)};
+    TokenStream serial(lexer);
+
+    for (unsigned jobs : {1u, 2u, 3u, 8u, 64u}) {
+        SCOPED_TRACE(jobs);
+        expectSameTokens(serial, TokenStream::lexParallel(source, jobs, 64));
+    }
+}
+
+TEST(TokenStreamTest, ParallelLexingHandlesSourceWithoutLineBreaks) {
+    std::string source = "foo(1, 2) + bar(3) * 4 # trailing comment";
+    Lexer lexer{std::string_view(source)};
+    TokenStream serial(lexer);
+    expectSameTokens(serial, TokenStream::lexParallel(source, 4, 1));
+}
+
+TEST(TokenStreamTest, ParallelLexingOfEmptySource) {
+    TokenStream tokens = TokenStream::lexParallel("", 4, 1);
+    ASSERT_EQ(tokens.size(), 1);
+    EXPECT_EQ(tokens.getKind(0), tok_eof);
+}
+
+TEST(TokenStreamTest, ParallelLexingLeavesSmallSourcesWhole) {
+    std::string source = makeParallelSource();
+    Lexer lexer{std::string_view(source)};
+    TokenStream serial(lexer);
+    expectSameTokens(serial, TokenStream::lexParallel(source, 8));
+}